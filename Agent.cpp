@@ -0,0 +1,254 @@
+/*
+ File: Agent.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Agent.h>
+#include <Coordinator.h>
+#include <Worker.h>
+
+// C++
+#include <algorithm>
+
+//--------------------------------------------------------------------
+Agent::Agent(const QString &name, const int capacity, const Utils::TranscoderConfiguration &config, QObject *parent)
+: QObject        {parent}
+, m_name         {name}
+, m_capacity     {std::max(1, capacity)}
+, m_configuration{agentConfiguration(config, m_capacity)}
+, m_scheduler    {std::vector<std::filesystem::path>(), m_configuration, name}
+, m_sample_frames{0}
+, m_done_frames  {0}
+, m_connected    {false}
+, m_lost         {false}
+{
+  // the jobs arrive from the coordinator.
+  m_scheduler.setIntakeOpen(true);
+
+  connect(&m_scheduler, SIGNAL(worker_started(Worker *, const QString &)), this, SLOT(on_worker_started(Worker *, const QString &)));
+  connect(&m_scheduler, SIGNAL(worker_finished(Worker *)),                 this, SLOT(on_worker_finished(Worker *)));
+  connect(&m_scheduler, SIGNAL(error_message(const QString &)),            this, SLOT(on_error(const QString &)));
+  connect(&m_scheduler, SIGNAL(information_message(const QString &)),      this, SLOT(on_information(const QString &)));
+  connect(&m_scheduler, SIGNAL(finished()),                                this, SLOT(on_scheduler_finished()));
+
+  connect(&m_socket, SIGNAL(connected()),                         this, SLOT(on_connected()));
+  connect(&m_socket, SIGNAL(readyRead()),                         this, SLOT(on_ready_read()));
+  connect(&m_socket, SIGNAL(disconnected()),                      this, SLOT(on_disconnected()));
+  connect(&m_socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(on_socket_error(QAbstractSocket::SocketError)));
+
+  m_heartbeat.setInterval(s_heartbeat_interval);
+  connect(&m_heartbeat, SIGNAL(timeout()), this, SLOT(on_heartbeat_timeout()));
+}
+
+//--------------------------------------------------------------------
+void Agent::connectTo(const QString &host, const quint16 port)
+{
+  m_socket.connectToHost(host, port);
+}
+
+//--------------------------------------------------------------------
+Scheduler *Agent::scheduler()
+{
+  return &m_scheduler;
+}
+
+//--------------------------------------------------------------------
+bool Agent::hasLostConnection() const
+{
+  return m_lost;
+}
+
+//--------------------------------------------------------------------
+void Agent::stop()
+{
+  // the cancelled jobs are reported and the coordinator gives them to other agents.
+  m_scheduler.stop();
+}
+
+//--------------------------------------------------------------------
+void Agent::on_connected()
+{
+  m_connected = true;
+
+  send("hello", QJsonObject{{"name", m_name}, {"capacity", m_capacity}});
+
+  m_sample_clock.start();
+  m_heartbeat.start();
+
+  m_scheduler.start();
+}
+
+//--------------------------------------------------------------------
+void Agent::on_ready_read()
+{
+  for(const auto &message: Coordinator::receive(&m_socket))
+  {
+    const auto type = message.value("type").toString();
+
+    if(type == "job")
+    {
+      const auto id   = message.value("id").toInt(-1);
+      const auto file = message.value("file").toString();
+      if(id < 0 || file.isEmpty()) continue;
+
+      // the same file can be received several times, each job is given to one worker when started.
+      m_pending_ids[file] << id;
+
+      // skipped by the index or the journal of this node.
+      if(!m_scheduler.enqueue(std::filesystem::path(file.toStdWString())))
+      {
+        auto &ids = m_pending_ids[file];
+        ids.removeOne(id);
+        if(ids.isEmpty()) m_pending_ids.remove(file);
+
+        send("result", QJsonObject{{"id", id}, {"status", "skipped"}});
+      }
+    }
+    else if(type == "quit")
+    {
+      m_scheduler.setIntakeOpen(false);
+    }
+    else if(type == "cancel")
+    {
+      m_scheduler.stop();
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+void Agent::on_disconnected()
+{
+  if(m_scheduler.isFinished()) return;
+
+  m_lost = true;
+
+  emit error_message(tr("Lost the connection with the coordinator, stopping the jobs."));
+
+  m_scheduler.stop();
+}
+
+//--------------------------------------------------------------------
+void Agent::on_socket_error(QAbstractSocket::SocketError error)
+{
+  if(error == QAbstractSocket::RemoteHostClosedError) return;
+
+  emit error_message(tr("Coordinator connection error: %1").arg(m_socket.errorString()));
+
+  if(!m_connected)
+  {
+    m_lost = true;
+    emit finished();
+  }
+}
+
+//--------------------------------------------------------------------
+void Agent::on_heartbeat_timeout()
+{
+  long long frames = m_done_frames;
+  for(auto worker: m_workers) frames += worker->frames_count();
+
+  const auto elapsed = m_sample_clock.restart();
+  const auto throughput = (frames - m_sample_frames) * 1000.0 / std::max(1LL, static_cast<long long>(elapsed));
+  m_sample_frames = frames;
+
+  send("heartbeat", QJsonObject{{"throughput", throughput}});
+}
+
+//--------------------------------------------------------------------
+void Agent::on_worker_started(Worker *worker, const QString &name)
+{
+  m_workers << worker;
+
+  const auto it = m_pending_ids.find(QString::fromStdWString(worker->source_path().wstring()));
+  if(it == m_pending_ids.end()) return;
+
+  const auto id = it.value().takeFirst();
+  if(it.value().isEmpty()) m_pending_ids.erase(it);
+
+  m_ids.insert(worker, id);
+
+  // progress is emitted from the worker thread and can be delivered after the worker has been
+  // deleted, so the lambda must not touch the worker.
+  connect(worker, &Worker::progress, this, [this, id](int value)
+  {
+    send("progress", QJsonObject{{"id", id}, {"value", value}});
+  });
+}
+
+//--------------------------------------------------------------------
+void Agent::on_worker_finished(Worker *worker)
+{
+  m_workers.removeOne(worker);
+  m_done_frames += worker->frames_count();
+
+  const auto id = m_ids.value(worker, -1);
+  m_ids.remove(worker);
+
+  // not a job of the coordinator.
+  if(id < 0) return;
+
+  QString status = "done";
+  if(worker->has_been_cancelled())  status = "cancelled";
+  else if(worker->has_failed())     status = "failed";
+
+  send("result", QJsonObject{{"id", id}, {"status", status}});
+}
+
+//--------------------------------------------------------------------
+void Agent::on_error(const QString &message)
+{
+  send("message", QJsonObject{{"level", "error"}, {"text", message}});
+}
+
+//--------------------------------------------------------------------
+void Agent::on_information(const QString &message)
+{
+  send("message", QJsonObject{{"level", "info"}, {"text", message}});
+}
+
+//--------------------------------------------------------------------
+void Agent::on_scheduler_finished()
+{
+  m_heartbeat.stop();
+
+  if(m_socket.state() == QAbstractSocket::ConnectedState)
+  {
+    m_socket.flush();
+    m_socket.disconnectFromHost();
+  }
+
+  emit finished();
+}
+
+//--------------------------------------------------------------------
+void Agent::send(const QString &type, QJsonObject data)
+{
+  if(m_socket.state() == QAbstractSocket::ConnectedState)
+  {
+    Coordinator::send(&m_socket, type, data);
+  }
+}
+
+//--------------------------------------------------------------------
+Utils::TranscoderConfiguration Agent::agentConfiguration(const Utils::TranscoderConfiguration &config, const int capacity)
+{
+  auto configuration = config;
+  configuration.setNumberOfThreads(capacity);
+
+  return configuration;
+}
@@ -0,0 +1,192 @@
+/*
+ File: Agent.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AGENT_H_
+#define AGENT_H_
+
+// Project
+#include <Utils.h>
+#include <Scheduler.h>
+
+// Qt
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QJsonObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class Worker;
+
+/** \class Agent
+ * \brief Transcodes the jobs received from a coordinator with a local scheduler, reporting their progress
+ *        and results and sending heartbeats with the throughput of the node.
+ *
+ */
+class Agent
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /** \brief Agent class constructor.
+     * \param[in] name Name of the agent.
+     * \param[in] capacity Simultaneous jobs of the agent.
+     * \param[in] config Application configuration.
+     * \param[in] parent Raw pointer of the object parent of this one.
+     *
+     */
+    explicit Agent(const QString &name,
+                   const int capacity,
+                   const Utils::TranscoderConfiguration &config,
+                   QObject *parent = nullptr);
+
+    /** \brief Agent class virtual destructor.
+     *
+     */
+    virtual ~Agent()
+    {}
+
+    /** \brief Connects to the coordinator.
+     * \param[in] host coordinator host name or address.
+     * \param[in] port coordinator TCP port.
+     *
+     */
+    void connectTo(const QString &host, const quint16 port);
+
+    /** \brief Returns the local scheduler.
+     *
+     */
+    Scheduler *scheduler();
+
+    /** \brief Returns true if the connection with the coordinator has been lost.
+     *
+     */
+    bool hasLostConnection() const;
+
+  public slots:
+    /** \brief Stops the running jobs, the coordinator gives them to other agents.
+     *
+     */
+    void stop();
+
+  signals:
+    /** \brief Emits an error message of the connection with the coordinator.
+     * \param[in] message error message.
+     *
+     */
+    void error_message(const QString &message);
+
+    /** \brief Emitted when the coordinator has no more jobs, the connection has been lost or the agent
+     *         has been stopped, once the running jobs have finished.
+     *
+     */
+    void finished();
+
+  private slots:
+    /** \brief Identifies the agent to the coordinator.
+     *
+     */
+    void on_connected();
+
+    /** \brief Processes the messages of the coordinator.
+     *
+     */
+    void on_ready_read();
+
+    /** \brief Stops the jobs when the connection is lost.
+     *
+     */
+    void on_disconnected();
+
+    /** \brief Reports a connection error.
+     * \param[in] error socket error.
+     *
+     */
+    void on_socket_error(QAbstractSocket::SocketError error);
+
+    /** \brief Sends a heartbeat with the throughput of the running jobs.
+     *
+     */
+    void on_heartbeat_timeout();
+
+    /** \brief Starts reporting the progress of a job.
+     * \param[in] worker Worker raw pointer.
+     * \param[in] name Name of the processed file.
+     *
+     */
+    void on_worker_started(Worker *worker, const QString &name);
+
+    /** \brief Reports the result of a job.
+     * \param[in] worker Worker raw pointer.
+     *
+     */
+    void on_worker_finished(Worker *worker);
+
+    /** \brief Forwards an error message of the scheduler to the coordinator.
+     * \param[in] message error message.
+     *
+     */
+    void on_error(const QString &message);
+
+    /** \brief Forwards an information message of the scheduler to the coordinator.
+     * \param[in] message information message.
+     *
+     */
+    void on_information(const QString &message);
+
+    /** \brief Closes the connection and emits the finished signal.
+     *
+     */
+    void on_scheduler_finished();
+
+  private:
+    /** \brief Sends a message to the coordinator if connected.
+     * \param[in] type message type.
+     * \param[in] data message data.
+     *
+     */
+    void send(const QString &type, QJsonObject data = QJsonObject());
+
+    /** \brief Returns the configuration of the local scheduler, running as many jobs as the capacity.
+     * \param[in] config application configuration.
+     * \param[in] capacity simultaneous jobs of the agent.
+     *
+     */
+    static Utils::TranscoderConfiguration agentConfiguration(const Utils::TranscoderConfiguration &config, const int capacity);
+
+    static const int s_heartbeat_interval = 5000; /** heartbeat interval in ms. */
+
+    const QString                        m_name;          /** agent name.                                */
+    const int                            m_capacity;      /** simultaneous jobs of the agent.            */
+    const Utils::TranscoderConfiguration m_configuration; /** configuration of the local scheduler.      */
+    Scheduler                            m_scheduler;     /** local scheduler.                           */
+    QTcpSocket                           m_socket;        /** coordinator connection.                    */
+    QHash<QString, QList<int>>           m_pending_ids;   /** ids of the waiting jobs by source path.    */
+    QHash<Worker *, int>                 m_ids;           /** maps running worker<->job id.              */
+    QTimer                               m_heartbeat;     /** heartbeat timer.                           */
+    QElapsedTimer                        m_sample_clock;  /** time since the last heartbeat.             */
+    long long                            m_sample_frames; /** frames processed at the last heartbeat.    */
+    long long                            m_done_frames;   /** frames processed by the finished jobs.     */
+    QList<Worker *>                      m_workers;       /** running workers.                           */
+    bool                                 m_connected;     /** true once connected to the coordinator.    */
+    bool                                 m_lost;          /** true if the connection has been lost.      */
+};
+
+#endif // AGENT_H_
@@ -0,0 +1,143 @@
+/*
+ File: BoundedQueue.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOUNDEDQUEUE_H_
+#define BOUNDEDQUEUE_H_
+
+// Qt
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+// C++
+#include <deque>
+#include <algorithm>
+
+/** \class BoundedQueue
+ * \brief Blocking FIFO queue with a maximum capacity used to connect the stages of a Worker. Producers
+ *        block when the queue is full and consumers when it's empty until an item arrives or the queue
+ *        is aborted.
+ *
+ */
+template<class T> class BoundedQueue
+{
+  public:
+    /** \brief BoundedQueue class constructor.
+     * \param[in] capacity Maximum number of items in the queue.
+     *
+     */
+    explicit BoundedQueue(const int capacity)
+    : m_capacity{static_cast<size_t>(std::max(1, capacity))}
+    , m_aborted {false}
+    {}
+
+    /** \brief Adds an item to the end of the queue, waiting for space if full. Returns true on
+     *         success and false if the queue has been aborted.
+     * \param[in] item Item to add.
+     *
+     */
+    bool push(T item)
+    {
+      QMutexLocker lock(&m_mutex);
+
+      while(!m_aborted && m_items.size() >= m_capacity) m_notFull.wait(&m_mutex);
+
+      if(m_aborted) return false;
+
+      m_items.push_back(item);
+      m_notEmpty.wakeOne();
+
+      return true;
+    }
+
+    /** \brief Removes the first item of the queue, waiting for one if empty. Returns true on
+     *         success and false if the queue has been aborted.
+     * \param[out] item Removed item.
+     *
+     */
+    bool pop(T &item)
+    {
+      QMutexLocker lock(&m_mutex);
+
+      while(!m_aborted && m_items.empty()) m_notEmpty.wait(&m_mutex);
+
+      if(m_aborted) return false;
+
+      item = m_items.front();
+      m_items.pop_front();
+      m_notFull.wakeOne();
+
+      return true;
+    }
+
+    /** \brief Aborts the queue, waking up all the waiting producers and consumers.
+     *
+     */
+    void abort()
+    {
+      QMutexLocker lock(&m_mutex);
+
+      m_aborted = true;
+      m_notEmpty.wakeAll();
+      m_notFull.wakeAll();
+    }
+
+    /** \brief Returns true if the queue has been aborted.
+     *
+     */
+    bool aborted() const
+    {
+      QMutexLocker lock(&m_mutex);
+      return m_aborted;
+    }
+
+    /** \brief Removes and returns all the remaining items of the queue, used to release the
+     *         resources of the items after the queue has been aborted.
+     *
+     */
+    std::deque<T> drain()
+    {
+      QMutexLocker lock(&m_mutex);
+
+      std::deque<T> items;
+      items.swap(m_items);
+      m_notFull.wakeAll();
+
+      return items;
+    }
+
+    /** \brief Returns the number of items in the queue.
+     *
+     */
+    size_t size() const
+    {
+      QMutexLocker lock(&m_mutex);
+      return m_items.size();
+    }
+
+  private:
+    const size_t   m_capacity; /** maximum number of items.            */
+    bool           m_aborted;  /** true if aborted, false otherwise.   */
+    std::deque<T>  m_items;    /** queued items.                       */
+    mutable QMutex m_mutex;    /** protects the queue data.            */
+    QWaitCondition m_notEmpty; /** signaled when an item is added.     */
+    QWaitCondition m_notFull;  /** signaled when an item is removed.   */
+};
+
+#endif // BOUNDEDQUEUE_H_
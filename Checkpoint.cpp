@@ -0,0 +1,150 @@
+/*
+ File: Checkpoint.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Checkpoint.h>
+
+// Qt
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+//--------------------------------------------------------------------
+Checkpoint::Checkpoint(const std::filesystem::path &source, const quint32 configuration)
+: m_source       (source)
+, m_configuration{configuration}
+{
+}
+
+//--------------------------------------------------------------------
+bool Checkpoint::load()
+{
+  m_segments.clear();
+
+  QFile file(checkpointFilename(m_source));
+  if(!file.exists() || !file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  quint32 magic, version, configuration, count;
+  qint64 size, modified, currentSize, currentModified;
+  stream >> magic >> version >> size >> modified >> configuration >> count;
+
+  if(stream.status() != QDataStream::Ok || magic != s_magic || version != s_version || configuration != m_configuration) return false;
+  if(!sourceStamp(currentSize, currentModified) || size != currentSize || modified != currentModified) return false;
+
+  for(quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+  {
+    Segment segment;
+    qint64 start, end, length;
+
+    stream >> start >> end >> length >> segment.bytes >> segment.done;
+
+    segment.start  = start;
+    segment.end    = end;
+    segment.length = length;
+
+    m_segments.push_back(segment);
+  }
+
+  if(stream.status() != QDataStream::Ok || m_segments.size() < 2)
+  {
+    m_segments.clear();
+    return false;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+bool Checkpoint::save() const
+{
+  qint64 size, modified;
+  if(!sourceStamp(size, modified)) return false;
+
+  // a checkpoint is replaced only when the new one has been completely written.
+  QSaveFile file(checkpointFilename(m_source));
+  if(!file.open(QIODevice::WriteOnly)) return false;
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  stream << s_magic << s_version << size << modified << m_configuration << static_cast<quint32>(m_segments.size());
+
+  for(const auto &segment: m_segments)
+  {
+    stream << static_cast<qint64>(segment.start) << static_cast<qint64>(segment.end) << static_cast<qint64>(segment.length)
+           << segment.bytes << segment.done;
+  }
+
+  return stream.status() == QDataStream::Ok && file.commit();
+}
+
+//--------------------------------------------------------------------
+void Checkpoint::remove() const
+{
+  QFile::remove(checkpointFilename(m_source));
+}
+
+//--------------------------------------------------------------------
+std::vector<Checkpoint::Segment> &Checkpoint::segments()
+{
+  return m_segments;
+}
+
+//--------------------------------------------------------------------
+bool Checkpoint::isDone(const size_t index, const std::filesystem::path &output) const
+{
+  if(index >= m_segments.size() || !m_segments[index].done) return false;
+
+  // the output could have been truncated or removed after the checkpoint.
+  const QFileInfo info(QString::fromStdWString(output.wstring()));
+
+  return info.exists() && info.size() == m_segments[index].bytes;
+}
+
+//--------------------------------------------------------------------
+void Checkpoint::setDone(const size_t index, const std::filesystem::path &output)
+{
+  if(index >= m_segments.size()) return;
+
+  m_segments[index].bytes = QFileInfo(QString::fromStdWString(output.wstring())).size();
+  m_segments[index].done  = true;
+}
+
+//--------------------------------------------------------------------
+QString Checkpoint::checkpointFilename(const std::filesystem::path &source)
+{
+  return QString::fromStdWString(source.wstring() + L".checkpoint");
+}
+
+//--------------------------------------------------------------------
+bool Checkpoint::sourceStamp(qint64 &size, qint64 &modified) const
+{
+  const QFileInfo info(QString::fromStdWString(m_source.wstring()));
+  if(!info.exists()) return false;
+
+  size     = info.size();
+  modified = info.lastModified().toMSecsSinceEpoch();
+
+  return true;
+}
@@ -0,0 +1,117 @@
+/*
+ File: Checkpoint.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+// Qt
+#include <QString>
+
+// C++
+#include <filesystem>
+#include <vector>
+
+/** \class Checkpoint
+ * \brief Progress of the video transcoding of a file split in segments at input keyframes, stored next to
+ *        the file. Each finished segment records its input timestamps and the size of its output, so an
+ *        interrupted transcoding resumes from the last finished segments instead of from the beginning.
+ *        Only valid for the same, unchanged, source file and configuration.
+ *
+ */
+class Checkpoint
+{
+  public:
+    /** \struct Segment
+     * \brief Segment of the video stream between two input keyframes.
+     *
+     */
+    struct Segment
+    {
+      long long start  = 0;     /** pts of the keyframe that starts the segment.                       */
+      long long end    = 0;     /** pts of the keyframe of the next segment or AV_NOPTS_VALUE if last. */
+      long long length = 0;     /** duration of the segment in stream time base units.                 */
+      qint64    bytes  = 0;     /** size of the output of the segment when finished.                   */
+      bool      done   = false; /** true if the segment has been transcoded.                           */
+    };
+
+    /** \brief Checkpoint class constructor.
+     * \param[in] source source file path.
+     * \param[in] configuration signature of the configuration used to transcode the file.
+     *
+     */
+    explicit Checkpoint(const std::filesystem::path &source, const quint32 configuration);
+
+    /** \brief Loads the checkpoint of the file. Returns true if it exists and belongs to the same file
+     *         and configuration, false otherwise.
+     *
+     */
+    bool load();
+
+    /** \brief Writes the checkpoint to disk, replacing the previous one. Returns true on success and false otherwise.
+     *
+     */
+    bool save() const;
+
+    /** \brief Removes the checkpoint from disk.
+     *
+     */
+    void remove() const;
+
+    /** \brief Returns the segments of the video stream.
+     *
+     */
+    std::vector<Segment> &segments();
+
+    /** \brief Returns true if the segment has been transcoded and its output is complete.
+     * \param[in] index segment index.
+     * \param[in] output output file of the segment.
+     *
+     */
+    bool isDone(const size_t index, const std::filesystem::path &output) const;
+
+    /** \brief Marks the segment as transcoded.
+     * \param[in] index segment index.
+     * \param[in] output output file of the segment.
+     *
+     */
+    void setDone(const size_t index, const std::filesystem::path &output);
+
+    /** \brief Returns the path of the checkpoint file of a source file.
+     * \param[in] source source file path.
+     *
+     */
+    static QString checkpointFilename(const std::filesystem::path &source);
+
+  private:
+    /** \brief Gets the size and modification time of the source file. Returns true on success and false otherwise.
+     * \param[out] size size of the file in bytes.
+     * \param[out] modified modification time in ms since epoch.
+     *
+     */
+    bool sourceStamp(qint64 &size, qint64 &modified) const;
+
+    const std::filesystem::path m_source;        /** source file path.                     */
+    const quint32               m_configuration; /** signature of the configuration.       */
+    std::vector<Segment>        m_segments;      /** segments of the video stream.         */
+
+    static const quint32 s_magic   = 0x56544350; /** checkpoint file identifier. */
+    static const quint32 s_version = 1;          /** checkpoint file version.    */
+};
+
+#endif // CHECKPOINT_H_
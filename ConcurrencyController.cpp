@@ -0,0 +1,150 @@
+/*
+ File: ConcurrencyController.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ConcurrencyController.h>
+
+// Qt
+#include <QFile>
+#include <QStringList>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+// C++
+#include <algorithm>
+
+//--------------------------------------------------------------------
+ConcurrencyController::ConcurrencyController(const int maximum)
+: m_maximum   {std::max(1, maximum)}
+, m_current   {std::max(1, m_maximum / 2)}
+, m_direction {1}
+, m_throughput{-1}
+, m_cpu       {0, 0, 0}
+, m_cpuValid  {false}
+{
+  m_cpuValid = readCpuTimes(m_cpu);
+}
+
+//--------------------------------------------------------------------
+int ConcurrencyController::concurrency() const
+{
+  return m_current;
+}
+
+//--------------------------------------------------------------------
+QString ConcurrencyController::update(const double framesPerSecond)
+{
+  double cpu    = -1;
+  double iowait = -1;
+
+  CpuTimes times;
+  if(m_cpuValid && readCpuTimes(times) && times.total > m_cpu.total)
+  {
+    const auto elapsed = static_cast<double>(times.total - m_cpu.total);
+    cpu    = 100.0 * (times.busy - m_cpu.busy) / elapsed;
+    iowait = 100.0 * (times.iowait - m_cpu.iowait) / elapsed;
+    m_cpu  = times;
+  }
+
+  QString reason;
+  const auto previous = m_current;
+
+  if(m_throughput < 0)
+  {
+    reason = "first sample";
+  }
+  else if(framesPerSecond > m_throughput * (1 + s_tolerance))
+  {
+    reason = "throughput improved";
+  }
+  else if(framesPerSecond < m_throughput * (1 - s_tolerance))
+  {
+    m_direction = -m_direction;
+    reason = "throughput dropped";
+  }
+  else
+  {
+    // no change, follow the load of the system if known.
+    if(iowait >= 20)
+    {
+      m_direction = -1;
+      reason = "waiting for I/O";
+    }
+    else if(cpu >= 0 && cpu < 85)
+    {
+      m_direction = 1;
+      reason = "idle CPU";
+    }
+    else
+    {
+      m_direction = 0;
+      reason = "no change";
+    }
+  }
+
+  m_current    = std::min(m_maximum, std::max(1, m_current + m_direction));
+  m_throughput = framesPerSecond;
+
+  // bounce at the limits instead of sticking to them.
+  if(m_direction == 0 || m_current == previous) m_direction = (m_current == m_maximum) ? -1 : 1;
+
+  const auto load = (cpu >= 0) ? QString(", CPU %1%, I/O wait %2%").arg(cpu, 0, 'f', 0).arg(iowait, 0, 'f', 0) : QString();
+
+  return QString("Simultaneous jobs %1 -> %2 (%3 frames/s%4, %5).").arg(previous).arg(m_current)
+                                                                   .arg(framesPerSecond, 0, 'f', 1)
+                                                                   .arg(load).arg(reason);
+}
+
+//--------------------------------------------------------------------
+bool ConcurrencyController::readCpuTimes(CpuTimes &times)
+{
+#if defined(Q_OS_LINUX)
+  QFile file("/proc/stat");
+  if(!file.open(QIODevice::ReadOnly|QIODevice::Text)) return false;
+
+  // cpu user nice system idle iowait irq softirq steal ...
+  const auto fields = QString::fromLatin1(file.readLine()).simplified().split(' ');
+  if(fields.size() < 8 || fields.first() != "cpu") return false;
+
+  unsigned long long values[7];
+  for(int i = 0; i < 7; ++i) values[i] = fields.at(i + 1).toULongLong();
+
+  times.busy   = values[0] + values[1] + values[2] + values[5] + values[6];
+  times.iowait = values[4];
+  times.total  = times.busy + values[3] + values[4];
+
+  return true;
+#elif defined(Q_OS_WIN)
+  FILETIME idle, kernel, user;
+  if(!GetSystemTimes(&idle, &kernel, &user)) return false;
+
+  auto value = [](const FILETIME &time) { return (static_cast<unsigned long long>(time.dwHighDateTime) << 32) | time.dwLowDateTime; };
+
+  // kernel time includes the idle time, the I/O wait isn't available.
+  times.total  = value(kernel) + value(user);
+  times.busy   = times.total - value(idle);
+  times.iowait = 0;
+
+  return true;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,82 @@
+/*
+ File: ConcurrencyController.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONCURRENCYCONTROLLER_H_
+#define CONCURRENCYCONTROLLER_H_
+
+// Qt
+#include <QString>
+
+/** \class ConcurrencyController
+ * \brief Decides the number of simultaneous jobs of the automatic mode. Hill-climbs the number of jobs
+ *        using the measured frames per second: keeps moving in the same direction while the throughput
+ *        improves and turns back when it drops. When the throughput doesn't change the CPU utilization
+ *        and I/O wait of the system decide.
+ *
+ */
+class ConcurrencyController
+{
+  public:
+    /** \brief ConcurrencyController class constructor.
+     * \param[in] maximum maximum number of simultaneous jobs.
+     *
+     */
+    explicit ConcurrencyController(const int maximum);
+
+    /** \brief Returns the current number of simultaneous jobs.
+     *
+     */
+    int concurrency() const;
+
+    /** \brief Takes a sample of the system load and decides the number of simultaneous jobs. Returns
+     *         the description of the decision.
+     * \param[in] framesPerSecond frames per second processed by all the jobs since the last sample.
+     *
+     */
+    QString update(const double framesPerSecond);
+
+  private:
+    /** \struct CpuTimes
+     * \brief Accumulated CPU times of the system.
+     *
+     */
+    struct CpuTimes
+    {
+      unsigned long long busy;   /** time running processes. */
+      unsigned long long iowait; /** time waiting for I/O.    */
+      unsigned long long total;  /** total time.              */
+    };
+
+    /** \brief Reads the accumulated CPU times of the system. Returns true on success and false if not available.
+     * \param[out] times CPU times.
+     *
+     */
+    static bool readCpuTimes(CpuTimes &times);
+
+    const int m_maximum;    /** maximum number of simultaneous jobs.                  */
+    int       m_current;    /** current number of simultaneous jobs.                  */
+    int       m_direction;  /** +1 increasing, -1 decreasing the number of jobs.     */
+    double    m_throughput; /** frames per second of the previous sample, -1 if none. */
+    CpuTimes  m_cpu;        /** CPU times of the previous sample.                     */
+    bool      m_cpuValid;   /** true if the CPU times are available.                  */
+
+    static constexpr double s_tolerance = 0.05; /** relative throughput change considered noise. */
+};
+
+#endif // CONCURRENCYCONTROLLER_H_
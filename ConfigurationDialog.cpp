@@ -24,6 +24,7 @@
 #include <QLineEdit>
 #include <QFile>
 #include <QTextStream>
+#include <QApplication>
 
 using namespace Utils;
 
@@ -103,7 +104,7 @@ void ConfigurationDialog::updateFormatComboBoxes()
 //--------------------------------------------------------------------
 void ConfigurationDialog::changeTheme(int index)
 {
-  Utils::setApplicationTheme(index == 0 ? "Light":"Dark");
+  setApplicationTheme(index == 0 ? "Light":"Dark");
 }
 
 //--------------------------------------------------------------------
@@ -114,8 +115,28 @@ void ConfigurationDialog::reject()
 
   if(theme.compare(current, Qt::CaseInsensitive) != 0)
   {
-    Utils::setApplicationTheme(theme);
+    setApplicationTheme(theme);
   }
 
   QDialog::reject();
 }
+
+//-----------------------------------------------------------------
+void ConfigurationDialog::setApplicationTheme(const QString &theme)
+{
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+
+  QString sheet;
+
+  if (theme.compare("Light", Qt::CaseInsensitive) != 0)
+  {
+    QFile file(":qdarkstyle/style.qss");
+    file.open(QFile::ReadOnly | QFile::Text);
+    QTextStream ts(&file);
+    sheet = ts.readAll();
+  }
+
+  qApp->setStyleSheet(sheet);
+
+  QApplication::restoreOverrideCursor();
+}
@@ -53,6 +53,12 @@ class ConfigurationDialog
     virtual void accept() override;
     virtual void reject() override;
 
+    /** \brief Sets the visual theme of the application.
+     * \param[in] theme Possible values: Light/Dark
+     *
+     */
+    static void setApplicationTheme(const QString &theme);
+
   private slots:
     /** \brief Helper method to fill the combo boxes with the values according to configuration or user interaction.
      *
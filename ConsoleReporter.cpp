@@ -0,0 +1,113 @@
+/*
+ File: ConsoleReporter.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ConsoleReporter.h>
+#include <Scheduler.h>
+#include <Worker.h>
+
+// Qt
+#include <QJsonDocument>
+#include <QDateTime>
+
+// C++
+#include <cstdio>
+
+//--------------------------------------------------------------------
+ConsoleReporter::ConsoleReporter(Scheduler *scheduler, QObject *parent)
+: QObject      {parent}
+, m_scheduler  {scheduler}
+, m_errorsCount{0}
+{
+  connect(m_scheduler, SIGNAL(worker_started(Worker *, const QString &)), this, SLOT(on_worker_started(Worker *, const QString &)));
+  connect(m_scheduler, SIGNAL(worker_finished(Worker *)),                 this, SLOT(on_worker_finished(Worker *)));
+  connect(m_scheduler, SIGNAL(error_message(const QString &)),            this, SLOT(on_error(const QString &)));
+  connect(m_scheduler, SIGNAL(information_message(const QString &)),      this, SLOT(on_information(const QString &)));
+  connect(m_scheduler, SIGNAL(finished()),                                this, SLOT(on_finished()));
+}
+
+//--------------------------------------------------------------------
+int ConsoleReporter::errorsCount() const
+{
+  return m_errorsCount;
+}
+
+//--------------------------------------------------------------------
+void ConsoleReporter::write(const QString &event, QJsonObject data)
+{
+  data.insert("event", event);
+  data.insert("time", QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs));
+
+  const auto line = QJsonDocument(data).toJson(QJsonDocument::Compact);
+
+  std::fwrite(line.constData(), 1, line.size(), stdout);
+  std::fputc('\n', stdout);
+  std::fflush(stdout);
+}
+
+//--------------------------------------------------------------------
+void ConsoleReporter::on_worker_started(Worker *worker, const QString &name)
+{
+  const auto path = QString::fromStdWString(worker->source_path().wstring());
+  m_names.insert(worker, path);
+
+  write("job_started", QJsonObject{{"file", path}, {"name", name}});
+
+  // progress is emitted from the worker thread and can be delivered after the worker has been
+  // deleted, so the lambda must not touch the worker.
+  connect(worker, &Worker::progress, this, [path](int value)
+  {
+    write("progress", QJsonObject{{"file", path}, {"value", value}});
+  });
+}
+
+//--------------------------------------------------------------------
+void ConsoleReporter::on_worker_finished(Worker *worker)
+{
+  const auto path = m_names.take(worker);
+
+  QString status = "done";
+  if(worker->has_been_cancelled())  status = "cancelled";
+  else if(worker->has_failed())     status = "failed";
+
+  write("job_finished", QJsonObject{{"file", path}, {"status", status}});
+}
+
+//--------------------------------------------------------------------
+void ConsoleReporter::on_error(const QString &message)
+{
+  ++m_errorsCount;
+
+  write("error", QJsonObject{{"message", message}});
+}
+
+//--------------------------------------------------------------------
+void ConsoleReporter::on_information(const QString &message)
+{
+  write("info", QJsonObject{{"message", message}});
+}
+
+//--------------------------------------------------------------------
+void ConsoleReporter::on_finished()
+{
+  write("finished", QJsonObject{{"jobs",      m_scheduler->jobsCount()},
+                                {"completed", m_scheduler->finishedJobsCount()},
+                                {"errors",    m_errorsCount},
+                                {"cancelled", m_scheduler->hasBeenCancelled()}});
+}
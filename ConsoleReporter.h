@@ -0,0 +1,103 @@
+/*
+ File: ConsoleReporter.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLEREPORTER_H_
+#define CONSOLEREPORTER_H_
+
+// Qt
+#include <QObject>
+#include <QJsonObject>
+#include <QMap>
+
+class Scheduler;
+class Worker;
+
+/** \class ConsoleReporter
+ * \brief Writes the progress of a Scheduler to the standard output as JSON lines, one object per
+ *        event with an "event" field identifying it.
+ *
+ */
+class ConsoleReporter
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /** \brief ConsoleReporter class constructor.
+     * \param[in] scheduler Scheduler to report.
+     * \param[in] parent Raw pointer of the object parent of this one.
+     *
+     */
+    explicit ConsoleReporter(Scheduler *scheduler, QObject *parent = nullptr);
+
+    /** \brief ConsoleReporter class virtual destructor.
+     *
+     */
+    virtual ~ConsoleReporter()
+    {}
+
+    /** \brief Returns the number of errors reported.
+     *
+     */
+    int errorsCount() const;
+
+    /** \brief Writes the given event to the standard output.
+     * \param[in] event Event identifier.
+     * \param[in] data Event data.
+     *
+     */
+    static void write(const QString &event, QJsonObject data = QJsonObject());
+
+  private slots:
+    /** \brief Reports the start of a job and starts tracking its progress.
+     * \param[in] worker Worker raw pointer.
+     * \param[in] name Name of the processed file.
+     *
+     */
+    void on_worker_started(Worker *worker, const QString &name);
+
+    /** \brief Reports the end of a job.
+     * \param[in] worker Worker raw pointer.
+     *
+     */
+    void on_worker_finished(Worker *worker);
+
+    /** \brief Reports an error message.
+     * \param[in] message message string.
+     *
+     */
+    void on_error(const QString &message);
+
+    /** \brief Reports an information message.
+     * \param[in] message message string.
+     *
+     */
+    void on_information(const QString &message);
+
+    /** \brief Reports the end of the process.
+     *
+     */
+    void on_finished();
+
+  private:
+    Scheduler              *m_scheduler;   /** reported scheduler.                      */
+    QMap<Worker *, QString> m_names;       /** maps running worker<->source file path.  */
+    int                     m_errorsCount; /** number of errors reported.               */
+};
+
+#endif // CONSOLEREPORTER_H_
@@ -0,0 +1,378 @@
+/*
+ File: Coordinator.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Coordinator.h>
+#include <JobQueue.h>
+
+// Qt
+#include <QJsonDocument>
+#include <QSet>
+#include <QTcpSocket>
+
+// C++
+#include <algorithm>
+
+//--------------------------------------------------------------------
+Coordinator::Coordinator(const std::vector<std::filesystem::path> &files, const Utils::TranscoderConfiguration::JobOrder order, QObject *parent)
+: QObject        {parent}
+, m_finished_jobs{0}
+, m_failed_jobs  {0}
+, m_cancelled    {false}
+, m_finished     {false}
+{
+  // the agents receive the jobs in the configured order.
+  JobQueue queue(order);
+  for(const auto &file: files) queue.push(file);
+
+  // an input given twice would be transcoded twice at the same time.
+  QSet<QString> known;
+
+  std::filesystem::path file;
+  while(queue.pop(file))
+  {
+    const auto path = QString::fromStdWString(std::filesystem::absolute(file).lexically_normal().wstring());
+    if(known.contains(path)) continue;
+    known.insert(path);
+
+    m_pending.push_back(m_jobs.size());
+    m_jobs << Job{path, nullptr, 0};
+  }
+
+  m_heartbeat_timer.setInterval(s_heartbeat_timeout / 3);
+
+  connect(&m_server,          SIGNAL(newConnection()), this, SLOT(on_new_connection()));
+  connect(&m_heartbeat_timer, SIGNAL(timeout()),       this, SLOT(on_heartbeat_timeout()));
+
+  m_clock.start();
+}
+
+//--------------------------------------------------------------------
+bool Coordinator::listen(const quint16 port)
+{
+  if(!m_server.listen(QHostAddress::Any, port))
+  {
+    emit error_message(tr("Unable to accept agents in port %1: %2").arg(port).arg(m_server.errorString()));
+    return false;
+  }
+
+  emit information_message(tr("Waiting for agents in port %1.").arg(m_server.serverPort()));
+
+  m_heartbeat_timer.start();
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+int Coordinator::jobsCount() const
+{
+  return m_jobs.size();
+}
+
+//--------------------------------------------------------------------
+int Coordinator::finishedJobsCount() const
+{
+  return m_finished_jobs;
+}
+
+//--------------------------------------------------------------------
+int Coordinator::failedJobsCount() const
+{
+  return m_failed_jobs;
+}
+
+//--------------------------------------------------------------------
+bool Coordinator::hasBeenCancelled() const
+{
+  return m_cancelled;
+}
+
+//--------------------------------------------------------------------
+void Coordinator::send(QTcpSocket *socket, const QString &type, QJsonObject data)
+{
+  data.insert("type", type);
+
+  socket->write(QJsonDocument(data).toJson(QJsonDocument::Compact) + '\n');
+}
+
+//--------------------------------------------------------------------
+QList<QJsonObject> Coordinator::receive(QTcpSocket *socket)
+{
+  QList<QJsonObject> messages;
+
+  while(socket->canReadLine())
+  {
+    const auto line = socket->readLine().trimmed();
+    if(line.isEmpty()) continue;
+
+    // malformed messages are ignored.
+    QJsonParseError error;
+    const auto document = QJsonDocument::fromJson(line, &error);
+    if(error.error == QJsonParseError::NoError && document.isObject()) messages << document.object();
+  }
+
+  return messages;
+}
+
+//--------------------------------------------------------------------
+void Coordinator::stop()
+{
+  if(m_cancelled) return;
+
+  m_cancelled = true;
+  m_pending.clear();
+
+  finish_if_done();
+}
+
+//--------------------------------------------------------------------
+void Coordinator::on_new_connection()
+{
+  while(m_server.hasPendingConnections())
+  {
+    auto socket = m_server.nextPendingConnection();
+
+    // the agent gets jobs once it says hello.
+    m_peers.insert(socket, Peer{QString(), 0, QList<int>(), m_clock.elapsed(), 0.});
+
+    connect(socket, SIGNAL(readyRead()),    this, SLOT(on_ready_read()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(on_disconnected()));
+  }
+}
+
+//--------------------------------------------------------------------
+void Coordinator::on_ready_read()
+{
+  auto socket = qobject_cast<QTcpSocket *>(sender());
+  Q_ASSERT(socket);
+
+  for(const auto &message: receive(socket))
+  {
+    // a message can drop the agent or finish the batch.
+    if(!m_peers.contains(socket) || m_finished) break;
+
+    process(socket, message);
+  }
+}
+
+//--------------------------------------------------------------------
+void Coordinator::on_disconnected()
+{
+  auto socket = qobject_cast<QTcpSocket *>(sender());
+
+  if(socket && m_peers.contains(socket))
+  {
+    drop(socket, tr("disconnected"));
+  }
+}
+
+//--------------------------------------------------------------------
+void Coordinator::on_heartbeat_timeout()
+{
+  const auto now = m_clock.elapsed();
+
+  QList<QTcpSocket *> silent;
+  for(auto it = m_peers.cbegin(); it != m_peers.cend(); ++it)
+  {
+    if(now - it.value().last_seen > s_heartbeat_timeout) silent << it.key();
+  }
+
+  for(auto socket: silent)
+  {
+    drop(socket, tr("stopped sending heartbeats"));
+  }
+}
+
+//--------------------------------------------------------------------
+void Coordinator::process(QTcpSocket *socket, const QJsonObject &message)
+{
+  auto &peer = m_peers[socket];
+  peer.last_seen = m_clock.elapsed();
+
+  const auto type = message.value("type").toString();
+
+  if(type == "hello")
+  {
+    peer.name     = message.value("name").toString();
+    peer.capacity = std::max(1, message.value("capacity").toInt(1));
+
+    if(peer.name.isEmpty()) peer.name = QString("%1:%2").arg(socket->peerAddress().toString()).arg(socket->peerPort());
+
+    emit information_message(tr("Agent '%1' connected, capacity %2 simultaneous jobs.").arg(peer.name).arg(peer.capacity));
+
+    dispatch();
+    finish_if_done();
+  }
+  else if(type == "heartbeat")
+  {
+    peer.throughput = message.value("throughput").toDouble();
+
+    emit agent_status(peer.name, peer.jobs.size(), peer.capacity, peer.throughput);
+  }
+  else if(type == "progress")
+  {
+    const auto id = message.value("id").toInt(-1);
+    if(peer.jobs.contains(id))
+    {
+      emit job_progress(m_jobs.at(id).file, peer.name, message.value("value").toInt());
+    }
+  }
+  else if(type == "result")
+  {
+    // results of jobs given to other agents are ignored.
+    const auto id = message.value("id").toInt(-1);
+    if(!peer.jobs.removeOne(id)) return;
+
+    const auto status = message.value("status").toString();
+    const auto name   = peer.name;
+
+    if(status == "cancelled")
+    {
+      requeue(id, name);
+    }
+    else
+    {
+      auto &job = m_jobs[id];
+      job.agent = nullptr;
+
+      ++m_finished_jobs;
+      if(status == "failed") ++m_failed_jobs;
+
+      emit job_finished(job.file, name, status);
+    }
+
+    dispatch();
+    finish_if_done();
+  }
+  else if(type == "message")
+  {
+    const auto text = QString("[%1] %2").arg(peer.name).arg(message.value("text").toString());
+
+    if(message.value("level").toString() == "error") emit error_message(text);
+    else                                             emit information_message(text);
+  }
+}
+
+//--------------------------------------------------------------------
+void Coordinator::dispatch()
+{
+  while(!m_cancelled && !m_pending.empty())
+  {
+    // the free agent with the lowest load relative to its capacity, the largest one on ties.
+    QTcpSocket *target = nullptr;
+    double targetLoad = 1.;
+    int targetCapacity = 0;
+
+    for(auto it = m_peers.cbegin(); it != m_peers.cend(); ++it)
+    {
+      const auto &peer = it.value();
+      if(peer.name.isEmpty() || peer.jobs.size() >= peer.capacity) continue;
+
+      const auto load = static_cast<double>(peer.jobs.size()) / peer.capacity;
+      if(!target || load < targetLoad || (load == targetLoad && peer.capacity > targetCapacity))
+      {
+        target         = it.key();
+        targetLoad     = load;
+        targetCapacity = peer.capacity;
+      }
+    }
+
+    if(!target) break;
+
+    const auto id = m_pending.front();
+    m_pending.pop_front();
+
+    auto &job = m_jobs[id];
+    job.agent = target;
+    ++job.attempts;
+
+    m_peers[target].jobs << id;
+
+    send(target, "job", QJsonObject{{"id", id}, {"file", job.file}});
+  }
+}
+
+//--------------------------------------------------------------------
+void Coordinator::requeue(const int id, const QString &agent)
+{
+  auto &job = m_jobs[id];
+  job.agent = nullptr;
+
+  if(job.attempts >= s_max_attempts)
+  {
+    ++m_finished_jobs;
+    ++m_failed_jobs;
+
+    emit error_message(tr("File '%1' has been interrupted in %2 agents, it won't be sent again.").arg(job.file).arg(job.attempts));
+    emit job_finished(job.file, agent, "failed");
+    return;
+  }
+
+  if(!m_cancelled) m_pending.push_front(id);
+}
+
+//--------------------------------------------------------------------
+void Coordinator::drop(QTcpSocket *socket, const QString &reason)
+{
+  const auto peer = m_peers.take(socket);
+
+  socket->disconnect(this);
+  socket->abort();
+  socket->deleteLater();
+
+  if(!peer.name.isEmpty())
+  {
+    emit information_message(tr("Agent '%1' %2, %3 running jobs returned to the queue.").arg(peer.name).arg(reason).arg(peer.jobs.size()));
+  }
+
+  // returned to the front in their original order.
+  for(auto it = peer.jobs.crbegin(); it != peer.jobs.crend(); ++it)
+  {
+    requeue(*it, peer.name);
+  }
+
+  dispatch();
+  finish_if_done();
+}
+
+//--------------------------------------------------------------------
+void Coordinator::finish_if_done()
+{
+  if(m_finished) return;
+
+  if(!m_cancelled && m_finished_jobs < m_jobs.size()) return;
+
+  // the agents stop their jobs when cancelled and quit when there are no more.
+  for(auto it = m_peers.cbegin(); it != m_peers.cend(); ++it)
+  {
+    auto socket = it.key();
+    socket->disconnect(this);
+
+    send(socket, m_cancelled ? "cancel" : "quit");
+    socket->flush();
+    socket->disconnectFromHost();
+  }
+
+  m_peers.clear();
+  m_heartbeat_timer.stop();
+  m_server.close();
+
+  m_finished = true;
+  emit finished();
+}
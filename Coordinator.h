@@ -0,0 +1,261 @@
+/*
+ File: Coordinator.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COORDINATOR_H_
+#define COORDINATOR_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QVector>
+#include <QTcpServer>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// C++
+#include <deque>
+#include <filesystem>
+#include <vector>
+
+class QTcpSocket;
+
+/** \class Coordinator
+ * \brief Owns the jobs of a batch and hands them to the agents connected over TCP. The messages are
+ *        JSON objects, one per line, with a "type" field identifying them. Each agent receives jobs
+ *        until it's running as many as its capacity, the free agent with the lowest load relative to
+ *        its capacity gets the next one. The jobs of the agents that disconnect or stop sending
+ *        heartbeats are given to the others. The agents must see the files in the same paths.
+ *
+ */
+class Coordinator
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /** \brief Coordinator class constructor.
+     * \param[in] files List of files to be transcoded.
+     * \param[in] order Order of the jobs.
+     * \param[in] parent Raw pointer of the object parent of this one.
+     *
+     */
+    explicit Coordinator(const std::vector<std::filesystem::path> &files,
+                         const Utils::TranscoderConfiguration::JobOrder order,
+                         QObject *parent = nullptr);
+
+    /** \brief Coordinator class virtual destructor.
+     *
+     */
+    virtual ~Coordinator()
+    {}
+
+    /** \brief Starts accepting agents in the given port of all the interfaces. Returns true on success
+     *         and false otherwise.
+     * \param[in] port TCP port.
+     *
+     */
+    bool listen(const quint16 port);
+
+    /** \brief Returns the total number of jobs.
+     *
+     */
+    int jobsCount() const;
+
+    /** \brief Returns the number of jobs that have been completed.
+     *
+     */
+    int finishedJobsCount() const;
+
+    /** \brief Returns the number of jobs that have failed.
+     *
+     */
+    int failedJobsCount() const;
+
+    /** \brief Returns true if the process has been stopped.
+     *
+     */
+    bool hasBeenCancelled() const;
+
+    /** \brief Returns the TCP port used when none is given.
+     *
+     */
+    static quint16 defaultPort()
+    { return 19750; }
+
+    /** \brief Writes a message to the given socket.
+     * \param[in] socket connection socket.
+     * \param[in] type message type.
+     * \param[in] data message data.
+     *
+     */
+    static void send(QTcpSocket *socket, const QString &type, QJsonObject data = QJsonObject());
+
+    /** \brief Reads the complete messages available in the given socket.
+     * \param[in] socket connection socket.
+     *
+     */
+    static QList<QJsonObject> receive(QTcpSocket *socket);
+
+  public slots:
+    /** \brief Tells the agents to stop their jobs and stops handing new ones.
+     *
+     */
+    void stop();
+
+  signals:
+    /** \brief Emitted when an agent reports the progress of a job.
+     * \param[in] file source file path.
+     * \param[in] agent agent name.
+     * \param[in] value progress value in [0-100].
+     *
+     */
+    void job_progress(const QString &file, const QString &agent, int value);
+
+    /** \brief Emitted when an agent reports the end of a job.
+     * \param[in] file source file path.
+     * \param[in] agent agent name.
+     * \param[in] status "done", "failed" or "skipped".
+     *
+     */
+    void job_finished(const QString &file, const QString &agent, const QString &status);
+
+    /** \brief Emitted when an agent sends a heartbeat.
+     * \param[in] agent agent name.
+     * \param[in] jobs number of jobs running in the agent.
+     * \param[in] capacity simultaneous jobs of the agent.
+     * \param[in] throughput frames per second of the agent.
+     *
+     */
+    void agent_status(const QString &agent, int jobs, int capacity, double throughput);
+
+    /** \brief Emits an error message of the coordinator or the agents.
+     * \param[in] message error message.
+     *
+     */
+    void error_message(const QString &message);
+
+    /** \brief Emits an information message of the coordinator or the agents.
+     * \param[in] message information message.
+     *
+     */
+    void information_message(const QString &message);
+
+    /** \brief Emitted when all the jobs have finished or the process has been stopped.
+     *
+     */
+    void finished();
+
+  private slots:
+    /** \brief Accepts the pending connections.
+     *
+     */
+    void on_new_connection();
+
+    /** \brief Processes the messages of the agent that emitted the signal.
+     *
+     */
+    void on_ready_read();
+
+    /** \brief Gives the jobs of the agent that emitted the signal to the others.
+     *
+     */
+    void on_disconnected();
+
+    /** \brief Drops the agents that haven't sent a heartbeat in time.
+     *
+     */
+    void on_heartbeat_timeout();
+
+  private:
+    /** \struct Job
+     * \brief Job of the batch.
+     *
+     */
+    struct Job
+    {
+      QString     file;     /** source file path.                           */
+      QTcpSocket *agent;    /** agent running the job, nullptr if not sent. */
+      int         attempts; /** number of times the job has been sent.      */
+    };
+
+    /** \struct Peer
+     * \brief Connected agent.
+     *
+     */
+    struct Peer
+    {
+      QString    name;       /** agent name, empty until it says hello.   */
+      int        capacity;   /** simultaneous jobs of the agent.          */
+      QList<int> jobs;       /** jobs sent to the agent and not finished. */
+      qint64     last_seen;  /** clock time of the last message in ms.    */
+      double     throughput; /** last reported frames per second.         */
+    };
+
+    /** \brief Processes a message of an agent.
+     * \param[in] socket agent connection.
+     * \param[in] message message object.
+     *
+     */
+    void process(QTcpSocket *socket, const QJsonObject &message);
+
+    /** \brief Sends the pending jobs to the agents with free capacity.
+     *
+     */
+    void dispatch();
+
+    /** \brief Returns an interrupted job to the front of the pending ones, or marks it as failed if it
+     *         has been sent too many times.
+     * \param[in] id job index.
+     * \param[in] agent name of the agent that was running it.
+     *
+     */
+    void requeue(const int id, const QString &agent);
+
+    /** \brief Returns the jobs of an agent to the pending ones and forgets it.
+     * \param[in] socket agent connection.
+     * \param[in] reason reason of the removal.
+     *
+     */
+    void drop(QTcpSocket *socket, const QString &reason);
+
+    /** \brief Tells the agents to quit and emits the finished signal if all the jobs have finished.
+     *
+     */
+    void finish_if_done();
+
+    static const int s_heartbeat_timeout = 15000; /** time without messages to drop an agent in ms.  */
+    static const int s_max_attempts      = 3;     /** times a job is sent before marking it failed. */
+
+    QTcpServer                m_server;          /** agents' connections server.                */
+    QVector<Job>              m_jobs;            /** jobs of the batch.                         */
+    std::deque<int>           m_pending;         /** jobs waiting for an agent.                 */
+    QHash<QTcpSocket *, Peer> m_peers;           /** connected agents.                          */
+    QTimer                    m_heartbeat_timer; /** agents' liveness check timer.              */
+    QElapsedTimer             m_clock;           /** time since the construction.               */
+    int                       m_finished_jobs;   /** number of completed jobs.                  */
+    int                       m_failed_jobs;     /** number of failed jobs.                     */
+    bool                      m_cancelled;       /** true if the process has been stopped.      */
+    bool                      m_finished;        /** true if process finished, false otherwise. */
+};
+
+#endif // COORDINATOR_H_
@@ -0,0 +1,96 @@
+/*
+ File: ExecutionPolicy.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ExecutionPolicy.h>
+
+#if defined(Q_OS_LINUX)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#include <cstring>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+using ExecutionClass = Utils::TranscoderConfiguration::ExecutionClass;
+
+//--------------------------------------------------------------------
+bool ExecutionPolicy::applyToCurrentThread(const ExecutionClass executionClass, QString &error)
+{
+  if(executionClass == ExecutionClass::NORMAL) return true;
+
+  const auto isIdle = (executionClass == ExecutionClass::IDLE);
+
+#if defined(Q_OS_LINUX)
+  const auto thread = static_cast<pid_t>(syscall(SYS_gettid));
+
+  // the policy, nice level and I/O priority of a thread are set with its id.
+  struct sched_param param;
+  param.sched_priority = 0;
+  if(sched_setscheduler(thread, isIdle ? SCHED_IDLE : SCHED_BATCH, &param) != 0)
+  {
+    error = QString("scheduling policy: %1").arg(strerror(errno));
+    return false;
+  }
+
+  if(setpriority(PRIO_PROCESS, thread, isIdle ? 19 : 10) != 0)
+  {
+    error = QString("nice level: %1").arg(strerror(errno));
+    return false;
+  }
+
+  // ioprio_set() has no glibc wrapper: IOPRIO_WHO_PROCESS, class (idle 3, best-effort 2) << 13 | level.
+  constexpr int IOPRIO_WHO_PROCESS = 1;
+  const int ioPriority = isIdle ? (3 << 13) : ((2 << 13) | 7);
+  if(syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, thread, ioPriority) != 0)
+  {
+    error = QString("I/O priority: %1").arg(strerror(errno));
+    return false;
+  }
+
+  return true;
+#elif defined(Q_OS_WIN)
+  if(!SetThreadPriority(GetCurrentThread(), isIdle ? THREAD_MODE_BACKGROUND_BEGIN : THREAD_PRIORITY_BELOW_NORMAL))
+  {
+    error = QString("thread priority: error %1").arg(GetLastError());
+    return false;
+  }
+
+  return true;
+#else
+  error = QString("not supported on this system");
+  return false;
+#endif
+}
+
+//--------------------------------------------------------------------
+QString ExecutionPolicy::name(const ExecutionClass executionClass)
+{
+  switch(executionClass)
+  {
+    case ExecutionClass::BATCH: return "batch";
+    case ExecutionClass::IDLE:  return "idle";
+    default:                    break;
+  }
+
+  return "normal";
+}
@@ -0,0 +1,57 @@
+/*
+ File: ExecutionPolicy.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EXECUTIONPOLICY_H_
+#define EXECUTIONPOLICY_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QString>
+
+/** \class ExecutionPolicy
+ * \brief Applies the execution class of the configuration to the threads of a worker. The threads created
+ *        afterwards by the calling thread (pipeline stages, codecs) inherit it on Linux.
+ *
+ *        - NORMAL: default policy, priority and I/O priority.
+ *        - BATCH: SCHED_BATCH, nice 10 and lowest best-effort I/O priority.
+ *        - IDLE: SCHED_IDLE, nice 19 and idle I/O priority, only uses the resources nobody else wants.
+ *
+ *        On Windows BATCH lowers the priority of the thread and IDLE uses the background mode of the thread.
+ *
+ */
+class ExecutionPolicy
+{
+  public:
+    /** \brief Applies the execution class to the calling thread. Returns true on success and false otherwise.
+     * \param[in] executionClass execution class identifier.
+     * \param[out] error description of the error if any.
+     *
+     */
+    static bool applyToCurrentThread(const Utils::TranscoderConfiguration::ExecutionClass executionClass, QString &error);
+
+    /** \brief Returns the name of the execution class.
+     * \param[in] executionClass execution class identifier.
+     *
+     */
+    static QString name(const Utils::TranscoderConfiguration::ExecutionClass executionClass);
+};
+
+#endif // EXECUTIONPOLICY_H_
@@ -0,0 +1,85 @@
+/*
+ File: FileDiscovery.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <FileDiscovery.h>
+
+//--------------------------------------------------------------------
+FileDiscovery::FileDiscovery(const std::filesystem::path &root, const Utils::SearchFilter &filter, QObject *parent)
+: QThread {parent}
+, m_root  {root}
+, m_filter{filter}
+, m_count {0}
+, m_stop  {false}
+{
+}
+
+//--------------------------------------------------------------------
+FileDiscovery::~FileDiscovery()
+{
+  stop();
+  wait();
+}
+
+//--------------------------------------------------------------------
+void FileDiscovery::stop()
+{
+  m_stop = true;
+}
+
+//--------------------------------------------------------------------
+bool FileDiscovery::take(std::vector<std::filesystem::path> &files)
+{
+  QMutexLocker lock(&m_mutex);
+
+  files = std::move(m_found);
+  m_found.clear();
+
+  return !files.empty();
+}
+
+//--------------------------------------------------------------------
+int FileDiscovery::foundCount() const
+{
+  return m_count;
+}
+
+//--------------------------------------------------------------------
+void FileDiscovery::run()
+{
+  Utils::findFiles(m_root, m_filter, [this](std::filesystem::path &&file)
+  {
+    if(m_stop) return false;
+
+    bool notify;
+    {
+      QMutexLocker lock(&m_mutex);
+
+      // the files found until the batch is taken go with it.
+      notify = m_found.empty();
+      m_found.push_back(std::move(file));
+    }
+
+    ++m_count;
+
+    if(notify) emit files_found();
+
+    return true;
+  });
+}
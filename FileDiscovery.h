@@ -0,0 +1,95 @@
+/*
+ File: FileDiscovery.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILEDISCOVERY_H_
+#define FILEDISCOVERY_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QThread>
+#include <QMutex>
+
+// C++
+#include <atomic>
+#include <filesystem>
+#include <vector>
+
+/** \class FileDiscovery
+ * \brief Searches a directory tree in the background, handing the files found in batches while the
+ *        search goes on, so the jobs can start before the search has finished. The finished signal of
+ *        the thread marks the end of the search.
+ *
+ */
+class FileDiscovery
+: public QThread
+{
+    Q_OBJECT
+  public:
+    /** \brief FileDiscovery class constructor.
+     * \param[in] root Root directory of the search.
+     * \param[in] filter Conditions of the files.
+     * \param[in] parent Raw pointer of the object parent of this one.
+     *
+     */
+    explicit FileDiscovery(const std::filesystem::path &root,
+                           const Utils::SearchFilter &filter = Utils::SearchFilter(),
+                           QObject *parent = nullptr);
+
+    /** \brief FileDiscovery class virtual destructor. Stops the search and waits for it.
+     *
+     */
+    virtual ~FileDiscovery();
+
+    /** \brief Stops the search.
+     *
+     */
+    void stop();
+
+    /** \brief Moves the files found since the last call to the given list. Returns true if there were any.
+     * \param[out] files list of files.
+     *
+     */
+    bool take(std::vector<std::filesystem::path> &files);
+
+    /** \brief Returns the number of files found.
+     *
+     */
+    int foundCount() const;
+
+  signals:
+    /** \brief Emitted when there are files waiting to be taken, once per batch.
+     *
+     */
+    void files_found() const;
+
+  protected:
+    virtual void run() override;
+
+  private:
+    const std::filesystem::path        m_root;   /** root directory of the search.        */
+    const Utils::SearchFilter          m_filter; /** conditions of the files.             */
+    QMutex                             m_mutex;  /** protects the files waiting.          */
+    std::vector<std::filesystem::path> m_found;  /** files found and not taken yet.       */
+    std::atomic<int>                   m_count;  /** number of files found.               */
+    std::atomic<bool>                  m_stop;   /** true if the search has been stopped. */
+};
+
+#endif // FILEDISCOVERY_H_
@@ -0,0 +1,309 @@
+/*
+ File: FolderWatcher.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <FolderWatcher.h>
+#include <Utils.h>
+
+// Qt
+#include <QDateTime>
+#include <QFileInfo>
+#include <QList>
+#include <QPair>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+// C++
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+// the removals and moves of the watched directories are reported to the directory itself.
+const uint32_t WATCH_MASK = IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB | IN_MOVE_SELF | IN_ONLYDIR;
+#endif
+
+//--------------------------------------------------------------------
+FolderWatcher::FolderWatcher(const std::filesystem::path &root, const int settle, QObject *parent)
+: QObject {parent}
+, m_root  {root}
+, m_settle{std::max(1, settle) * 1000LL}
+, m_fd    {-1}
+{
+  m_settle_timer.setInterval(s_check_interval);
+  m_rescan_timer.setInterval(s_rescan_interval);
+
+  connect(&m_settle_timer, SIGNAL(timeout()), this, SLOT(on_settle_timeout()));
+  connect(&m_rescan_timer, SIGNAL(timeout()), this, SLOT(on_rescan_timeout()));
+}
+
+//--------------------------------------------------------------------
+FolderWatcher::~FolderWatcher()
+{
+  m_notifier = nullptr;
+
+#ifdef Q_OS_LINUX
+  if(m_fd >= 0) close(m_fd);
+#endif
+}
+
+//--------------------------------------------------------------------
+void FolderWatcher::start()
+{
+  m_clock.start();
+
+  const auto root = QString::fromStdWString(m_root.wstring());
+
+#ifdef Q_OS_LINUX
+  m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+  if(m_fd >= 0)
+  {
+    m_notifier = std::make_unique<QSocketNotifier>(m_fd, QSocketNotifier::Read);
+    connect(m_notifier.get(), SIGNAL(activated(int)), this, SLOT(on_notification()));
+
+    emit information_message(tr("Watching '%1' for new video files.").arg(root));
+  }
+#endif
+
+  if(m_fd < 0)
+  {
+    start_polling(tr("File system notifications aren't available"));
+  }
+
+  // the only complete walk of the tree while the notifications work.
+  scan(m_root);
+
+  m_settle_timer.start();
+}
+
+//--------------------------------------------------------------------
+bool FolderWatcher::usesNotifications() const
+{
+  return m_fd >= 0 && !m_rescan_timer.isActive();
+}
+
+//--------------------------------------------------------------------
+void FolderWatcher::on_notification()
+{
+#ifdef Q_OS_LINUX
+  alignas(inotify_event) char buffer[16384];
+  bool overflow = false;
+
+  ssize_t length;
+  while((length = read(m_fd, buffer, sizeof(buffer))) > 0)
+  {
+    for(auto pointer = buffer; pointer < buffer + length;)
+    {
+      const auto event = reinterpret_cast<const inotify_event *>(pointer);
+      pointer += sizeof(inotify_event) + event->len;
+
+      if(event->mask & IN_Q_OVERFLOW)
+      {
+        overflow = true;
+        continue;
+      }
+
+      const auto it = m_watches.constFind(event->wd);
+      if(it == m_watches.cend()) continue;
+
+      // removed or moved directories, the moved ones are watched again in their new parent.
+      if(event->mask & (IN_IGNORED | IN_MOVE_SELF))
+      {
+        if(event->mask & IN_MOVE_SELF) inotify_rm_watch(m_fd, event->wd);
+        m_watches.remove(event->wd);
+        continue;
+      }
+
+      if(event->len == 0) continue;
+
+      const auto path = it.value() / event->name;
+
+      if(event->mask & IN_ISDIR)
+      {
+        // the files created before the watch are found by the scan.
+        if(event->mask & (IN_CREATE | IN_MOVED_TO)) scan(path);
+      }
+      else if(isWatchedFile(path))
+      {
+        consider(path);
+      }
+    }
+  }
+
+  if(overflow)
+  {
+    emit information_message(tr("Too many changes in '%1', scanning it again.").arg(QString::fromStdWString(m_root.wstring())));
+    scan(m_root);
+  }
+#endif
+}
+
+//--------------------------------------------------------------------
+void FolderWatcher::on_settle_timeout()
+{
+  const auto now = m_clock.elapsed();
+
+  QList<QPair<QString, bool>> ready;
+
+  for(auto it = m_candidates.begin(); it != m_candidates.end();)
+  {
+    auto &candidate = it.value();
+    if(now - candidate.since < m_settle)
+    {
+      ++it;
+      continue;
+    }
+
+    Stamp stamp;
+    if(!fileStamp(it.key(), stamp))
+    {
+      it = m_candidates.erase(it);
+      continue;
+    }
+
+    // still being written.
+    if(!(stamp == candidate.stamp))
+    {
+      candidate.stamp = stamp;
+      candidate.since = now;
+      ++it;
+      continue;
+    }
+
+    ready << qMakePair(it.key(), m_known.contains(it.key()));
+    m_known.insert(it.key(), stamp);
+    it = m_candidates.erase(it);
+  }
+
+  for(const auto &file: ready)
+  {
+    emit file_ready(file.first, file.second);
+  }
+}
+
+//--------------------------------------------------------------------
+void FolderWatcher::on_rescan_timeout()
+{
+  scan(m_root);
+}
+
+//--------------------------------------------------------------------
+void FolderWatcher::scan(const std::filesystem::path &directory)
+{
+  add_watch(directory);
+
+  const auto options = std::filesystem::directory_options::skip_permission_denied;
+
+  std::error_code error;
+  std::filesystem::recursive_directory_iterator it(directory, options, error), end;
+
+  for(; !error && it != end; it.increment(error))
+  {
+    // the type comes from the directory listing, without a stat of each entry.
+    std::error_code status;
+    if(it->is_directory(status))
+    {
+      add_watch(it->path());
+    }
+    else if(isWatchedFile(it->path()))
+    {
+      consider(it->path());
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+void FolderWatcher::add_watch(const std::filesystem::path &directory)
+{
+#ifdef Q_OS_LINUX
+  if(m_fd < 0 || m_rescan_timer.isActive()) return;
+
+  const auto wd = inotify_add_watch(m_fd, directory.c_str(), WATCH_MASK);
+
+  if(wd >= 0)
+  {
+    m_watches.insert(wd, directory);
+  }
+  else if(errno == ENOSPC)
+  {
+    start_polling(tr("The limit of watched directories has been reached"));
+  }
+#endif
+}
+
+//--------------------------------------------------------------------
+void FolderWatcher::consider(const std::filesystem::path &file)
+{
+  const auto path = QString::fromStdWString(file.wstring());
+
+  Stamp stamp;
+  if(!fileStamp(path, stamp)) return;
+
+  // unchanged since reported.
+  const auto known = m_known.constFind(path);
+  if(known != m_known.cend() && known.value() == stamp) return;
+
+  // waiting candidates only restart the wait if they have changed.
+  const auto it = m_candidates.find(path);
+  if(it != m_candidates.end())
+  {
+    if(!(it.value().stamp == stamp)) it.value() = Candidate{stamp, m_clock.elapsed()};
+    return;
+  }
+
+  m_candidates.insert(path, Candidate{stamp, m_clock.elapsed()});
+}
+
+//--------------------------------------------------------------------
+void FolderWatcher::start_polling(const QString &reason)
+{
+  if(m_rescan_timer.isActive()) return;
+
+  emit information_message(tr("%1, scanning '%2' every %3 seconds.").arg(reason)
+                                                                    .arg(QString::fromStdWString(m_root.wstring()))
+                                                                    .arg(s_rescan_interval / 1000));
+
+  m_rescan_timer.start();
+}
+
+//--------------------------------------------------------------------
+bool FolderWatcher::fileStamp(const QString &file, Stamp &stamp)
+{
+  const QFileInfo info(file);
+  if(!info.isFile()) return false;
+
+  stamp.size     = info.size();
+  stamp.modified = info.lastModified().toMSecsSinceEpoch();
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+bool FolderWatcher::isWatchedFile(const std::filesystem::path &file)
+{
+  auto lower = [](std::wstring text) { for(auto &c: text) c = std::tolower(c); return text; };
+
+  const auto extension = lower(file.extension().wstring());
+  if(std::find(Utils::MOVIE_FILE_EXTENSIONS.cbegin(), Utils::MOVIE_FILE_EXTENSIONS.cend(), extension) == Utils::MOVIE_FILE_EXTENSIONS.cend()) return false;
+
+  return !Utils::isOutputFile(file);
+}
@@ -0,0 +1,182 @@
+/*
+ File: FolderWatcher.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FOLDERWATCHER_H_
+#define FOLDERWATCHER_H_
+
+// Qt
+#include <QObject>
+#include <QHash>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// C++
+#include <filesystem>
+#include <memory>
+
+/** \class FolderWatcher
+ * \brief Watches a directory tree for new or changed video files. On Linux the directories are watched
+ *        with inotify and only the new subdirectories are scanned, the whole tree is scanned again only
+ *        if the kernel drops events. Elsewhere, or when the watch limit is reached, the tree is rescanned
+ *        periodically. A file is reported once its size and modification time haven't changed for the
+ *        settle time, and again only if it changes. The outputs of the transcoder are ignored.
+ *
+ */
+class FolderWatcher
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /** \brief FolderWatcher class constructor.
+     * \param[in] root Root directory of the watched tree.
+     * \param[in] settle Seconds without changes before reporting a file.
+     * \param[in] parent Raw pointer of the object parent of this one.
+     *
+     */
+    explicit FolderWatcher(const std::filesystem::path &root, const int settle, QObject *parent = nullptr);
+
+    /** \brief FolderWatcher class virtual destructor.
+     *
+     */
+    virtual ~FolderWatcher();
+
+    /** \brief Starts watching the tree, the files already in it are reported once settled.
+     *
+     */
+    void start();
+
+    /** \brief Returns true if the tree is watched with notifications and false if it's rescanned periodically.
+     *
+     */
+    bool usesNotifications() const;
+
+  signals:
+    /** \brief Emitted when a new or changed video file has settled.
+     * \param[in] file file path.
+     * \param[in] changed true if the file had already been reported and has changed since.
+     *
+     */
+    void file_ready(const QString &file, bool changed);
+
+    /** \brief Emits an error message.
+     * \param[in] message error message.
+     *
+     */
+    void error_message(const QString &message);
+
+    /** \brief Emits an information message.
+     * \param[in] message information message.
+     *
+     */
+    void information_message(const QString &message);
+
+  private slots:
+    /** \brief Reads the pending notifications.
+     *
+     */
+    void on_notification();
+
+    /** \brief Reports the candidates that have settled.
+     *
+     */
+    void on_settle_timeout();
+
+    /** \brief Rescans the whole tree when notifications aren't available.
+     *
+     */
+    void on_rescan_timeout();
+
+  private:
+    /** \struct Stamp
+     * \brief Size and modification time of a file.
+     *
+     */
+    struct Stamp
+    {
+      qint64 size;     /** size of the file in bytes.           */
+      qint64 modified; /** modification time in ms since epoch. */
+
+      bool operator==(const Stamp &other) const
+      { return size == other.size && modified == other.modified; }
+    };
+
+    /** \struct Candidate
+     * \brief File waiting to settle.
+     *
+     */
+    struct Candidate
+    {
+      Stamp  stamp; /** last seen stamp of the file.                */
+      qint64 since; /** clock time of the last change of the stamp. */
+    };
+
+    /** \brief Watches the given directory and its subdirectories and considers their video files.
+     * \param[in] directory directory path.
+     *
+     */
+    void scan(const std::filesystem::path &directory);
+
+    /** \brief Adds a notification watch for the given directory.
+     * \param[in] directory directory path.
+     *
+     */
+    void add_watch(const std::filesystem::path &directory);
+
+    /** \brief Makes the given file a candidate unless it hasn't changed since it was reported.
+     * \param[in] file file path.
+     *
+     */
+    void consider(const std::filesystem::path &file);
+
+    /** \brief Switches to periodic rescans of the tree.
+     * \param[in] reason reason of the switch.
+     *
+     */
+    void start_polling(const QString &reason);
+
+    /** \brief Gets the stamp of a regular file. Returns true on success and false otherwise.
+     * \param[in] file file path.
+     * \param[out] stamp file stamp.
+     *
+     */
+    static bool fileStamp(const QString &file, Stamp &stamp);
+
+    /** \brief Returns true if the file has a video extension and isn't an output of the transcoder.
+     * \param[in] file file path.
+     *
+     */
+    static bool isWatchedFile(const std::filesystem::path &file);
+
+    static const int s_check_interval  = 1000;  /** interval between settle checks in ms. */
+    static const int s_rescan_interval = 60000; /** interval between rescans in ms.       */
+
+    const std::filesystem::path       m_root;         /** root directory of the tree.               */
+    const qint64                      m_settle;       /** time without changes in ms.               */
+    int                               m_fd;           /** inotify descriptor, -1 if not used.       */
+    std::unique_ptr<QSocketNotifier>  m_notifier;     /** notifications of the descriptor.          */
+    QHash<int, std::filesystem::path> m_watches;      /** maps watch descriptor<->directory.        */
+    QHash<QString, Candidate>         m_candidates;   /** files waiting to settle.                  */
+    QHash<QString, Stamp>             m_known;        /** stamps of the reported files.             */
+    QTimer                            m_settle_timer; /** settle check timer.                       */
+    QTimer                            m_rescan_timer; /** rescan timer, only without notifications. */
+    QElapsedTimer                     m_clock;        /** time since the start.                     */
+};
+
+#endif // FOLDERWATCHER_H_
@@ -0,0 +1,74 @@
+/*
+ File: InputReader.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <InputReader.h>
+
+// libav
+extern "C"
+{
+#include <libavformat/avio.h>
+#include <libavutil/error.h>
+}
+
+// C++
+#include <cstdio>
+
+//-----------------------------------------------------------------
+int InputReader::read_callback(void *opaque, uint8_t *buffer, int buffer_size)
+{
+  auto reader = reinterpret_cast<InputReader *>(opaque);
+  return reader->read(buffer, buffer_size);
+}
+
+//-----------------------------------------------------------------
+int64_t InputReader::seek_callback(void *opaque, int64_t offset, int whence)
+{
+  auto reader = reinterpret_cast<InputReader *>(opaque);
+
+  whence &= ~AVSEEK_FORCE;
+
+  if(whence == AVSEEK_SIZE) return reader->size();
+
+  return reader->seek(offset, whence);
+}
+
+//-----------------------------------------------------------------
+long long InputReader::seek_target(long long offset, int whence, long long position, long long size)
+{
+  long long target;
+
+  switch(whence)
+  {
+    case SEEK_SET:
+      target = offset;
+      break;
+    case SEEK_CUR:
+      target = position + offset;
+      break;
+    case SEEK_END:
+      target = size + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  // seeking past the end is allowed, the next read returns EOF.
+  return target < 0 ? -1 : target;
+}
@@ -0,0 +1,115 @@
+/*
+ File: InputReader.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INPUTREADER_H_
+#define INPUTREADER_H_
+
+// Qt
+#include <QString>
+
+// C++
+#include <cstdint>
+
+/** \class InputReader
+ * \brief Interface of the readers that feed the input data to libav through a custom AVIOContext.
+ *
+ */
+class InputReader
+{
+  public:
+    /** \brief InputReader class virtual destructor.
+     *
+     */
+    virtual ~InputReader()
+    {}
+
+    /** \brief Opens the input. Returns true on success and false otherwise.
+     *
+     */
+    virtual bool open() = 0;
+
+    /** \brief Closes the input.
+     *
+     */
+    virtual void close() = 0;
+
+    /** \brief Copies up to size bytes of input at the current position to the buffer. Returns the
+     *         number of bytes copied, AVERROR_EOF at the end of the input or a negative libav error code.
+     * \param[in] buffer buffer to fill.
+     * \param[in] size buffer size.
+     *
+     */
+    virtual int read(unsigned char *buffer, int size) = 0;
+
+    /** \brief Moves the current position. Returns the new position or a negative libav error code.
+     * \param[in] offset seek value.
+     * \param[in] whence SEEK_SET, SEEK_CUR or SEEK_END.
+     *
+     */
+    virtual long long seek(long long offset, int whence) = 0;
+
+    /** \brief Returns the size of the input in bytes.
+     *
+     */
+    virtual long long size() const = 0;
+
+    /** \brief Returns the current position in the input.
+     *
+     */
+    virtual long long pos() const = 0;
+
+    /** \brief Returns a description of the last error.
+     *
+     */
+    virtual QString errorString() const = 0;
+
+    /** \brief Returns a description of the reader statistics or an empty string if there are none.
+     *
+     */
+    virtual QString statistics() const
+    { return QString(); }
+
+    /** \brief AVIOContext read callback, the opaque pointer is the reader.
+     * \param[in] opaque pointer to the reader.
+     * \param[in] buffer buffer to fill
+     * \param[in] buffer_size buffer size.
+     *
+     */
+    static int read_callback(void *opaque, uint8_t *buffer, int buffer_size);
+
+    /** \brief AVIOContext seek callback, the opaque pointer is the reader.
+     * \param[in] opaque pointer to the reader.
+     * \param[in] offset seek value.
+     * \param[in] whence seek direction or AVSEEK_SIZE.
+     *
+     */
+    static int64_t seek_callback(void *opaque, int64_t offset, int whence);
+
+  protected:
+    /** \brief Helper method that returns the absolute position of a seek or -1 if it's out of bounds.
+     * \param[in] offset seek value.
+     * \param[in] whence SEEK_SET, SEEK_CUR or SEEK_END.
+     * \param[in] position current position.
+     * \param[in] size size of the input.
+     *
+     */
+    static long long seek_target(long long offset, int whence, long long position, long long size);
+};
+
+#endif // INPUTREADER_H_
@@ -0,0 +1,323 @@
+/*
+ File: JobJournal.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <JobJournal.h>
+#include <Utils.h>
+
+// Qt
+#include <QDateTime>
+#include <QDir>
+#include <QMutexLocker>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// C++
+#include <algorithm>
+
+//--------------------------------------------------------------------
+JobJournal::JobJournal(const QString &instance)
+: m_filename{journalFilename(instance)}
+{
+}
+
+//--------------------------------------------------------------------
+JobJournal::~JobJournal()
+{
+  if(m_file.isOpen()) m_file.close();
+}
+
+//--------------------------------------------------------------------
+bool JobJournal::open()
+{
+  QMutexLocker lock(&m_mutex);
+
+  m_entries.clear();
+  if(m_file.isOpen()) m_file.close();
+
+  const auto &filename = m_filename;
+  QDir().mkpath(QFileInfo(filename).absolutePath());
+
+  QFile file(filename);
+  if(file.exists())
+  {
+    if(!file.open(QIODevice::ReadOnly)) return false;
+
+    auto lines = file.readAll().split('\n');
+    file.close();
+
+    // the last line is empty or was being written when the application stopped.
+    lines.removeLast();
+
+    for(const auto &data: lines)
+    {
+      const auto fields = QString::fromUtf8(data).split('\t');
+      if(fields.size() < 5 || fields.first().size() != 1) continue;
+
+      const auto state = static_cast<State>(fields.first().at(0).toLatin1());
+      const auto key   = unescape(fields.at(1));
+
+      auto &entry = m_entries[key];
+      if(state == State::RUNNING && entry.state != State::RUNNING) entry.outputs.clear();
+
+      entry.state    = state;
+      entry.size     = fields.at(2).toLongLong();
+      entry.modified = fields.at(3).toLongLong();
+      entry.reason   = unescape(fields.at(4));
+      for(int i = 5; i < fields.size(); ++i)
+      {
+        const auto output = unescape(fields.at(i));
+        if(!entry.outputs.contains(output)) entry.outputs << output;
+      }
+    }
+  }
+
+  // compact to the last state of the files that still exist.
+  QSaveFile compacted(filename);
+  if(!compacted.open(QIODevice::WriteOnly)) return false;
+
+  for(auto it = m_entries.begin(); it != m_entries.end();)
+  {
+    if(!QFileInfo::exists(it.key()))
+    {
+      it = m_entries.erase(it);
+      continue;
+    }
+
+    compacted.write(line(it.key(), it.value()));
+    ++it;
+  }
+
+  if(!compacted.commit()) return false;
+
+  m_file.setFileName(filename);
+  return m_file.open(QIODevice::WriteOnly|QIODevice::Append);
+}
+
+//--------------------------------------------------------------------
+int JobJournal::resume(std::vector<std::filesystem::path> &files, QStringList &cleaned, std::vector<std::filesystem::path> &replaced) const
+{
+  QMutexLocker lock(&m_mutex);
+
+  if(m_entries.isEmpty()) return 0;
+
+  auto isCurrent = [](const std::filesystem::path &file, const Entry &entry)
+  {
+    qint64 size, modified;
+    if(!fileStamp(file, size, modified) || size != entry.size || modified != entry.modified) return false;
+
+    return std::all_of(entry.outputs.cbegin(), entry.outputs.cend(), [](const QString &output) { return QFileInfo::exists(output); });
+  };
+
+  auto isFinished = [this, &cleaned, &replaced, &isCurrent](const std::filesystem::path &file)
+  {
+    const auto it = m_entries.constFind(key(file));
+    if(it == m_entries.cend()) return false;
+
+    const auto &entry = it.value();
+    switch(entry.state)
+    {
+      case State::DONE:
+        // transcoded again if the source has changed or the user has removed the outputs, the previous
+        // outputs are kept until the new ones are complete.
+        if(isCurrent(file, entry)) return true;
+        replaced.push_back(file);
+        break;
+      case State::RUNNING:
+      case State::FAILED:
+        for(const auto &output: entry.outputs)
+        {
+          if(QFile::exists(output) && QFile::remove(output)) cleaned << output;
+        }
+        break;
+      default:
+        break;
+    }
+
+    return false;
+  };
+
+  const auto end = std::remove_if(files.begin(), files.end(), isFinished);
+  const auto removed = static_cast<int>(std::distance(end, files.end()));
+  files.erase(end, files.end());
+
+  return removed;
+}
+
+//--------------------------------------------------------------------
+bool JobJournal::record(const std::filesystem::path &file, const State state, const QString &reason)
+{
+  QMutexLocker lock(&m_mutex);
+
+  const auto fileKey = key(file);
+
+  auto &entry = m_entries[fileKey];
+  if(state == State::QUEUED || state == State::RUNNING) entry.outputs.clear();
+
+  entry.state  = state;
+  entry.reason = reason;
+  entry.size   = entry.modified = 0;
+
+  if(state == State::DONE) fileStamp(file, entry.size, entry.modified);
+
+  // a finished file must not be taken for an interrupted one, its outputs would be removed.
+  return append(line(fileKey, entry), state == State::DONE);
+}
+
+//--------------------------------------------------------------------
+bool JobJournal::recordQueued(const std::vector<std::filesystem::path> &files)
+{
+  QMutexLocker lock(&m_mutex);
+
+  QByteArray data;
+
+  for(const auto &file: files)
+  {
+    const auto fileKey = key(file);
+
+    auto &entry = m_entries[fileKey];
+    entry.state = State::QUEUED;
+    entry.size  = entry.modified = 0;
+    entry.outputs.clear();
+    entry.reason.clear();
+
+    data += line(fileKey, entry);
+  }
+
+  return data.isEmpty() || append(data, false);
+}
+
+//--------------------------------------------------------------------
+bool JobJournal::recordOutputs(const std::filesystem::path &file, const QStringList &outputs)
+{
+  QMutexLocker lock(&m_mutex);
+
+  const auto fileKey = key(file);
+
+  auto &entry = m_entries[fileKey];
+  for(const auto &output: outputs)
+  {
+    if(!entry.outputs.contains(output)) entry.outputs << output;
+  }
+
+  // the outputs must be known before they are written to remove them if interrupted.
+  Entry added{State::RUNNING, 0, 0, outputs, QString()};
+  return append(line(fileKey, added), true);
+}
+
+//--------------------------------------------------------------------
+JobJournal::State JobJournal::state(const std::filesystem::path &file) const
+{
+  QMutexLocker lock(&m_mutex);
+
+  const auto it = m_entries.constFind(key(file));
+
+  return (it == m_entries.cend()) ? State::NONE : it.value().state;
+}
+
+//--------------------------------------------------------------------
+QString JobJournal::journalFilename(const QString &instance)
+{
+  return Utils::stateFilename("journal", instance);
+}
+
+//--------------------------------------------------------------------
+QString JobJournal::key(const std::filesystem::path &file)
+{
+  return QString::fromStdWString(std::filesystem::absolute(file).lexically_normal().wstring());
+}
+
+//--------------------------------------------------------------------
+QByteArray JobJournal::line(const QString &key, const Entry &entry)
+{
+  QStringList fields;
+  fields << QString(QChar::fromLatin1(static_cast<char>(entry.state))) << escape(key)
+         << QString::number(entry.size) << QString::number(entry.modified) << escape(entry.reason);
+  for(const auto &output: entry.outputs) fields << escape(output);
+
+  return fields.join('\t').toUtf8() + '\n';
+}
+
+//--------------------------------------------------------------------
+QString JobJournal::escape(const QString &text)
+{
+  auto result = text;
+  result.replace('\\', "\\\\").replace('\t', "\\t").replace('\n', "\\n");
+
+  return result;
+}
+
+//--------------------------------------------------------------------
+QString JobJournal::unescape(const QString &text)
+{
+  QString result;
+  result.reserve(text.size());
+
+  for(int i = 0; i < text.size(); ++i)
+  {
+    if(text.at(i) == '\\' && i + 1 < text.size())
+    {
+      const auto next = text.at(++i);
+      result += (next == 't') ? QChar('\t') : (next == 'n') ? QChar('\n') : next;
+    }
+    else
+    {
+      result += text.at(i);
+    }
+  }
+
+  return result;
+}
+
+//--------------------------------------------------------------------
+bool JobJournal::fileStamp(const std::filesystem::path &file, qint64 &size, qint64 &modified)
+{
+  const QFileInfo info(QString::fromStdWString(file.wstring()));
+  if(!info.exists()) return false;
+
+  size     = info.size();
+  modified = info.lastModified().toMSecsSinceEpoch();
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+bool JobJournal::append(const QByteArray &data, const bool sync)
+{
+  if(!m_file.isOpen()) return false;
+
+  if(m_file.write(data) != data.size() || !m_file.flush()) return false;
+
+  if(sync)
+  {
+#ifdef Q_OS_WIN
+    return _commit(m_file.handle()) == 0;
+#else
+    return fsync(m_file.handle()) == 0;
+#endif
+  }
+
+  return true;
+}
@@ -0,0 +1,170 @@
+/*
+ File: JobJournal.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOBJOURNAL_H_
+#define JOBJOURNAL_H_
+
+// Qt
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+// C++
+#include <filesystem>
+#include <vector>
+
+/** \class JobJournal
+ * \brief Append-only journal of the states of the jobs of a batch, stored next to the application settings.
+ *        Each change is a line appended to the file, so a batch interrupted by a crash, a reboot or closing
+ *        the application can be resumed: finished files are skipped and the partial outputs of the
+ *        interrupted ones are removed before transcoding them again. The size and modification time of
+ *        the finished files are stored to transcode them again if they change. The journal is compacted
+ *        to the last state of each file when opened. Thread safe.
+ *
+ */
+class JobJournal
+{
+  public:
+    enum class State: char { NONE = '-', QUEUED = 'Q', RUNNING = 'R', DONE = 'D', FAILED = 'F' }; /** state of a job. */
+
+    /** \brief JobJournal class constructor.
+     * \param[in] instance Name of the instance using the journal, empty for the default one.
+     *
+     */
+    explicit JobJournal(const QString &instance = QString());
+
+    /** \brief JobJournal class destructor. Closes the journal.
+     *
+     */
+    ~JobJournal();
+
+    /** \brief Loads the journal from disk, compacts it and opens it for appending. Returns true on success
+     *         and false otherwise.
+     *
+     */
+    bool open();
+
+    /** \brief Removes from the list the files finished in a previous run that haven't changed and whose
+     *         outputs still exist, and removes the partial outputs of the files that were interrupted or
+     *         failed. The finished files that have changed, or lost some outputs, must replace their
+     *         previous outputs. Returns the number of files removed from the list.
+     * \param[inout] files list of files.
+     * \param[out] cleaned output files removed.
+     * \param[out] replaced files whose previous outputs must be replaced.
+     *
+     */
+    int resume(std::vector<std::filesystem::path> &files, QStringList &cleaned, std::vector<std::filesystem::path> &replaced) const;
+
+    /** \brief Appends the state of a job to the journal. Returns true on success and false otherwise.
+     * \param[in] file source file path.
+     * \param[in] state new state of the job.
+     * \param[in] reason reason of the failure, only for the FAILED state.
+     *
+     */
+    bool record(const std::filesystem::path &file, const State state, const QString &reason = QString());
+
+    /** \brief Appends the QUEUED state of several jobs to the journal. Returns true on success and false otherwise.
+     * \param[in] files source file paths.
+     *
+     */
+    bool recordQueued(const std::vector<std::filesystem::path> &files);
+
+    /** \brief Stores the output files of a running job, removed if the job is interrupted. Returns true on
+     *         success and false otherwise.
+     * \param[in] file source file path.
+     * \param[in] outputs output files of the job.
+     *
+     */
+    bool recordOutputs(const std::filesystem::path &file, const QStringList &outputs);
+
+    /** \brief Returns the last state of a job.
+     * \param[in] file source file path.
+     *
+     */
+    State state(const std::filesystem::path &file) const;
+
+    /** \brief Returns the path of the journal file.
+     * \param[in] instance name of the instance using the journal, empty for the default one.
+     *
+     */
+    static QString journalFilename(const QString &instance = QString());
+
+  private:
+    /** \struct Entry
+     * \brief Last state of a job.
+     *
+     */
+    struct Entry
+    {
+      State       state    = State::NONE; /** last state.                            */
+      qint64      size     = 0;           /** size of the source when finished.      */
+      qint64      modified = 0;           /** modification time of the source in ms. */
+      QStringList outputs;                /** output files of the job.               */
+      QString     reason;                 /** reason of the failure if any.          */
+    };
+
+    /** \brief Returns the key of a file in the journal.
+     * \param[in] file file path.
+     *
+     */
+    static QString key(const std::filesystem::path &file);
+
+    /** \brief Returns the journal line of a job.
+     * \param[in] key key of the job.
+     * \param[in] entry job data.
+     *
+     */
+    static QByteArray line(const QString &key, const Entry &entry);
+
+    /** \brief Escapes the separators of a journal field.
+     * \param[in] text field text.
+     *
+     */
+    static QString escape(const QString &text);
+
+    /** \brief Restores a field escaped with escape().
+     * \param[in] text escaped field text.
+     *
+     */
+    static QString unescape(const QString &text);
+
+    /** \brief Gets the size and modification time of a file. Returns true on success and false otherwise.
+     * \param[in] file file path.
+     * \param[out] size file size in bytes.
+     * \param[out] modified modification time in ms since epoch.
+     *
+     */
+    static bool fileStamp(const std::filesystem::path &file, qint64 &size, qint64 &modified);
+
+    /** \brief Appends the lines to the journal. Returns true on success and false otherwise.
+     * \param[in] data journal lines.
+     * \param[in] sync true to wait until the data is on disk.
+     *
+     */
+    bool append(const QByteArray &data, const bool sync);
+
+    const QString         m_filename; /** path of the journal file.                  */
+    QHash<QString, Entry> m_entries;  /** last state of the jobs keyed by file path. */
+    QFile                 m_file;     /** journal file opened for appending.         */
+    mutable QMutex        m_mutex;    /** protects the journal data.                 */
+};
+
+#endif // JOBJOURNAL_H_
@@ -0,0 +1,108 @@
+/*
+ File: JobQueue.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <JobQueue.h>
+
+// C++
+#include <algorithm>
+#include <system_error>
+
+//--------------------------------------------------------------------
+JobQueue::JobQueue(const JobOrder order)
+: m_order{order}
+{
+}
+
+//--------------------------------------------------------------------
+void JobQueue::push(const std::filesystem::path &file)
+{
+  Job job{file, m_order == JobOrder::FIFO ? 0 : estimatedCost(file)};
+
+  // inserted after the jobs with the same cost, so those keep the insertion order.
+  auto compare = [this](const Job &a, const Job &b) { return before(a, b); };
+  const auto position = std::upper_bound(m_jobs.begin(), m_jobs.end(), job, compare);
+
+  m_jobs.insert(position, job);
+}
+
+//--------------------------------------------------------------------
+void JobQueue::push(const std::vector<std::filesystem::path> &files)
+{
+  auto compare = [this](const Job &a, const Job &b) { return before(a, b); };
+
+  std::vector<Job> jobs;
+  jobs.reserve(files.size());
+  for(const auto &file: files) jobs.push_back(Job{file, m_order == JobOrder::FIFO ? 0 : estimatedCost(file)});
+
+  std::stable_sort(jobs.begin(), jobs.end(), compare);
+
+  // the merge is stable, the new jobs go after the queued ones with the same cost.
+  const auto queued = m_jobs.size();
+  m_jobs.insert(m_jobs.end(), jobs.cbegin(), jobs.cend());
+  std::inplace_merge(m_jobs.begin(), m_jobs.begin() + queued, m_jobs.end(), compare);
+}
+
+//--------------------------------------------------------------------
+bool JobQueue::pop(std::filesystem::path &file)
+{
+  if(m_jobs.empty()) return false;
+
+  file = m_jobs.front().file;
+  m_jobs.pop_front();
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+bool JobQueue::empty() const
+{
+  return m_jobs.empty();
+}
+
+//--------------------------------------------------------------------
+size_t JobQueue::size() const
+{
+  return m_jobs.size();
+}
+
+//--------------------------------------------------------------------
+long long JobQueue::estimatedCost(const std::filesystem::path &file)
+{
+  std::error_code error;
+  const auto size = std::filesystem::file_size(file, error);
+
+  return error ? 0 : static_cast<long long>(size);
+}
+
+//--------------------------------------------------------------------
+bool JobQueue::before(const Job &a, const Job &b) const
+{
+  switch(m_order)
+  {
+    case JobOrder::LARGEST_FIRST:
+      return a.cost > b.cost;
+    case JobOrder::SHORTEST_FIRST:
+      return a.cost < b.cost;
+    default:
+      break;
+  }
+
+  return false;
+}
@@ -0,0 +1,106 @@
+/*
+ File: JobQueue.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOBQUEUE_H_
+#define JOBQUEUE_H_
+
+// Project
+#include <Utils.h>
+
+// C++
+#include <deque>
+#include <filesystem>
+#include <vector>
+
+/** \class JobQueue
+ * \brief Files waiting to be processed, ordered by their estimated cost according to the configured
+ *        job order. Starting the most expensive files first keeps all the workers busy until the end
+ *        of the batch instead of leaving a long job for the last one.
+ *
+ */
+class JobQueue
+{
+  public:
+    using JobOrder = Utils::TranscoderConfiguration::JobOrder;
+
+    /** \brief JobQueue class constructor.
+     * \param[in] order order of the jobs.
+     *
+     */
+    explicit JobQueue(const JobOrder order);
+
+    /** \brief Adds a file to the queue in the position given by its cost.
+     * \param[in] file file path.
+     *
+     */
+    void push(const std::filesystem::path &file);
+
+    /** \brief Adds several files to the queue, in the positions given by their costs. The files are
+     *         sorted and merged with the queue instead of being inserted one by one.
+     * \param[in] files file paths.
+     *
+     */
+    void push(const std::vector<std::filesystem::path> &files);
+
+    /** \brief Removes the next file of the queue. Returns true on success and false if the queue is empty.
+     * \param[out] file file path.
+     *
+     */
+    bool pop(std::filesystem::path &file);
+
+    /** \brief Returns true if the queue is empty and false otherwise.
+     *
+     */
+    bool empty() const;
+
+    /** \brief Returns the number of files in the queue.
+     *
+     */
+    size_t size() const;
+
+    /** \brief Returns the estimated cost of processing the file, currently its size in bytes as it grows
+     *         with the duration, resolution and bitrate of the streams.
+     * \param[in] file file path.
+     *
+     */
+    static long long estimatedCost(const std::filesystem::path &file);
+
+  private:
+    /** \struct Job
+     * \brief File and its estimated cost.
+     *
+     */
+    struct Job
+    {
+      std::filesystem::path file; /** file path.      */
+      long long             cost; /** estimated cost. */
+    };
+
+    /** \brief Returns true if the job a goes before the job b in the queue.
+     * \param[in] a job.
+     * \param[in] b job.
+     *
+     */
+    bool before(const Job &a, const Job &b) const;
+
+    const JobOrder   m_order; /** order of the jobs.      */
+    std::deque<Job>  m_jobs;  /** jobs in execution order. */
+};
+
+#endif // JOBQUEUE_H_
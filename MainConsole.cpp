@@ -0,0 +1,679 @@
+/*
+ File: MainConsole.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Utils.h>
+#include <Scheduler.h>
+#include <ConsoleReporter.h>
+#include <Coordinator.h>
+#include <Agent.h>
+#include <FolderWatcher.h>
+
+// Qt
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QHostInfo>
+#include <QTextStream>
+#include <QTimer>
+
+// C++
+#include <algorithm>
+#include <iostream>
+#include <csignal>
+#include <memory>
+#include <thread>
+
+using Configuration = Utils::TranscoderConfiguration;
+
+static volatile std::sig_atomic_t s_interrupted = 0; /** set to 1 by the signal handler. */
+
+//-----------------------------------------------------------------
+void signalHandler(int)
+{
+  s_interrupted = 1;
+}
+
+//-----------------------------------------------------------------
+void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+  const char symbols[] = { 'I', 'E', '!', 'X' };
+  auto output = QString("[%1] %2 (%3:%4 -> %5)").arg(symbols[type]).arg(msg).arg(context.file).arg(context.line).arg(context.function);
+  std::cerr << output.toStdString() << std::endl;
+  if (type == QtFatalMsg) abort();
+}
+
+//-----------------------------------------------------------------
+bool parseBoolean(const QString &value, bool &result)
+{
+  const auto lower = value.toLower();
+  if(lower == "yes" || lower == "true"  || lower == "on"  || lower == "1") { result = true;  return true; }
+  if(lower == "no"  || lower == "false" || lower == "off" || lower == "0") { result = false; return true; }
+
+  return false;
+}
+
+//-----------------------------------------------------------------
+bool parseInteger(const QString &value, int &result)
+{
+  bool ok = false;
+  result = value.toInt(&ok);
+
+  return ok && result >= 0;
+}
+
+//-----------------------------------------------------------------
+bool parsePort(const QString &value, quint16 &port)
+{
+  int number;
+  if(!parseInteger(value, number) || number == 0 || number > 65535) return false;
+
+  port = static_cast<quint16>(number);
+  return true;
+}
+
+//-----------------------------------------------------------------
+bool parseLanguage(const QString &value, Configuration::Language &language)
+{
+  const auto lower = value.toLower();
+  if(lower == "default")                  { language = Configuration::Language::DEFAULT; return true; }
+  if(lower == "english" || lower == "eng") { language = Configuration::Language::ENGLISH; return true; }
+  if(lower == "spanish" || lower == "spa") { language = Configuration::Language::SPANISH; return true; }
+
+  return false;
+}
+
+//-----------------------------------------------------------------
+bool applyOverrides(const QCommandLineParser &parser, Configuration &config, QString &error)
+{
+  int value;
+  bool flag;
+
+  auto integerOption = [&](const QString &name, void (Configuration::*setter)(int))
+  {
+    if(!parser.isSet(name)) return true;
+    if(!parseInteger(parser.value(name), value))
+    {
+      error = QString("Invalid value '%1' for option --%2.").arg(parser.value(name)).arg(name);
+      return false;
+    }
+    (config.*setter)(value);
+    return true;
+  };
+
+  auto booleanOption = [&](const QString &name, void (Configuration::*setter)(const bool))
+  {
+    if(!parser.isSet(name)) return true;
+    if(!parseBoolean(parser.value(name), flag))
+    {
+      error = QString("Invalid value '%1' for option --%2.").arg(parser.value(name)).arg(name);
+      return false;
+    }
+    (config.*setter)(flag);
+    return true;
+  };
+
+  if(!integerOption("threads",        &Configuration::setNumberOfThreads))       return false;
+  if(!integerOption("video-bitrate",  &Configuration::setVideoBitrate))          return false;
+  if(!integerOption("audio-bitrate",  &Configuration::setAudioBitrate))          return false;
+  if(!integerOption("audio-channels", &Configuration::setAudioNumberOfChannels)) return false;
+  if(!integerOption("audio-queue",    &Configuration::setAudioQueueSize))        return false;
+  if(!integerOption("video-queue",    &Configuration::setVideoQueueSize))        return false;
+  if(!integerOption("muxer-queue",    &Configuration::setMuxerQueueSize))        return false;
+  if(!integerOption("chunks",         &Configuration::setNumberOfChunks))        return false;
+  if(!integerOption("block-size",     &Configuration::setInputBlockSize))        return false;
+  if(!integerOption("prefetch-depth", &Configuration::setPrefetchDepth))         return false;
+  if(!integerOption("output-buffer",  &Configuration::setOutputBufferSize))      return false;
+  if(!integerOption("output-buffers", &Configuration::setOutputBuffers))         return false;
+  if(!integerOption("thread-budget",  &Configuration::setThreadBudget))          return false;
+  if(!integerOption("checkpoints",    &Configuration::setCheckpointInterval))    return false;
+  if(!integerOption("fps-limit",      &Configuration::setFrameRateLimit))        return false;
+  if(!integerOption("read-limit",     &Configuration::setReadRateLimit))         return false;
+  if(!integerOption("memory-budget",  &Configuration::setMemoryBudget))          return false;
+  if(!booleanOption("subtitles",      &Configuration::setExtractSubtitles))      return false;
+  if(!booleanOption("chunked",        &Configuration::setChunkedEncoding))       return false;
+  if(!booleanOption("prefetch",       &Configuration::setPrefetchInput))         return false;
+  if(!booleanOption("sync-output",    &Configuration::setSyncOutput))            return false;
+  if(!booleanOption("index",          &Configuration::setUseProbeIndex))         return false;
+  if(!booleanOption("all-languages",  &Configuration::setAllLanguages))          return false;
+  if(!booleanOption("numa",           &Configuration::setNumaPlacement))         return false;
+  if(!booleanOption("journal",        &Configuration::setUseJobJournal))         return false;
+
+  if(parser.isSet("priority"))
+  {
+    const auto priority = parser.value("priority").toLower();
+    if     (priority == "normal") config.setExecutionClass(Configuration::ExecutionClass::NORMAL);
+    else if(priority == "batch")  config.setExecutionClass(Configuration::ExecutionClass::BATCH);
+    else if(priority == "idle")   config.setExecutionClass(Configuration::ExecutionClass::IDLE);
+    else
+    {
+      error = QString("Unknown execution class '%1'.").arg(priority);
+      return false;
+    }
+  }
+
+  if(parser.isSet("order"))
+  {
+    const auto order = parser.value("order").toLower();
+    if     (order == "fifo")     config.setJobOrder(Configuration::JobOrder::FIFO);
+    else if(order == "largest")  config.setJobOrder(Configuration::JobOrder::LARGEST_FIRST);
+    else if(order == "shortest") config.setJobOrder(Configuration::JobOrder::SHORTEST_FIRST);
+    else
+    {
+      error = QString("Unknown job order '%1'.").arg(order);
+      return false;
+    }
+  }
+
+  if(parser.isSet("languages"))
+  {
+    config.setLanguages(parser.value("languages").split(',', QString::SkipEmptyParts));
+  }
+
+  if(parser.isSet("video-codec"))
+  {
+    const auto codec = parser.value("video-codec").toLower();
+    if     (codec == "vp8")                     config.setVideoCodec(Configuration::VideoCodec::VP8);
+    else if(codec == "vp9")                     config.setVideoCodec(Configuration::VideoCodec::VP9);
+    else if(codec == "h264")                    config.setVideoCodec(Configuration::VideoCodec::H264);
+    else if(codec == "h265" || codec == "hevc") config.setVideoCodec(Configuration::VideoCodec::H265);
+    else
+    {
+      error = QString("Unknown video codec '%1'.").arg(codec);
+      return false;
+    }
+  }
+
+  if(parser.isSet("audio-codec"))
+  {
+    const auto codec = parser.value("audio-codec").toLower();
+    if     (codec == "vorbis") config.setAudioCodec(Configuration::AudioCodec::VORBIS);
+    else if(codec == "aac")    config.setAudioCodec(Configuration::AudioCodec::AAC);
+    else
+    {
+      error = QString("Unknown audio codec '%1'.").arg(codec);
+      return false;
+    }
+  }
+
+  Configuration::Language language;
+  if(parser.isSet("audio-language"))
+  {
+    if(!parseLanguage(parser.value("audio-language"), language))
+    {
+      error = QString("Unknown language '%1'.").arg(parser.value("audio-language"));
+      return false;
+    }
+    config.setPreferredAudioLanguage(language);
+  }
+
+  if(parser.isSet("subtitle-language"))
+  {
+    if(!parseLanguage(parser.value("subtitle-language"), language))
+    {
+      error = QString("Unknown language '%1'.").arg(parser.value("subtitle-language"));
+      return false;
+    }
+    config.setPreferredSubtitleLanguage(language);
+  }
+
+  if(!config.isValid())
+  {
+    error = QString("Invalid codec combination, use VP8/VP9 with Vorbis or H.264/H.265 with AAC.");
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------
+bool collectFiles(const QCommandLineParser &parser, std::vector<std::filesystem::path> &files, QString &error)
+{
+  QStringList inputs = parser.positionalArguments();
+
+  if(parser.isSet("file-list"))
+  {
+    QFile list(parser.value("file-list"));
+    if(!list.open(QFile::ReadOnly|QFile::Text))
+    {
+      error = QString("Unable to open file list '%1'.").arg(list.fileName());
+      return false;
+    }
+
+    QTextStream stream(&list);
+    stream.setCodec("UTF-8");
+    while(!stream.atEnd())
+    {
+      const auto line = stream.readLine().trimmed();
+      if(!line.isEmpty() && !line.startsWith('#')) inputs << line;
+    }
+  }
+
+  Utils::SearchFilter filter;
+  filter.subdirectories = !parser.isSet("no-recursive");
+
+  for(const auto &patterns: parser.values("exclude"))
+  {
+    for(const auto &pattern: patterns.split(',', QString::SkipEmptyParts)) filter.excludes.push_back(pattern.trimmed().toStdWString());
+  }
+
+  int value;
+  auto integerOption = [&](const QString &name, const long long factor, long long &result)
+  {
+    if(!parser.isSet(name)) return true;
+    if(!parseInteger(parser.value(name), value))
+    {
+      error = QString("Invalid value '%1' for option --%2.").arg(parser.value(name)).arg(name);
+      return false;
+    }
+    result = value * factor;
+    return true;
+  };
+
+  long long minimumSize = 0, maximumSize = 0, modifiedWithin = 0, threads = 0;
+  if(!integerOption("min-size",        1024LL * 1024, minimumSize))    return false;
+  if(!integerOption("max-size",        1024LL * 1024, maximumSize))    return false;
+  if(!integerOption("modified-within", 86400000LL,    modifiedWithin)) return false;
+  if(!integerOption("scan-threads",    1,             threads))        return false;
+
+  filter.minimumSize   = minimumSize;
+  filter.maximumSize   = maximumSize;
+  filter.modifiedAfter = modifiedWithin > 0 ? QDateTime::currentMSecsSinceEpoch() - modifiedWithin : 0;
+  filter.threads       = static_cast<int>(threads);
+
+  for(const auto &input: inputs)
+  {
+    const std::filesystem::path path(input.toStdWString());
+
+    if(std::filesystem::is_directory(path))
+    {
+      const auto first = files.size();
+
+      Utils::findFiles(path, filter, [&files](std::filesystem::path &&file)
+      {
+        files.push_back(std::move(file));
+        return true;
+      });
+
+      // the directories are listed in parallel, in any order.
+      std::sort(files.begin() + first, files.end());
+    }
+    else if(std::filesystem::is_regular_file(path))
+    {
+      files.emplace_back(path);
+    }
+    else
+    {
+      error = QString("Input '%1' doesn't exist.").arg(input);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------
+int runCoordinator(QCoreApplication &app, const QCommandLineParser &parser, const Configuration &configuration, const std::vector<std::filesystem::path> &files)
+{
+  quint16 port;
+  if(!parsePort(parser.value("coordinator"), port))
+  {
+    ConsoleReporter::write("error", QJsonObject{{"message", QString("Invalid port '%1'.").arg(parser.value("coordinator"))}});
+    return 2;
+  }
+
+  Coordinator coordinator(files, configuration.jobOrder());
+  int errorsCount = 0;
+
+  QObject::connect(&coordinator, &Coordinator::information_message, [](const QString &message)
+  {
+    ConsoleReporter::write("info", QJsonObject{{"message", message}});
+  });
+  QObject::connect(&coordinator, &Coordinator::error_message, [&errorsCount](const QString &message)
+  {
+    ++errorsCount;
+    ConsoleReporter::write("error", QJsonObject{{"message", message}});
+  });
+  QObject::connect(&coordinator, &Coordinator::job_progress, [](const QString &file, const QString &agent, int value)
+  {
+    ConsoleReporter::write("progress", QJsonObject{{"file", file}, {"agent", agent}, {"value", value}});
+  });
+  QObject::connect(&coordinator, &Coordinator::job_finished, [](const QString &file, const QString &agent, const QString &status)
+  {
+    ConsoleReporter::write("job_finished", QJsonObject{{"file", file}, {"agent", agent}, {"status", status}});
+  });
+  QObject::connect(&coordinator, &Coordinator::agent_status, [](const QString &agent, int jobs, int capacity, double throughput)
+  {
+    ConsoleReporter::write("agent", QJsonObject{{"agent", agent}, {"jobs", jobs}, {"capacity", capacity}, {"throughput", throughput}});
+  });
+  QObject::connect(&coordinator, SIGNAL(finished()), &app, SLOT(quit()), Qt::QueuedConnection);
+
+  QTimer interruptTimer;
+  QObject::connect(&interruptTimer, &QTimer::timeout, [&coordinator]()
+  {
+    if(s_interrupted && !coordinator.hasBeenCancelled())
+    {
+      ConsoleReporter::write("info", QJsonObject{{"message", "Interrupted, stopping agents."}});
+      coordinator.stop();
+    }
+  });
+  interruptTimer.start(200);
+
+  if(!coordinator.listen(port)) return 2;
+
+  ConsoleReporter::write("start", QJsonObject{{"jobs", coordinator.jobsCount()}, {"port", port}});
+
+  app.exec();
+
+  ConsoleReporter::write("finished", QJsonObject{{"jobs",      coordinator.jobsCount()},
+                                                 {"completed", coordinator.finishedJobsCount()},
+                                                 {"errors",    errorsCount},
+                                                 {"cancelled", coordinator.hasBeenCancelled()}});
+
+  const bool success = !coordinator.hasBeenCancelled() && coordinator.failedJobsCount() == 0 && errorsCount == 0;
+
+  return success ? 0 : 1;
+}
+
+//-----------------------------------------------------------------
+int runAgent(QCoreApplication &app, const QCommandLineParser &parser, const Configuration &configuration)
+{
+  const auto address = parser.value("agent");
+  const auto separator = address.lastIndexOf(':');
+
+  QString host = address;
+  quint16 port = Coordinator::defaultPort();
+
+  if(separator >= 0)
+  {
+    host = address.left(separator);
+
+    if(!parsePort(address.mid(separator + 1), port))
+    {
+      ConsoleReporter::write("error", QJsonObject{{"message", QString("Invalid coordinator address '%1'.").arg(address)}});
+      return 2;
+    }
+  }
+
+  int capacity = configuration.numberOfThreads();
+  if(capacity == 0) capacity = std::max(1u, std::thread::hardware_concurrency() / 2);
+
+  if(parser.isSet("capacity") && (!parseInteger(parser.value("capacity"), capacity) || capacity == 0))
+  {
+    ConsoleReporter::write("error", QJsonObject{{"message", QString("Invalid capacity '%1'.").arg(parser.value("capacity"))}});
+    return 2;
+  }
+
+  const auto name = parser.isSet("name") ? parser.value("name") : QHostInfo::localHostName();
+
+  Agent agent(name, capacity, configuration);
+  ConsoleReporter reporter(agent.scheduler());
+
+  QObject::connect(&agent, &Agent::error_message, [](const QString &message)
+  {
+    ConsoleReporter::write("error", QJsonObject{{"message", message}});
+  });
+  QObject::connect(&agent, SIGNAL(finished()), &app, SLOT(quit()), Qt::QueuedConnection);
+
+  QTimer interruptTimer;
+  QObject::connect(&interruptTimer, &QTimer::timeout, [&agent]()
+  {
+    if(s_interrupted && !agent.scheduler()->hasBeenCancelled())
+    {
+      ConsoleReporter::write("info", QJsonObject{{"message", "Interrupted, stopping workers."}});
+      agent.stop();
+    }
+  });
+  interruptTimer.start(200);
+
+  ConsoleReporter::write("start", QJsonObject{{"agent", name}, {"coordinator", QString("%1:%2").arg(host).arg(port)}, {"capacity", capacity}});
+
+  agent.connectTo(host, port);
+
+  app.exec();
+
+  const bool success = !agent.hasLostConnection() && !agent.scheduler()->hasBeenCancelled() && reporter.errorsCount() == 0;
+
+  return success ? 0 : 1;
+}
+
+//-----------------------------------------------------------------
+int runWatch(QCoreApplication &app, const QCommandLineParser &parser, const Configuration &configuration)
+{
+  int settle = 30;
+  if(parser.isSet("settle") && (!parseInteger(parser.value("settle"), settle) || settle == 0))
+  {
+    ConsoleReporter::write("error", QJsonObject{{"message", QString("Invalid settle time '%1'.").arg(parser.value("settle"))}});
+    return 2;
+  }
+
+  const auto inputs = parser.positionalArguments();
+  if(inputs.isEmpty())
+  {
+    ConsoleReporter::write("error", QJsonObject{{"message", QString("No directories to watch.")}});
+    return 2;
+  }
+
+  Scheduler scheduler(std::vector<std::filesystem::path>(), configuration);
+  scheduler.setIntakeOpen(true);
+
+  ConsoleReporter reporter(&scheduler);
+
+  std::vector<std::unique_ptr<FolderWatcher>> watchers;
+  for(const auto &input: inputs)
+  {
+    const std::filesystem::path path(input.toStdWString());
+    if(!std::filesystem::is_directory(path))
+    {
+      ConsoleReporter::write("error", QJsonObject{{"message", QString("Input '%1' isn't a directory.").arg(input)}});
+      return 2;
+    }
+
+    auto watcher = std::make_unique<FolderWatcher>(path, settle);
+
+    QObject::connect(watcher.get(), &FolderWatcher::information_message, [](const QString &message)
+    {
+      ConsoleReporter::write("info", QJsonObject{{"message", message}});
+    });
+    QObject::connect(watcher.get(), &FolderWatcher::error_message, [](const QString &message)
+    {
+      ConsoleReporter::write("error", QJsonObject{{"message", message}});
+    });
+    QObject::connect(watcher.get(), &FolderWatcher::file_ready, [&scheduler](const QString &file, bool changed)
+    {
+      ConsoleReporter::write("queued", QJsonObject{{"file", file}, {"changed", changed}});
+
+      // the previous outputs of a changed file are only replaced once the new ones are complete.
+      if(!scheduler.enqueue(std::filesystem::path(file.toStdWString()), changed))
+      {
+        ConsoleReporter::write("info", QJsonObject{{"message", QString("File '%1' doesn't need processing.").arg(file)}});
+      }
+    });
+
+    watchers.push_back(std::move(watcher));
+  }
+
+  QObject::connect(&scheduler, SIGNAL(finished()), &app, SLOT(quit()), Qt::QueuedConnection);
+
+  // the watch only ends when interrupted.
+  QTimer interruptTimer;
+  QObject::connect(&interruptTimer, &QTimer::timeout, [&scheduler]()
+  {
+    if(s_interrupted && !scheduler.hasBeenCancelled())
+    {
+      ConsoleReporter::write("info", QJsonObject{{"message", "Interrupted, stopping workers."}});
+      scheduler.stop();
+    }
+  });
+  interruptTimer.start(200);
+
+  ConsoleReporter::write("start", QJsonObject{{"watch", QJsonArray::fromStringList(inputs)}, {"settle", settle}, {"workers", scheduler.maximumWorkers()}});
+
+  scheduler.start();
+  for(auto &watcher: watchers) watcher->start();
+
+  app.exec();
+
+  return reporter.errorsCount() == 0 ? 0 : 1;
+}
+
+//-----------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  qInstallMessageHandler(myMessageOutput);
+
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("vtc");
+  QCoreApplication::setApplicationVersion("1.1.3");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Transcodes video files to formats supported by Chromecast devices. "
+                                   "Progress is written to the standard output as JSON lines.");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  parser.addPositionalArgument("inputs", "Directories to search for video files or video files to transcode.", "[inputs...]");
+  parser.addOptions({
+    {{"l", "file-list"},     "Read inputs from <file>, one per line.", "file"},
+    {"no-recursive",         "Don't search subdirectories of the input directories."},
+    {"exclude",              "Comma separated wildcard patterns of the names of the files and directories to skip.", "patterns"},
+    {"min-size",             "Skip the files smaller than <MB>.", "MB"},
+    {"max-size",             "Skip the files bigger than <MB>, 0 for unlimited.", "MB"},
+    {"modified-within",      "Only the files modified in the last <days>, 0 for any.", "days"},
+    {"scan-threads",         "Directories listed in parallel while searching the inputs, 0 for automatic.", "number"},
+    {"ignore-settings",      "Start from the default configuration instead of the one saved by the application."},
+    {{"t", "threads"},       "Number of files transcoded simultaneously, 0 to adjust it to the measured throughput.", "number"},
+    {"thread-budget",        "Number of cores shared by the codecs of all the files, 0 for all the cores.", "cores"},
+    {"priority",             "Execution class of the jobs: normal, batch or idle (lower CPU and I/O priority).", "class"},
+    {"fps-limit",            "Maximum frames per second of all the files, 0 for unlimited.", "fps"},
+    {"read-limit",           "Maximum MB per second read by all the files, 0 for unlimited.", "MB/s"},
+    {"memory-budget",        "MB of memory for the files transcoded simultaneously, 0 for unlimited.", "MB"},
+    {"checkpoints",          "Minutes of video between checkpoints to resume interrupted transcodings, 0 to disable them.", "minutes"},
+    {"video-codec",          "Output video codec: vp8, vp9, h264 or h265.", "codec"},
+    {"video-bitrate",        "Output video bitrate in kbps, 0 for automatic.", "kbps"},
+    {"audio-codec",          "Output audio codec: vorbis or aac.", "codec"},
+    {"audio-bitrate",        "Output audio bitrate in kbps.", "kbps"},
+    {"audio-channels",       "Number of output audio channels.", "number"},
+    {"audio-language",       "Preferred audio language: default, english or spanish.", "language"},
+    {"subtitles",            "Extract subtitles: yes or no.", "yes|no"},
+    {"subtitle-language",    "Preferred subtitle language: default, english or spanish.", "language"},
+    {"languages",            "Ordered list of preferred ISO-639-2 languages, overrides the audio and subtitle languages.", "codes"},
+    {"all-languages",        "Keep all the audio tracks and extract all the subtitles in the preferred languages: yes or no.", "yes|no"},
+    {"journal",              "Resume interrupted batches using the journal of the jobs: yes or no.", "yes|no"},
+    {"numa",                 "Pin each file and its codec threads to the cores of one NUMA node (Linux): yes or no.", "yes|no"},
+    {"audio-queue",          "Size of the audio packets queue.", "packets"},
+    {"video-queue",          "Size of the video packets queue.", "packets"},
+    {"muxer-queue",          "Size of the muxer packets queue.", "packets"},
+    {"chunked",              "Encode the video of each file in parallel chunks: yes or no.", "yes|no"},
+    {"chunks",               "Number of chunks of the chunked encoding.", "number"},
+    {"prefetch",             "Read ahead the inputs in a background thread instead of mapping them: yes or no.", "yes|no"},
+    {"block-size",           "Size of the read ahead blocks in MB.", "MB"},
+    {"prefetch-depth",       "Number of blocks read ahead.", "blocks"},
+    {"output-buffer",        "Size of the output write buffers in MB.", "MB"},
+    {"output-buffers",       "Number of output buffers waiting to be written.", "buffers"},
+    {"sync-output",          "Flush the output files to disk when closed: yes or no.", "yes|no"},
+    {"index",                "Skip the unchanged files already probed that don't need processing: yes or no.", "yes|no"},
+    {"watch",                "Keep running and transcode the new or changed video files of the input directories."},
+    {"settle",               "Seconds without changes in size or modification time before a watched file is transcoded.", "seconds"},
+    {"coordinator",          "Hand the jobs to the agents connecting to <port> instead of transcoding them.", "port"},
+    {"agent",                "Transcode the jobs of the coordinator at <host[:port]>, the inputs are ignored.", "host:port"},
+    {"capacity",             "Simultaneous jobs of the agent, the number of threads by default.", "jobs"},
+    {"name",                 "Name of the agent reported to the coordinator and of its journal and index files, the host name by default.", "name"},
+    {"order",                "Order of the files: fifo, largest (first) or shortest (first).", "order"}
+  });
+
+  parser.process(app);
+
+  Configuration configuration;
+  if(!parser.isSet("ignore-settings"))
+  {
+    configuration.load();
+  }
+  else
+  {
+    configuration.setNumberOfThreads(std::max(1u, std::thread::hardware_concurrency() / 2));
+  }
+
+  QString error;
+  std::vector<std::filesystem::path> files;
+
+  if(!applyOverrides(parser, configuration, error))
+  {
+    ConsoleReporter::write("error", QJsonObject{{"message", error}});
+    return 2;
+  }
+
+  std::signal(SIGINT,  signalHandler);
+  std::signal(SIGTERM, signalHandler);
+
+  if(parser.isSet("agent"))
+  {
+    return runAgent(app, parser, configuration);
+  }
+
+  if(parser.isSet("watch"))
+  {
+    return runWatch(app, parser, configuration);
+  }
+
+  if(!collectFiles(parser, files, error))
+  {
+    ConsoleReporter::write("error", QJsonObject{{"message", error}});
+    return 2;
+  }
+
+  if(files.empty())
+  {
+    ConsoleReporter::write("finished", QJsonObject{{"jobs", 0}, {"completed", 0}, {"errors", 0}, {"cancelled", false}});
+    return 0;
+  }
+
+  if(parser.isSet("coordinator"))
+  {
+    return runCoordinator(app, parser, configuration, files);
+  }
+
+  Scheduler scheduler(files, configuration);
+  ConsoleReporter reporter(&scheduler);
+
+  QObject::connect(&scheduler, SIGNAL(finished()), &app, SLOT(quit()), Qt::QueuedConnection);
+
+  // signal handlers can't call Qt, the flag is polled from the event loop instead.
+  QTimer interruptTimer;
+  QObject::connect(&interruptTimer, &QTimer::timeout, [&scheduler]()
+  {
+    if(s_interrupted && !scheduler.hasBeenCancelled())
+    {
+      ConsoleReporter::write("info", QJsonObject{{"message", "Interrupted, stopping workers."}});
+      scheduler.stop();
+    }
+  });
+  interruptTimer.start(200);
+
+  ConsoleReporter::write("start", QJsonObject{{"jobs", scheduler.jobsCount()}, {"workers", scheduler.maximumWorkers()}});
+
+  scheduler.start();
+
+  app.exec();
+
+  const bool success = !scheduler.hasBeenCancelled() && reporter.errorsCount() == 0;
+
+  return success ? 0 : 1;
+}
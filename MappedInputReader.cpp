@@ -0,0 +1,173 @@
+/*
+ File: MappedInputReader.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <MappedInputReader.h>
+
+// libav
+extern "C"
+{
+#include <libavutil/error.h>
+}
+
+// C++
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+
+//-----------------------------------------------------------------
+MappedInputReader::MappedInputReader(const QString &filename)
+: m_file      {filename}
+, m_data      {nullptr}
+, m_size      {0}
+, m_position  {0}
+, m_run       {0}
+, m_sequential{false}
+{
+}
+
+//-----------------------------------------------------------------
+MappedInputReader::~MappedInputReader()
+{
+  close();
+}
+
+//-----------------------------------------------------------------
+bool MappedInputReader::open()
+{
+  if(!m_file.open(QIODevice::ReadOnly)) return false;
+
+  m_size     = m_file.size();
+  m_position = 0;
+  m_run      = 0;
+
+  if(m_size > 0)
+  {
+    m_data = m_file.map(0, m_size);
+    if(m_data) advise(true);
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------
+void MappedInputReader::close()
+{
+  if(m_data)
+  {
+    m_file.unmap(m_data);
+    m_data = nullptr;
+  }
+
+  if(m_file.isOpen()) m_file.close();
+}
+
+//-----------------------------------------------------------------
+int MappedInputReader::read(unsigned char *buffer, int size)
+{
+  if(m_position >= m_size) return AVERROR_EOF;
+
+  const auto count = static_cast<int>(std::min<long long>(size, m_size - m_position));
+
+  if(m_data)
+  {
+    std::memcpy(buffer, m_data + m_position, count);
+
+    // after a jump to the index or a chunk start the rest of the file is usually read in order.
+    if(!m_sequential)
+    {
+      m_run += count;
+      if(m_run >= s_sequential_run) advise(true);
+    }
+  }
+  else
+  {
+    if(m_file.pos() != m_position && !m_file.seek(m_position)) return AVERROR(EIO);
+
+    const auto read = m_file.read(reinterpret_cast<char *>(buffer), count);
+    if(read < 0)  return AVERROR(EIO);
+    if(read == 0) return AVERROR_EOF;
+
+    m_position += read;
+    return static_cast<int>(read);
+  }
+
+  m_position += count;
+  return count;
+}
+
+//-----------------------------------------------------------------
+long long MappedInputReader::seek(long long offset, int whence)
+{
+  const auto target = seek_target(offset, whence, m_position, m_size);
+  if(target < 0) return AVERROR(EINVAL);
+
+  // long jumps (index at the end of the file, chunk seeks) disable the readahead until the demuxer
+  // has read a run of data in order again.
+  if(std::llabs(target - m_position) >= s_sequential_distance)
+  {
+    m_run = 0;
+    advise(false);
+  }
+
+  m_position = target;
+
+  return m_position;
+}
+
+//-----------------------------------------------------------------
+long long MappedInputReader::size() const
+{
+  return m_size;
+}
+
+//-----------------------------------------------------------------
+long long MappedInputReader::pos() const
+{
+  return m_position;
+}
+
+//-----------------------------------------------------------------
+QString MappedInputReader::errorString() const
+{
+  return m_file.errorString();
+}
+
+//-----------------------------------------------------------------
+bool MappedInputReader::isMapped() const
+{
+  return m_data != nullptr;
+}
+
+//-----------------------------------------------------------------
+void MappedInputReader::advise(bool sequential)
+{
+#ifdef Q_OS_UNIX
+  if(m_data && sequential != m_sequential)
+  {
+    posix_madvise(m_data, m_size, sequential ? POSIX_MADV_SEQUENTIAL : POSIX_MADV_RANDOM);
+  }
+#endif
+
+  m_sequential = sequential;
+}
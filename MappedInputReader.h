@@ -0,0 +1,80 @@
+/*
+ File: MappedInputReader.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPPEDINPUTREADER_H_
+#define MAPPEDINPUTREADER_H_
+
+// Project
+#include <InputReader.h>
+
+// Qt
+#include <QFile>
+
+/** \class MappedInputReader
+ * \brief Reads the input file through a read-only memory mapping of the whole file, avoiding a read
+ *        syscall per block. Falls back to plain file reads if the file can't be mapped.
+ *
+ */
+class MappedInputReader
+: public InputReader
+{
+  public:
+    /** \brief MappedInputReader class constructor.
+     * \param[in] filename input file name.
+     *
+     */
+    explicit MappedInputReader(const QString &filename);
+
+    /** \brief MappedInputReader class virtual destructor.
+     *
+     */
+    virtual ~MappedInputReader();
+
+    virtual bool open() override;
+    virtual void close() override;
+    virtual int read(unsigned char *buffer, int size) override;
+    virtual long long seek(long long offset, int whence) override;
+    virtual long long size() const override;
+    virtual long long pos() const override;
+    virtual QString errorString() const override;
+
+    /** \brief Returns true if the file has been mapped and false if it's read with syscalls.
+     *
+     */
+    bool isMapped() const;
+
+  private:
+    /** \brief Advises the kernel about the access pattern of the mapped region.
+     * \param[in] sequential true for sequential access and false for random access.
+     *
+     */
+    void advise(bool sequential);
+
+    QFile      m_file;       /** input file handle.                             */
+    uchar     *m_data;       /** mapped file data or nullptr if not mapped.     */
+    long long  m_size;       /** size of the file in bytes.                     */
+    long long  m_position;   /** current position in the file.                  */
+    long long  m_run;        /** bytes read since the last long jump.           */
+    bool       m_sequential; /** true if the last advice given was sequential.  */
+
+    static const long long s_sequential_distance = 1024*1024;   /** max seek distance considered sequential access.               */
+    static const long long s_sequential_run      = 4*1024*1024; /** bytes read after a long jump to consider the access sequential. */
+};
+
+#endif // MAPPEDINPUTREADER_H_
@@ -0,0 +1,153 @@
+/*
+ File: MemoryBudget.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <MemoryBudget.h>
+
+// Qt
+#include <QFile>
+#include <QMutexLocker>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+// C++
+#include <algorithm>
+
+//--------------------------------------------------------------------
+MemoryBudget::MemoryBudget(const int megabytes)
+: m_budget   {std::max(0, megabytes) * 1024LL * 1024LL}
+, m_baseline {residentMemory()}
+, m_reserved {0}
+, m_estimated{0}
+, m_ratio    {1.0}
+{
+}
+
+//--------------------------------------------------------------------
+bool MemoryBudget::isEnabled() const
+{
+  return m_budget > 0;
+}
+
+//--------------------------------------------------------------------
+qint64 MemoryBudget::budget() const
+{
+  return m_budget;
+}
+
+//--------------------------------------------------------------------
+qint64 MemoryBudget::corrected(const qint64 estimate) const
+{
+  QMutexLocker lock(&m_mutex);
+
+  return static_cast<qint64>(estimate * m_ratio);
+}
+
+//--------------------------------------------------------------------
+bool MemoryBudget::fits(const qint64 estimate) const
+{
+  if(!isEnabled()) return true;
+
+  QMutexLocker lock(&m_mutex);
+
+  return m_reserved == 0 || m_reserved + static_cast<qint64>(estimate * m_ratio) <= m_budget;
+}
+
+//--------------------------------------------------------------------
+qint64 MemoryBudget::acquire(const qint64 estimate, const std::atomic<bool> &cancelled)
+{
+  if(!isEnabled()) return 0;
+
+  QMutexLocker lock(&m_mutex);
+
+  while(true)
+  {
+    update();
+
+    // a job bigger than the budget runs alone instead of never.
+    const auto needed = static_cast<qint64>(estimate * m_ratio);
+    if(m_reserved == 0 || m_reserved + needed <= m_budget)
+    {
+      m_reserved  += needed;
+      m_estimated += estimate;
+      return needed;
+    }
+
+    m_released.wait(&m_mutex, 250);
+
+    if(cancelled) return -1;
+  }
+}
+
+//--------------------------------------------------------------------
+void MemoryBudget::release(const qint64 estimate, const qint64 reserved)
+{
+  if(!isEnabled() || reserved < 0) return;
+
+  QMutexLocker lock(&m_mutex);
+
+  update();
+
+  m_reserved  = std::max(0LL, m_reserved - reserved);
+  m_estimated = std::max(0LL, m_estimated - estimate);
+
+  m_released.wakeAll();
+}
+
+//--------------------------------------------------------------------
+void MemoryBudget::sample()
+{
+  if(!isEnabled()) return;
+
+  QMutexLocker lock(&m_mutex);
+
+  update();
+}
+
+//--------------------------------------------------------------------
+void MemoryBudget::update()
+{
+  const auto resident = residentMemory();
+  if(resident <= 0 || m_estimated <= 0) return;
+
+  const auto measured = std::max(0LL, resident - m_baseline);
+  const auto ratio    = std::min(4.0, std::max(0.5, static_cast<double>(measured) / m_estimated));
+
+  // follows the peaks immediately and forgets them slowly.
+  m_ratio = (ratio > m_ratio) ? ratio : 0.95 * m_ratio + 0.05 * ratio;
+}
+
+//--------------------------------------------------------------------
+qint64 MemoryBudget::residentMemory()
+{
+#ifdef Q_OS_LINUX
+  QFile file("/proc/self/statm");
+  if(!file.open(QIODevice::ReadOnly)) return 0;
+
+  // size resident shared text lib data dt, in pages.
+  const auto fields = file.readAll().simplified().split(' ');
+  if(fields.size() < 2) return 0;
+
+  return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif
+}
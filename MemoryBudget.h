@@ -0,0 +1,109 @@
+/*
+ File: MemoryBudget.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEMORYBUDGET_H_
+#define MEMORYBUDGET_H_
+
+// Qt
+#include <QMutex>
+#include <QWaitCondition>
+
+// C++
+#include <atomic>
+
+/** \class MemoryBudget
+ * \brief Admission control of the jobs by memory. Each job reserves its estimated peak memory before
+ *        allocating its decoders and encoders and waits while the reservations of the running jobs don't
+ *        leave room for it. A job is always admitted if no other is running. The estimates are corrected
+ *        with the measured resident memory of the process, shared among the running jobs in proportion
+ *        to their estimates. Thread safe.
+ *
+ */
+class MemoryBudget
+{
+  public:
+    /** \brief MemoryBudget class constructor.
+     * \param[in] megabytes memory available for the jobs in MB, 0 for unlimited.
+     *
+     */
+    explicit MemoryBudget(const int megabytes);
+
+    /** \brief Returns true if the memory of the jobs is limited and false otherwise.
+     *
+     */
+    bool isEnabled() const;
+
+    /** \brief Returns the memory available for the jobs in bytes.
+     *
+     */
+    qint64 budget() const;
+
+    /** \brief Returns the estimate corrected with the measured memory.
+     * \param[in] estimate estimated peak memory of a job in bytes.
+     *
+     */
+    qint64 corrected(const qint64 estimate) const;
+
+    /** \brief Returns true if a job with the given estimate can start now and false if it would have to wait.
+     * \param[in] estimate estimated peak memory of a job in bytes.
+     *
+     */
+    bool fits(const qint64 estimate) const;
+
+    /** \brief Waits until the corrected estimate fits the budget and reserves it. Returns the reserved
+     *         bytes or -1 if cancelled while waiting.
+     * \param[in] estimate estimated peak memory of the job in bytes.
+     * \param[in] cancelled flag of the job, true if it has been cancelled.
+     *
+     */
+    qint64 acquire(const qint64 estimate, const std::atomic<bool> &cancelled);
+
+    /** \brief Returns the memory of a finished job to the budget.
+     * \param[in] estimate estimated peak memory of the job, as given to acquire().
+     * \param[in] reserved bytes returned by acquire().
+     *
+     */
+    void release(const qint64 estimate, const qint64 reserved);
+
+    /** \brief Measures the resident memory of the process and updates the correction of the estimates.
+     *
+     */
+    void sample();
+
+    /** \brief Returns the resident memory of the process in bytes or 0 if it can't be measured.
+     *
+     */
+    static qint64 residentMemory();
+
+  private:
+    /** \brief Updates the correction with the current resident memory. The mutex must be locked.
+     *
+     */
+    void update();
+
+    const qint64   m_budget;    /** memory available for the jobs in bytes, 0 unlimited.  */
+    const qint64   m_baseline;  /** resident memory of the process without jobs.         */
+    qint64         m_reserved;  /** corrected memory reserved by the running jobs.       */
+    qint64         m_estimated; /** estimated memory of the running jobs.                */
+    double         m_ratio;     /** measured / estimated memory of the jobs.             */
+    mutable QMutex m_mutex;     /** protects the budget data.                            */
+    QWaitCondition m_released;  /** signaled when memory is returned to the budget.      */
+};
+
+#endif // MEMORYBUDGET_H_
@@ -0,0 +1,160 @@
+/*
+ File: NumaPlacement.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <NumaPlacement.h>
+
+// Qt
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+// C++
+#include <algorithm>
+
+//--------------------------------------------------------------------
+NumaPlacement::NumaPlacement(const bool enabled)
+{
+#ifdef Q_OS_LINUX
+  if(!enabled) return;
+
+  const QDir nodesDir("/sys/devices/system/node");
+  const auto entries = nodesDir.entryList(QStringList{"node*"}, QDir::Dirs, QDir::Name);
+
+  for(const auto &entry: entries)
+  {
+    bool ok = false;
+    const auto id = entry.mid(4).toInt(&ok);
+    if(!ok) continue;
+
+    QFile file(nodesDir.absoluteFilePath(entry + "/cpulist"));
+    if(!file.open(QIODevice::ReadOnly|QIODevice::Text)) continue;
+
+    const auto cpus = parseCpuList(QString::fromLatin1(file.readAll()));
+    if(!cpus.empty()) m_nodes.push_back(Node{id, cpus, 0});
+  }
+
+  std::sort(m_nodes.begin(), m_nodes.end(), [](const Node &a, const Node &b) { return a.id < b.id; });
+
+  // nothing to gain on single node machines.
+  if(m_nodes.size() < 2) m_nodes.clear();
+#else
+  Q_UNUSED(enabled);
+#endif
+}
+
+//--------------------------------------------------------------------
+bool NumaPlacement::isEnabled() const
+{
+  return !m_nodes.empty();
+}
+
+//--------------------------------------------------------------------
+int NumaPlacement::nodesCount() const
+{
+  return static_cast<int>(m_nodes.size());
+}
+
+//--------------------------------------------------------------------
+int NumaPlacement::acquire()
+{
+  if(m_nodes.empty()) return -1;
+
+  // the least occupied node relative to its number of cores.
+  auto load = [](const Node &node) { return static_cast<double>(node.jobs) / node.cpus.size(); };
+  auto best = std::min_element(m_nodes.begin(), m_nodes.end(), [&load](const Node &a, const Node &b) { return load(a) < load(b); });
+
+  ++best->jobs;
+
+  return static_cast<int>(std::distance(m_nodes.begin(), best));
+}
+
+//--------------------------------------------------------------------
+void NumaPlacement::release(const int node)
+{
+  if(node < 0 || node >= nodesCount()) return;
+
+  m_nodes[node].jobs = std::max(0, m_nodes[node].jobs - 1);
+}
+
+//--------------------------------------------------------------------
+QString NumaPlacement::occupancy() const
+{
+  QStringList nodes;
+  for(int i = 0; i < nodesCount(); ++i) nodes << QString("node %1: %2").arg(i).arg(m_nodes[i].jobs);
+
+  return nodes.join(", ");
+}
+
+//--------------------------------------------------------------------
+bool NumaPlacement::bindCurrentThread(const int node) const
+{
+  if(node < 0 || node >= nodesCount()) return false;
+
+#ifdef Q_OS_LINUX
+  const auto &data = m_nodes[node];
+
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for(const auto cpu: data.cpus) if(cpu < CPU_SETSIZE) CPU_SET(cpu, &cpus);
+
+  if(sched_setaffinity(0, sizeof(cpus), &cpus) != 0) return false;
+
+  // MPOL_PREFERRED, set directly to avoid depending on libnuma. The pages of the frames allocated
+  // afterwards come from the node while it has free memory.
+  constexpr int PREFERRED_POLICY = 1;
+  constexpr int MASK_BITS = 8 * sizeof(unsigned long);
+
+  unsigned long mask[1024 / MASK_BITS] = {0};
+  if(data.id >= 1024) return true;
+  mask[data.id / MASK_BITS] = 1UL << (data.id % MASK_BITS);
+
+  syscall(SYS_set_mempolicy, PREFERRED_POLICY, mask, 1024UL);
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+//--------------------------------------------------------------------
+std::vector<int> NumaPlacement::parseCpuList(const QString &list)
+{
+  std::vector<int> cpus;
+
+  for(const auto &range: list.trimmed().split(',', QString::SkipEmptyParts))
+  {
+    const auto limits = range.split('-');
+    bool okFirst = false, okLast = true;
+
+    const auto first = limits.first().toInt(&okFirst);
+    const auto last  = (limits.size() > 1) ? limits.at(1).toInt(&okLast) : first;
+    if(!okFirst || !okLast) continue;
+
+    for(int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+  }
+
+  return cpus;
+}
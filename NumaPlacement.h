@@ -0,0 +1,99 @@
+/*
+ File: NumaPlacement.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NUMAPLACEMENT_H_
+#define NUMAPLACEMENT_H_
+
+// Qt
+#include <QString>
+
+// C++
+#include <vector>
+
+/** \class NumaPlacement
+ * \brief Assigns each worker to the least occupied NUMA node of the machine and pins the threads of the
+ *        worker to the cores of that node, preferring its local memory. The codec and pipeline threads
+ *        created afterwards by the worker inherit the placement. Only available on Linux machines with
+ *        more than one node, otherwise the workers aren't pinned. Not thread safe, used by the scheduler.
+ *
+ */
+class NumaPlacement
+{
+  public:
+    /** \brief NumaPlacement class constructor. Reads the topology of the machine.
+     * \param[in] enabled true to place the workers and false to disable the placement.
+     *
+     */
+    explicit NumaPlacement(const bool enabled);
+
+    /** \brief Returns true if the workers are placed in the NUMA nodes.
+     *
+     */
+    bool isEnabled() const;
+
+    /** \brief Returns the number of NUMA nodes used for placement, 0 if disabled.
+     *
+     */
+    int nodesCount() const;
+
+    /** \brief Assigns a job to the least occupied node and returns its index, or -1 if disabled.
+     *
+     */
+    int acquire();
+
+    /** \brief Removes a job from a node.
+     * \param[in] node node index returned by acquire().
+     *
+     */
+    void release(const int node);
+
+    /** \brief Returns a description of the number of jobs in each node.
+     *
+     */
+    QString occupancy() const;
+
+    /** \brief Pins the calling thread to the cores of the node and prefers its memory for the following
+     *         allocations. Returns true on success and false otherwise.
+     * \param[in] node node index returned by acquire().
+     *
+     */
+    bool bindCurrentThread(const int node) const;
+
+  private:
+    /** \struct Node
+     * \brief NUMA node of the machine.
+     *
+     */
+    struct Node
+    {
+      int              id;   /** system identifier of the node. */
+      std::vector<int> cpus; /** cores of the node.             */
+      int              jobs; /** number of jobs in the node.    */
+    };
+
+    /** \brief Parses a list of cores in the kernel format (e.g. "0-7,16-23").
+     * \param[in] list list of cores.
+     *
+     */
+    static std::vector<int> parseCpuList(const QString &list);
+
+    std::vector<Node> m_nodes; /** NUMA nodes, empty if the placement is disabled. */
+};
+
+#endif // NUMAPLACEMENT_H_
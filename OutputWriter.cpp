@@ -0,0 +1,277 @@
+/*
+ File: OutputWriter.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <OutputWriter.h>
+
+// libav
+extern "C"
+{
+#include <libavutil/mem.h>
+#include <libavutil/error.h>
+}
+
+// C++
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------
+OutputWriter::OutputWriter(const QString &filename, const int bufferSize, const int buffers, const bool sync)
+: m_file    {filename}
+, m_capacity{std::max(s_io_buffer_size, bufferSize)}
+, m_buffers {std::max(1, buffers)}
+, m_sync    {sync}
+, m_context {nullptr}
+, m_current {nullptr}
+, m_position{0}
+, m_size    {0}
+, m_pending {std::max(1, buffers)}
+, m_free    {std::max(1, buffers)}
+, m_error   {false}
+{
+}
+
+//-----------------------------------------------------------------
+OutputWriter::~OutputWriter()
+{
+  close();
+}
+
+//-----------------------------------------------------------------
+bool OutputWriter::open()
+{
+  if(!m_file.open(QIODevice::WriteOnly|QIODevice::Truncate|QIODevice::Unbuffered))
+  {
+    m_message = m_file.errorString();
+    return false;
+  }
+
+  auto ioBuffer = reinterpret_cast<unsigned char *>(av_malloc(s_io_buffer_size));
+  if(ioBuffer) m_context = avio_alloc_context(ioBuffer, s_io_buffer_size, 1, this, nullptr, &write_callback, &seek_callback);
+
+  if(!m_context)
+  {
+    av_free(ioBuffer);
+    m_file.close();
+    m_message = QString("Unable to allocate the I/O context.");
+    return false;
+  }
+
+  m_context->seekable = AVIO_SEEKABLE_NORMAL;
+
+  for(int i = 0; i < m_buffers; ++i)
+  {
+    auto data = reinterpret_cast<unsigned char *>(av_malloc(m_capacity));
+    if(!data)
+    {
+      m_message = QString("Unable to allocate the output buffers.");
+      m_error = true;
+      break;
+    }
+
+    m_free.push(new Buffer{0, 0, data});
+  }
+
+  m_thread = std::thread(&OutputWriter::writer, this);
+
+  return !m_error;
+}
+
+//-----------------------------------------------------------------
+bool OutputWriter::close()
+{
+  if(m_context)
+  {
+    avio_flush(m_context);
+    av_freep(&m_context->buffer);
+    av_freep(&m_context);
+  }
+
+  if(m_thread.joinable())
+  {
+    submit();
+
+    m_pending.push(nullptr);
+    m_thread.join();
+
+    if(!m_error && m_sync && !sync_file())
+    {
+      m_message = QString("Unable to flush the data to disk.");
+      m_error = true;
+    }
+  }
+
+  for(auto buffer: m_free.drain())
+  {
+    av_free(buffer->data);
+    delete buffer;
+  }
+
+  if(m_file.isOpen()) m_file.close();
+
+  return !m_error;
+}
+
+//-----------------------------------------------------------------
+AVIOContext* OutputWriter::context() const
+{
+  return m_context;
+}
+
+//-----------------------------------------------------------------
+QString OutputWriter::errorString() const
+{
+  return m_message;
+}
+
+//-----------------------------------------------------------------
+int OutputWriter::write_callback(void *opaque, uint8_t *buffer, int buffer_size)
+{
+  auto writer = reinterpret_cast<OutputWriter *>(opaque);
+  return writer->write(buffer, buffer_size);
+}
+
+//-----------------------------------------------------------------
+int64_t OutputWriter::seek_callback(void *opaque, int64_t offset, int whence)
+{
+  auto writer = reinterpret_cast<OutputWriter *>(opaque);
+
+  whence &= ~AVSEEK_FORCE;
+
+  if(whence == AVSEEK_SIZE) return writer->m_size;
+
+  return writer->seek(offset, whence);
+}
+
+//-----------------------------------------------------------------
+int OutputWriter::write(const unsigned char *data, int size)
+{
+  int written = 0;
+
+  while(written < size)
+  {
+    if(m_error) return AVERROR(EIO);
+
+    if(!m_current)
+    {
+      if(!m_free.pop(m_current)) return AVERROR(EIO);
+
+      m_current->offset = m_position;
+      m_current->length = 0;
+    }
+
+    const auto count = std::min(size - written, m_capacity - m_current->length);
+    std::memcpy(m_current->data + m_current->length, data + written, count);
+
+    m_current->length += count;
+    m_position        += count;
+    written           += count;
+
+    if(m_current->length == m_capacity) submit();
+  }
+
+  m_size = std::max(m_size, m_position);
+
+  return size;
+}
+
+//-----------------------------------------------------------------
+long long OutputWriter::seek(long long offset, int whence)
+{
+  long long target;
+
+  switch(whence)
+  {
+    case SEEK_SET: target = offset;              break;
+    case SEEK_CUR: target = m_position + offset; break;
+    case SEEK_END: target = m_size + offset;     break;
+    default:       return AVERROR(EINVAL);
+  }
+
+  if(target < 0) return AVERROR(EINVAL);
+
+  // the muxer seeks back to rewrite the headers, the data written so far is handed to the
+  // writer thread that keeps the order of the writes.
+  if(target != m_position)
+  {
+    submit();
+    m_position = target;
+  }
+
+  return m_position;
+}
+
+//-----------------------------------------------------------------
+void OutputWriter::submit()
+{
+  if(!m_current) return;
+
+  if(m_current->length == 0)
+  {
+    m_free.push(m_current);
+  }
+  else
+  {
+    m_pending.push(m_current);
+  }
+
+  m_current = nullptr;
+}
+
+//-----------------------------------------------------------------
+void OutputWriter::writer()
+{
+  Buffer *buffer = nullptr;
+
+  while(m_pending.pop(buffer) && buffer)
+  {
+    if(!m_error)
+    {
+      if(!m_file.seek(buffer->offset) || m_file.write(reinterpret_cast<const char *>(buffer->data), buffer->length) != buffer->length)
+      {
+        m_message = m_file.errorString();
+        m_error = true;
+      }
+    }
+
+    m_free.push(buffer);
+  }
+}
+
+//-----------------------------------------------------------------
+bool OutputWriter::sync_file()
+{
+  const auto handle = m_file.handle();
+  if(handle < 0) return false;
+
+#if defined(Q_OS_WIN)
+  return _commit(handle) == 0;
+#elif defined(Q_OS_LINUX)
+  return fdatasync(handle) == 0;
+#else
+  return fsync(handle) == 0;
+#endif
+}
@@ -0,0 +1,161 @@
+/*
+ File: OutputWriter.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OUTPUTWRITER_H_
+#define OUTPUTWRITER_H_
+
+// Project
+#include <BoundedQueue.h>
+
+// Qt
+#include <QFile>
+#include <QString>
+
+// libav
+extern "C"
+{
+#include <libavformat/avio.h>
+}
+
+// C++
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+/** \class OutputWriter
+ * \brief Custom output AVIOContext that collects the muxer writes in big buffers that are written
+ *        to disk by a dedicated thread. The number of buffers is bounded, the muxer only waits for
+ *        the disk when all of them are waiting to be written.
+ *
+ */
+class OutputWriter
+{
+  public:
+    /** \brief OutputWriter class constructor.
+     * \param[in] filename output file name.
+     * \param[in] bufferSize size of the buffers in bytes.
+     * \param[in] buffers number of buffers.
+     * \param[in] sync true to flush the file data to the device when closing.
+     *
+     */
+    explicit OutputWriter(const QString &filename, const int bufferSize, const int buffers, const bool sync);
+
+    /** \brief OutputWriter class destructor.
+     *
+     */
+    ~OutputWriter();
+
+    /** \brief Opens the output file and creates the libav I/O context. Returns true on success and
+     *         false otherwise.
+     *
+     */
+    bool open();
+
+    /** \brief Writes the pending data, waits for the writer thread and closes the file. The I/O
+     *         context is no longer valid after this call. Returns true if all the data was written
+     *         successfully and false otherwise.
+     *
+     */
+    bool close();
+
+    /** \brief Returns the libav I/O context of the output.
+     *
+     */
+    AVIOContext *context() const;
+
+    /** \brief Returns a description of the last error.
+     *
+     */
+    QString errorString() const;
+
+  private:
+    /** \struct Buffer
+     * \brief Block of data to be written at a position of the file.
+     *
+     */
+    struct Buffer
+    {
+      long long      offset; /** position of the data in the file. */
+      int            length; /** length of the data in bytes.      */
+      unsigned char *data;   /** buffer data.                      */
+    };
+
+    /** \brief AVIOContext write callback, the opaque pointer is the writer.
+     * \param[in] opaque pointer to the writer.
+     * \param[in] buffer data to write.
+     * \param[in] buffer_size data size.
+     *
+     */
+    static int write_callback(void *opaque, uint8_t *buffer, int buffer_size);
+
+    /** \brief AVIOContext seek callback, the opaque pointer is the writer.
+     * \param[in] opaque pointer to the writer.
+     * \param[in] offset seek value.
+     * \param[in] whence seek direction or AVSEEK_SIZE.
+     *
+     */
+    static int64_t seek_callback(void *opaque, int64_t offset, int whence);
+
+    /** \brief Copies the data to the current buffer, handing it to the writer thread when full.
+     * \param[in] data data to write.
+     * \param[in] size data size.
+     *
+     */
+    int write(const unsigned char *data, int size);
+
+    /** \brief Moves the output position. Returns the new position or a negative libav error code.
+     * \param[in] offset seek value.
+     * \param[in] whence SEEK_SET, SEEK_CUR or SEEK_END.
+     *
+     */
+    long long seek(long long offset, int whence);
+
+    /** \brief Hands the current buffer to the writer thread.
+     *
+     */
+    void submit();
+
+    /** \brief Writes the buffers to disk.
+     *
+     */
+    void writer();
+
+    /** \brief Flushes the file data to the storage device.
+     *
+     */
+    bool sync_file();
+
+    QFile                   m_file;     /** output file handle, used by the writer thread.  */
+    const int               m_capacity; /** size of the buffers in bytes.                   */
+    const int               m_buffers;  /** number of buffers.                              */
+    const bool              m_sync;     /** true to sync the data to the device on close.   */
+    AVIOContext            *m_context;  /** libav I/O context.                              */
+    Buffer                 *m_current;  /** buffer being filled or nullptr if none.         */
+    long long               m_position; /** current output position.                        */
+    long long               m_size;     /** size of the output.                             */
+    BoundedQueue<Buffer *>  m_pending;  /** buffers waiting to be written.                  */
+    BoundedQueue<Buffer *>  m_free;     /** buffers available to be filled.                 */
+    std::thread             m_thread;   /** writer thread.                                  */
+    std::atomic<bool>       m_error;    /** true if a write has failed.                     */
+    QString                 m_message;  /** error description.                              */
+
+    static const int s_io_buffer_size = 65536; /** size of the libav I/O context buffer. */
+};
+
+#endif // OUTPUTWRITER_H_
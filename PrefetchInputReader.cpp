@@ -0,0 +1,277 @@
+/*
+ File: PrefetchInputReader.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <PrefetchInputReader.h>
+
+// libav
+extern "C"
+{
+#include <libavutil/error.h>
+}
+
+// C++
+#include <cstring>
+#include <algorithm>
+
+//-----------------------------------------------------------------
+PrefetchInputReader::PrefetchInputReader(const QString &filename, const int blockSize, const int depth)
+: m_file      {filename}
+, m_blockSize {std::max(4096, blockSize)}
+, m_depth     {std::max(1, depth)}
+, m_size      {0}
+, m_position  {0}
+, m_base      {0}
+, m_next      {0}
+, m_generation{0}
+, m_error     {false}
+, m_stop      {false}
+, m_hits      {0}
+, m_misses    {0}
+{
+}
+
+//-----------------------------------------------------------------
+PrefetchInputReader::~PrefetchInputReader()
+{
+  close();
+}
+
+//-----------------------------------------------------------------
+bool PrefetchInputReader::open()
+{
+  if(!m_file.open(QIODevice::ReadOnly|QIODevice::Unbuffered)) return false;
+
+  m_size     = m_file.size();
+  m_position = m_base = m_next = 0;
+  m_stop     = m_error = false;
+
+  m_thread = std::thread(&PrefetchInputReader::prefetch, this);
+
+  return true;
+}
+
+//-----------------------------------------------------------------
+void PrefetchInputReader::close()
+{
+  if(m_thread.joinable())
+  {
+    {
+      QMutexLocker lock(&m_mutex);
+      m_stop = true;
+      m_consumed.wakeAll();
+      m_filled.wakeAll();
+    }
+
+    m_thread.join();
+  }
+
+  m_blocks.clear();
+  m_free.clear();
+
+  if(m_file.isOpen()) m_file.close();
+}
+
+//-----------------------------------------------------------------
+int PrefetchInputReader::read(unsigned char *buffer, int size)
+{
+  QMutexLocker lock(&m_mutex);
+
+  if(m_position >= m_size) return AVERROR_EOF;
+
+  if(!isPrefetched(m_position)) restart();
+
+  bool waited = false;
+  while(true)
+  {
+    release();
+
+    if(!m_blocks.empty()) break;
+
+    if(m_error || m_stop) return AVERROR(EIO);
+
+    waited = true;
+    m_filled.wait(&m_mutex);
+  }
+
+  if(waited) ++m_misses;
+  else       ++m_hits;
+
+  const auto &block = m_blocks.front();
+  const auto blockPosition = m_position - block.offset;
+  const auto count = static_cast<int>(std::min<long long>(size, block.data.size() - blockPosition));
+
+  std::memcpy(buffer, block.data.data() + blockPosition, count);
+  m_position += count;
+
+  return count;
+}
+
+//-----------------------------------------------------------------
+long long PrefetchInputReader::seek(long long offset, int whence)
+{
+  QMutexLocker lock(&m_mutex);
+
+  const auto target = seek_target(offset, whence, m_position, m_size);
+  if(target < 0) return AVERROR(EINVAL);
+
+  m_position = target;
+
+  if(m_position < m_size && !isPrefetched(m_position)) restart();
+
+  return m_position;
+}
+
+//-----------------------------------------------------------------
+long long PrefetchInputReader::size() const
+{
+  return m_size;
+}
+
+//-----------------------------------------------------------------
+long long PrefetchInputReader::pos() const
+{
+  QMutexLocker lock(&m_mutex);
+  return m_position;
+}
+
+//-----------------------------------------------------------------
+QString PrefetchInputReader::errorString() const
+{
+  return m_file.errorString();
+}
+
+//-----------------------------------------------------------------
+QString PrefetchInputReader::statistics() const
+{
+  const unsigned long long hits   = m_hits;
+  const unsigned long long misses = m_misses;
+  const auto total = std::max(1ULL, hits + misses);
+
+  return QString("input prefetch %1 hits, %2 misses (%3% hit ratio).").arg(hits).arg(misses).arg((hits * 100) / total);
+}
+
+//-----------------------------------------------------------------
+unsigned long long PrefetchInputReader::hits() const
+{
+  return m_hits;
+}
+
+//-----------------------------------------------------------------
+unsigned long long PrefetchInputReader::misses() const
+{
+  return m_misses;
+}
+
+//-----------------------------------------------------------------
+void PrefetchInputReader::prefetch()
+{
+  QMutexLocker lock(&m_mutex);
+
+  while(!m_stop)
+  {
+    if(m_error || m_next >= m_size || static_cast<int>(m_blocks.size()) >= m_depth)
+    {
+      m_consumed.wait(&m_mutex);
+      continue;
+    }
+
+    const auto offset     = m_next;
+    const auto generation = m_generation;
+
+    std::vector<char> data;
+    if(!m_free.empty())
+    {
+      data = std::move(m_free.back());
+      m_free.pop_back();
+    }
+
+    const auto length = std::min<long long>(m_blockSize, m_size - offset);
+    data.resize(length);
+    m_next += length;
+
+    lock.unlock();
+
+    bool success = m_file.seek(offset);
+    long long read = 0;
+    while(success && read < length)
+    {
+      const auto value = m_file.read(data.data() + read, length - read);
+      if(value <= 0) success = false;
+      else           read += value;
+    }
+
+    lock.relock();
+
+    if(generation != m_generation)
+    {
+      // a seek has invalidated this block while it was being read.
+      m_free.emplace_back(std::move(data));
+      continue;
+    }
+
+    if(!success)
+    {
+      m_error = true;
+    }
+    else
+    {
+      m_blocks.push_back(Block{offset, std::move(data)});
+    }
+
+    m_filled.wakeAll();
+  }
+}
+
+//-----------------------------------------------------------------
+void PrefetchInputReader::release()
+{
+  bool released = false;
+
+  while(!m_blocks.empty() && m_blocks.front().offset + static_cast<long long>(m_blocks.front().data.size()) <= m_position)
+  {
+    m_base = m_blocks.front().offset + m_blocks.front().data.size();
+    m_free.emplace_back(std::move(m_blocks.front().data));
+    m_blocks.pop_front();
+    released = true;
+  }
+
+  if(released) m_consumed.wakeAll();
+}
+
+//-----------------------------------------------------------------
+void PrefetchInputReader::restart()
+{
+  for(auto &block: m_blocks) m_free.emplace_back(std::move(block.data));
+  m_blocks.clear();
+
+  m_base  = m_next = m_position;
+  m_error = false;
+  ++m_generation;
+
+  m_consumed.wakeAll();
+}
+
+//-----------------------------------------------------------------
+bool PrefetchInputReader::isPrefetched(long long position) const
+{
+  // the data is contiguous from the base up to the next position to be read, positions in the
+  // next block are also accepted as it will be read without a restart.
+  return position >= m_base && position < m_next + m_blockSize;
+}
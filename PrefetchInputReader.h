@@ -0,0 +1,133 @@
+/*
+ File: PrefetchInputReader.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PREFETCHINPUTREADER_H_
+#define PREFETCHINPUTREADER_H_
+
+// Project
+#include <InputReader.h>
+
+// Qt
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+
+// C++
+#include <deque>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+/** \class PrefetchInputReader
+ * \brief Reads the input file in big blocks from a background thread, keeping a number of blocks
+ *        ahead of the demuxer so it doesn't wait for the latency of slow or network storage. A seek
+ *        outside of the prefetched data restarts the read-ahead at the new position.
+ *
+ */
+class PrefetchInputReader
+: public InputReader
+{
+  public:
+    /** \brief PrefetchInputReader class constructor.
+     * \param[in] filename input file name.
+     * \param[in] blockSize size of the read blocks in bytes.
+     * \param[in] depth number of blocks to read ahead.
+     *
+     */
+    explicit PrefetchInputReader(const QString &filename, const int blockSize, const int depth);
+
+    /** \brief PrefetchInputReader class virtual destructor.
+     *
+     */
+    virtual ~PrefetchInputReader();
+
+    virtual bool open() override;
+    virtual void close() override;
+    virtual int read(unsigned char *buffer, int size) override;
+    virtual long long seek(long long offset, int whence) override;
+    virtual long long size() const override;
+    virtual long long pos() const override;
+    virtual QString errorString() const override;
+    virtual QString statistics() const override;
+
+    /** \brief Returns the number of reads served from the prefetched blocks without waiting.
+     *
+     */
+    unsigned long long hits() const;
+
+    /** \brief Returns the number of reads that had to wait for the disk.
+     *
+     */
+    unsigned long long misses() const;
+
+  private:
+    /** \struct Block
+     * \brief Block of input data.
+     *
+     */
+    struct Block
+    {
+      long long         offset; /** position of the data in the file. */
+      std::vector<char> data;   /** block data.                       */
+    };
+
+    /** \brief Reads the input blocks ahead of the current position.
+     *
+     */
+    void prefetch();
+
+    /** \brief Releases the blocks already consumed by the demuxer. Must be called with the mutex locked.
+     *
+     */
+    void release();
+
+    /** \brief Discards the prefetched blocks and restarts the read-ahead at the current position.
+     *         Must be called with the mutex locked.
+     *
+     */
+    void restart();
+
+    /** \brief Returns true if the given position is in the prefetched data or in the block being
+     *         read. Must be called with the mutex locked.
+     * \param[in] position file position.
+     *
+     */
+    bool isPrefetched(long long position) const;
+
+    QFile                           m_file;       /** input file handle, only used by the prefetch thread. */
+    const int                       m_blockSize;  /** size of the blocks in bytes.                         */
+    const int                       m_depth;      /** maximum number of prefetched blocks.                 */
+    long long                       m_size;       /** size of the file in bytes.                           */
+    long long                       m_position;   /** current position of the demuxer.                     */
+    long long                       m_base;       /** position of the first prefetched data.               */
+    long long                       m_next;       /** position of the next block to read.                  */
+    unsigned int                    m_generation; /** incremented on every restart of the read-ahead.      */
+    bool                            m_error;      /** true if a read has failed.                           */
+    bool                            m_stop;       /** true to stop the prefetch thread.                    */
+    std::deque<Block>               m_blocks;     /** prefetched blocks in file order.                     */
+    std::vector<std::vector<char>>  m_free;       /** recycled block buffers.                              */
+    mutable QMutex                  m_mutex;      /** protects the reader data.                            */
+    QWaitCondition                  m_filled;     /** signaled when a block has been read.                 */
+    QWaitCondition                  m_consumed;   /** signaled when a block has been released or restart.  */
+    std::thread                     m_thread;     /** prefetch thread.                                     */
+    std::atomic<unsigned long long> m_hits;       /** reads served from prefetched blocks.                 */
+    std::atomic<unsigned long long> m_misses;     /** reads that had to wait for the disk.                 */
+};
+
+#endif // PREFETCHINPUTREADER_H_
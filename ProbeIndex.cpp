@@ -0,0 +1,200 @@
+/*
+ File: ProbeIndex.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ProbeIndex.h>
+
+// Qt
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+// C++
+#include <algorithm>
+
+//--------------------------------------------------------------------
+ProbeIndex::ProbeIndex(const Utils::TranscoderConfiguration &config, const QString &instance)
+: m_filename {indexFilename(instance)}
+, m_signature{signature(config)}
+, m_modified {false}
+{
+}
+
+//--------------------------------------------------------------------
+bool ProbeIndex::load()
+{
+  m_entries.clear();
+  m_modified = false;
+
+  QFile file(m_filename);
+  if(!file.exists()) return true;
+  if(!file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  quint32 magic, version, count;
+  stream >> magic >> version >> count;
+  if(stream.status() != QDataStream::Ok || magic != s_magic || version != s_version) return false;
+
+  m_entries.reserve(count);
+
+  for(quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+  {
+    QString key;
+    Entry entry;
+    quint8 flags, outcome;
+    qint32 audioCodec, audioChannels, videoCodec;
+
+    stream >> key >> entry.size >> entry.modified >> entry.configuration >> flags >> audioCodec >> audioChannels >> videoCodec >> outcome;
+
+    entry.probe.valid         = (flags & 0x01) != 0;
+    entry.probe.audio         = (flags & 0x02) != 0;
+    entry.probe.video         = (flags & 0x04) != 0;
+    entry.probe.subtitle      = (flags & 0x08) != 0;
+    entry.probe.audioCodec    = audioCodec;
+    entry.probe.audioChannels = audioChannels;
+    entry.probe.videoCodec    = videoCodec;
+    entry.outcome             = static_cast<Outcome>(outcome);
+
+    m_entries.insert(key, entry);
+  }
+
+  if(stream.status() != QDataStream::Ok)
+  {
+    m_entries.clear();
+    return false;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+bool ProbeIndex::save()
+{
+  if(!m_modified) return true;
+
+  const auto &filename = m_filename;
+  QDir().mkpath(QFileInfo(filename).absolutePath());
+
+  // the index is replaced only when it has been completely written.
+  QSaveFile file(filename);
+  if(!file.open(QIODevice::WriteOnly)) return false;
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+
+  stream << s_magic << s_version << static_cast<quint32>(m_entries.size());
+
+  for(auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+  {
+    const auto &entry = it.value();
+    const quint8 flags = (entry.probe.valid ? 0x01 : 0) | (entry.probe.audio    ? 0x02 : 0) |
+                         (entry.probe.video ? 0x04 : 0) | (entry.probe.subtitle ? 0x08 : 0);
+
+    stream << it.key() << entry.size << entry.modified << entry.configuration << flags
+           << static_cast<qint32>(entry.probe.audioCodec) << static_cast<qint32>(entry.probe.audioChannels)
+           << static_cast<qint32>(entry.probe.videoCodec) << static_cast<quint8>(entry.outcome);
+  }
+
+  if(stream.status() != QDataStream::Ok || !file.commit()) return false;
+
+  m_modified = false;
+  return true;
+}
+
+//--------------------------------------------------------------------
+int ProbeIndex::filter(std::vector<std::filesystem::path> &files) const
+{
+  if(m_entries.isEmpty()) return 0;
+
+  auto isCompliant = [this](const std::filesystem::path &file)
+  {
+    const auto it = m_entries.constFind(QString::fromStdWString(std::filesystem::absolute(file).lexically_normal().wstring()));
+    if(it == m_entries.cend()) return false;
+
+    const auto &entry = it.value();
+    if(entry.configuration != m_signature || !entry.probe.valid || entry.probe.needsProcessing()) return false;
+
+    qint64 size, modified;
+    return fileStamp(file, size, modified) && size == entry.size && modified == entry.modified;
+  };
+
+  const auto end = std::remove_if(files.begin(), files.end(), isCompliant);
+  const auto removed = static_cast<int>(std::distance(end, files.end()));
+  files.erase(end, files.end());
+
+  return removed;
+}
+
+//--------------------------------------------------------------------
+void ProbeIndex::record(const std::filesystem::path &file, const ProbeResult &probe, const Outcome outcome)
+{
+  Entry entry;
+  if(!fileStamp(file, entry.size, entry.modified)) return;
+
+  entry.configuration = m_signature;
+  entry.probe         = probe;
+  entry.outcome       = outcome;
+
+  m_entries.insert(QString::fromStdWString(std::filesystem::absolute(file).lexically_normal().wstring()), entry);
+  m_modified = true;
+}
+
+//--------------------------------------------------------------------
+int ProbeIndex::size() const
+{
+  return m_entries.size();
+}
+
+//--------------------------------------------------------------------
+QString ProbeIndex::indexFilename(const QString &instance)
+{
+  return Utils::stateFilename("index", instance);
+}
+
+//--------------------------------------------------------------------
+bool ProbeIndex::fileStamp(const std::filesystem::path &file, qint64 &size, qint64 &modified)
+{
+  const QFileInfo info(QString::fromStdWString(file.wstring()));
+  if(!info.exists()) return false;
+
+  size     = info.size();
+  modified = info.lastModified().toMSecsSinceEpoch();
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+quint32 ProbeIndex::signature(const Utils::TranscoderConfiguration &config)
+{
+  const QString values = QString("%1;%2;%3;%4;%5;%6;%7;%8").arg(static_cast<int>(config.videoCodec()))
+                                                           .arg(static_cast<int>(config.audioCodec()))
+                                                           .arg(config.audioChannelsNum())
+                                                           .arg(static_cast<int>(config.preferredAudioLanguage()))
+                                                           .arg(config.extractSubtitles() ? 1 : 0)
+                                                           .arg(static_cast<int>(config.preferredSubtitleLanguage()))
+                                                           .arg(config.languages().join(','))
+                                                           .arg(config.allLanguages() ? 1 : 0);
+
+  return qHash(values);
+}
@@ -0,0 +1,145 @@
+/*
+ File: ProbeIndex.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROBEINDEX_H_
+#define PROBEINDEX_H_
+
+// Project
+#include <Utils.h>
+
+// Qt
+#include <QHash>
+#include <QString>
+
+// C++
+#include <filesystem>
+#include <vector>
+
+/** \struct ProbeResult
+ * \brief Streams of a file and the processing it needs with a configuration.
+ *
+ */
+struct ProbeResult
+{
+  bool valid         = false; /** true if the file has been probed, false otherwise. */
+  int  audioCodec    = 0;     /** libav codec id of the selected audio stream.       */
+  int  audioChannels = 0;     /** number of channels of the selected audio stream.   */
+  int  videoCodec    = 0;     /** libav codec id of the selected video stream.       */
+  bool audio         = false; /** true if the audio needs processing.                */
+  bool video         = false; /** true if the video needs processing.                */
+  bool subtitle      = false; /** true if the subtitles need processing.             */
+
+  /** \brief Returns true if the file needs any processing.
+   *
+   */
+  bool needsProcessing() const
+  { return audio || video || subtitle; }
+};
+
+/** \class ProbeIndex
+ * \brief Stores on disk the probe results of the files, identified by path, size and modification time,
+ *        so the unchanged files that don't need processing are skipped without opening them again.
+ *
+ */
+class ProbeIndex
+{
+  public:
+    enum class Outcome: quint8 { NONE = 0, NOT_PROCESSED, TRANSCODED, FAILED }; /** last outcome of a file. */
+
+    /** \brief ProbeIndex class constructor.
+     * \param[in] config Application configuration reference.
+     * \param[in] instance Name of the instance using the index, empty for the default one.
+     *
+     */
+    explicit ProbeIndex(const Utils::TranscoderConfiguration &config, const QString &instance = QString());
+
+    /** \brief Loads the index from disk. Returns true on success and false otherwise.
+     *
+     */
+    bool load();
+
+    /** \brief Saves the index to disk if it has been modified. Returns true on success and false otherwise.
+     *
+     */
+    bool save();
+
+    /** \brief Removes from the list the files that haven't changed since they were probed with
+     *         the current configuration and don't need processing. Returns the number of files removed.
+     * \param[inout] files list of files.
+     *
+     */
+    int filter(std::vector<std::filesystem::path> &files) const;
+
+    /** \brief Stores the probe result and the outcome of a file.
+     * \param[in] file file path.
+     * \param[in] probe probe result of the file.
+     * \param[in] outcome outcome of the processing.
+     *
+     */
+    void record(const std::filesystem::path &file, const ProbeResult &probe, const Outcome outcome);
+
+    /** \brief Returns the number of files in the index.
+     *
+     */
+    int size() const;
+
+    /** \brief Returns the path of the index file.
+     * \param[in] instance name of the instance using the index, empty for the default one.
+     *
+     */
+    static QString indexFilename(const QString &instance = QString());
+
+  private:
+    /** \struct Entry
+     * \brief Index data of a file.
+     *
+     */
+    struct Entry
+    {
+      qint64      size;          /** size of the file in bytes.                            */
+      qint64      modified;      /** modification time of the file in ms since epoch.     */
+      quint32     configuration; /** signature of the configuration used for the verdict. */
+      ProbeResult probe;         /** probe result.                                         */
+      Outcome     outcome;       /** last outcome.                                         */
+    };
+
+    /** \brief Gets the size and modification time of the file. Returns true on success and false otherwise.
+     * \param[in] file file path.
+     * \param[out] size size of the file in bytes.
+     * \param[out] modified modification time in ms since epoch.
+     *
+     */
+    static bool fileStamp(const std::filesystem::path &file, qint64 &size, qint64 &modified);
+
+    /** \brief Returns the signature of the configuration values that affect the processing decision.
+     * \param[in] config configuration object.
+     *
+     */
+    static quint32 signature(const Utils::TranscoderConfiguration &config);
+
+    const QString         m_filename;  /** path of the index file.                          */
+    QHash<QString, Entry> m_entries;   /** index entries keyed by file path.                */
+    const quint32         m_signature; /** signature of the current configuration.          */
+    bool                  m_modified;  /** true if the index has changed since loaded/saved. */
+
+    static const quint32 s_magic   = 0x56545049; /** index file identifier. */
+    static const quint32 s_version = 1;          /** index file version.    */
+};
+
+#endif // PROBEINDEX_H_
@@ -19,6 +19,8 @@
 
 // Project
 #include <ProcessDialog.h>
+#include <Scheduler.h>
+#include <FileDiscovery.h>
 #include <Worker.h>
 
 // C++
@@ -27,21 +29,39 @@
 // Qt
 #include <QEvent>
 #include <QKeyEvent>
+
+#ifdef Q_OS_WIN
 #include <QtWinExtras/QWinTaskbarProgress>
+#endif
 
 //--------------------------------------------------------------------
-ProcessDialog::ProcessDialog(const std::vector<std::filesystem::path> &files, const Utils::TranscoderConfiguration& config, QWidget* parent, Qt::WindowFlags flags)
+ProcessDialog::ProcessDialog(const std::filesystem::path &directory, const Utils::TranscoderConfiguration& config, QWidget* parent, Qt::WindowFlags flags)
 : QDialog        (parent, flags)
-, m_files        (files)
-, m_num_workers  {0}
+, m_scheduler    {nullptr}
+, m_discovery    {nullptr}
 , m_configuration{config}
 , m_errorsCount  {0}
-, m_finished_transcoding{false}
+#ifdef Q_OS_WIN
 , m_taskBarButton{nullptr}
+#endif
 {
   setupUi(this);
 
-  register_av_lock_manager();
+  // the jobs start while the directory is still being searched.
+  m_scheduler = new Scheduler(std::vector<std::filesystem::path>(), m_configuration, this);
+  m_scheduler->setIntakeOpen(true);
+
+  m_discovery = new FileDiscovery(directory, Utils::SearchFilter(), this);
+
+  connect(m_discovery, SIGNAL(files_found()), this, SLOT(on_files_found()));
+  connect(m_discovery, SIGNAL(finished()),    this, SLOT(on_discovery_finished()));
+
+  connect(m_scheduler, SIGNAL(worker_started(Worker *, const QString &)), this, SLOT(on_worker_started(Worker *, const QString &)));
+  connect(m_scheduler, SIGNAL(worker_finished(Worker *)),                 this, SLOT(increment_global_progress(Worker *)));
+  connect(m_scheduler, SIGNAL(error_message(const QString &)),            this, SLOT(log_error(const QString &)));
+  connect(m_scheduler, SIGNAL(information_message(const QString &)),      this, SLOT(log_information(const QString &)));
+  connect(m_scheduler, SIGNAL(finished()),                                this, SLOT(on_scheduler_finished()));
+  connect(m_scheduler, SIGNAL(jobs_count_changed(int)),                   this, SLOT(on_jobs_count_changed(int)));
 
   connect(m_cancelButton, SIGNAL(clicked()), this, SLOT(stop()));
   connect(m_clipboard,    SIGNAL(pressed()), this, SLOT(onClipboardPressed()));
@@ -50,42 +70,25 @@ ProcessDialog::ProcessDialog(const std::vector<std::filesystem::path> &files, co
 
   m_log->setContextMenuPolicy(Qt::ContextMenuPolicy::NoContextMenu);
 
-  const auto max_workers = m_configuration.numberOfThreads();
-  int total_jobs = m_files.size();
-
+  // busy indicator until the first files are found, the bars are created as the workers start.
   m_globalProgress->setMinimum(0);
-  m_globalProgress->setMaximum(total_jobs);
+  m_globalProgress->setMaximum(0);
 
-  auto boxLayout = new QVBoxLayout();
-  m_workers->setLayout(boxLayout);
+  m_workers->setLayout(new QVBoxLayout());
 
-  auto initial_jobs = std::min(total_jobs, max_workers);
+  log_information(tr("Searching '%1' for video files.").arg(QString::fromStdWString(directory.wstring())));
 
-  for(int i = 0; i < initial_jobs; ++i)
-  {
-    auto bar = new QProgressBar();
-    bar->setAlignment(Qt::AlignCenter);
-    bar->setMaximum(0);
-    bar->setMaximum(100);
-    bar->setValue(0);
-    bar->setEnabled(false);
-
-    m_progress_bars[bar] = nullptr;
-
-    boxLayout->addWidget(bar);
-  }
-
-  m_finished_transcoding = (files.size() == 0);
-
-  create_threads();
+  m_scheduler->start();
+  m_discovery->start();
 }
 
 //--------------------------------------------------------------------
 ProcessDialog::~ProcessDialog()
 {
   m_progress_bars.clear();
-  m_taskBarButton->deleteLater();
-  unregister_av_lock_manager();
+#ifdef Q_OS_WIN
+  if(m_taskBarButton) m_taskBarButton->deleteLater();
+#endif
 }
 
 //-----------------------------------------------------------------
@@ -93,11 +96,6 @@ void ProcessDialog::closeEvent(QCloseEvent *e)
 {
   stop();
 
-  for(auto worker: m_progress_bars.values())
-  {
-    delete worker;
-  }
-
   m_progress_bars.clear();
 
   QDialog::closeEvent(e);
@@ -130,40 +128,36 @@ void ProcessDialog::stop()
 {
   disconnect(m_cancelButton, SIGNAL(clicked()), this, SLOT(stop()));
 
-  for(auto worker: m_progress_bars.values())
-  {
-    if(worker != nullptr)
-    {
-      worker->stop();
-      worker->wait();
-    }
-  }
+  m_discovery->stop();
+  m_scheduler->stop();
 
   m_cancelButton->setText(tr("Exit"));
   connect(m_cancelButton, SIGNAL(clicked()), this, SLOT(close()));
 }
 
 //-----------------------------------------------------------------
-void ProcessDialog::increment_global_progress()
+void ProcessDialog::on_worker_started(Worker *worker, const QString &name)
 {
-  m_mutex.lock();
+  const auto node = worker->numa_node();
+  assign_bar_to_worker(worker, node < 0 ? name : tr("[node %1] %2").arg(node).arg(name));
 
-  auto worker = qobject_cast<Worker *>(sender());
-  Q_ASSERT(worker);
+  update_nodes_occupancy();
+}
 
-  disconnect(worker, SIGNAL(error_message(const QString &)),       this, SLOT(log_error(const QString &)));
-  disconnect(worker, SIGNAL(information_message(const QString &)), this, SLOT(log_information(const QString &)));
-  disconnect(worker, SIGNAL(finished()),                           this, SLOT(increment_global_progress()));
+//-----------------------------------------------------------------
+void ProcessDialog::increment_global_progress(Worker *worker)
+{
+  QMutexLocker lock(&m_mutex);
 
   if(!worker->has_been_cancelled())
   {
     auto value = m_globalProgress->value();
     m_globalProgress->setValue(++value);
-    m_taskBarButton->progress()->setValue(value);
+#ifdef Q_OS_WIN
+    if(m_taskBarButton) m_taskBarButton->progress()->setValue(value);
+#endif
   }
 
-  --m_num_workers;
-
   auto bar = m_progress_bars.key(worker);
   Q_ASSERT(bar);
 
@@ -175,68 +169,75 @@ void ProcessDialog::increment_global_progress()
   bar->setFormat("Idle");
   bar->setToolTip(tr("Idle, waiting for work."));
 
-  const auto cancelled = worker->has_been_cancelled();
-  delete worker;
+  update_nodes_occupancy();
+}
 
-  if((m_globalProgress->maximum() == m_globalProgress->value()) || cancelled)
-  {
-    disconnect(m_cancelButton, SIGNAL(clicked()),
-               this,           SLOT(stop()));
+//-----------------------------------------------------------------
+void ProcessDialog::on_files_found()
+{
+  std::vector<std::filesystem::path> files;
+  if(m_discovery->take(files)) m_scheduler->enqueue(std::move(files));
+}
 
-    connect(m_cancelButton,    SIGNAL(clicked()),
-            this,              SLOT(exit_dialog()));
+//-----------------------------------------------------------------
+void ProcessDialog::on_discovery_finished()
+{
+  // the last batch can arrive after the end of the search.
+  on_files_found();
 
-    m_cancelButton->setText("Exit");
-    m_clipboard->setEnabled(true);
+  if(m_discovery->foundCount() == 0 && !m_scheduler->hasBeenCancelled())
+  {
+    log_error(tr("Can't find any video file in the specified folder that can be processed."));
   }
-
-  if(m_files.empty() && m_num_workers == 0)
+  else
   {
-    m_finished_transcoding = true;
+    log_information(tr("Found %1 video files.").arg(m_discovery->foundCount()));
   }
 
-  m_mutex.unlock();
+  // no more busy indicator if nothing has been queued.
+  if(m_globalProgress->maximum() == 0) on_jobs_count_changed(1);
 
-  if(!cancelled && !m_finished_transcoding)
-  {
-    create_threads();
-  }
+  m_scheduler->setIntakeOpen(false);
 }
 
 //-----------------------------------------------------------------
-void ProcessDialog::create_threads()
+void ProcessDialog::on_jobs_count_changed(int count)
 {
   QMutexLocker lock(&m_mutex);
 
-  while(m_num_workers < m_configuration.numberOfThreads() && m_files.size() > 0)
-  {
-    create_transcoder();
-  }
+  m_globalProgress->setMaximum(count);
+#ifdef Q_OS_WIN
+  if(m_taskBarButton) m_taskBarButton->progress()->setMaximum(count);
+#endif
 }
 
 //-----------------------------------------------------------------
-void ProcessDialog::create_transcoder()
+void ProcessDialog::update_nodes_occupancy()
 {
-  const std::filesystem::path filename = m_files.front();
-  m_files.erase(m_files.cbegin());
+  const auto occupancy = m_scheduler->nodesOccupancy();
 
-  ++m_num_workers;
+  m_workers->setTitle(occupancy.isEmpty() ? tr("Transcoders' Progress") : tr("Transcoders' Progress (%1)").arg(occupancy));
+}
 
-  auto worker = new Worker(filename, m_configuration);
+//-----------------------------------------------------------------
+void ProcessDialog::on_scheduler_finished()
+{
+  disconnect(m_cancelButton, SIGNAL(clicked()),
+             this,           SLOT(stop()));
 
-  const auto message = QString::fromStdWString(filename.filename().wstring());
-  assign_bar_to_worker(worker, message);
+  disconnect(m_cancelButton, SIGNAL(clicked()),
+             this,           SLOT(close()));
 
-  worker->start();
+  connect(m_cancelButton,    SIGNAL(clicked()),
+          this,              SLOT(exit_dialog()));
+
+  m_cancelButton->setText("Exit");
+  m_clipboard->setEnabled(true);
 }
 
 //-----------------------------------------------------------------
 void ProcessDialog::assign_bar_to_worker(Worker* worker, const QString& message)
 {
-  connect(worker, SIGNAL(error_message(const QString &)),       this, SLOT(log_error(const QString &)));
-  connect(worker, SIGNAL(information_message(const QString &)), this, SLOT(log_information(const QString &)));
-  connect(worker, SIGNAL(finished()),                           this, SLOT(increment_global_progress()));
-
   for(auto bar: m_progress_bars.keys())
   {
     if(m_progress_bars[bar] == nullptr)
@@ -249,9 +250,28 @@ void ProcessDialog::assign_bar_to_worker(Worker* worker, const QString& message)
 
       connect(worker, SIGNAL(progress(int)), bar, SLOT(setValue(int)));
 
-      break;
+      return;
     }
   }
+
+  // the automatic concurrency can run more workers than the initial bars.
+  create_progress_bar();
+  assign_bar_to_worker(worker, message);
+}
+
+//-----------------------------------------------------------------
+void ProcessDialog::create_progress_bar()
+{
+  auto bar = new QProgressBar();
+  bar->setAlignment(Qt::AlignCenter);
+  bar->setMaximum(0);
+  bar->setMaximum(100);
+  bar->setValue(0);
+  bar->setEnabled(false);
+
+  m_progress_bars[bar] = nullptr;
+
+  m_workers->layout()->addWidget(bar);
 }
 
 //-----------------------------------------------------------------
@@ -278,43 +298,6 @@ bool ProcessDialog::event(QEvent *e)
   return QDialog::event(e);
 }
 
-//-----------------------------------------------------------------
-int ProcessDialog::lock_manager(void **mutex, AVLockOp operation)
-{
-  QMutex *passed_mutex;
-  switch (operation)
-  {
-    case AV_LOCK_CREATE:
-      *mutex = new QMutex();
-      return 0;
-    case AV_LOCK_OBTAIN:
-      passed_mutex = reinterpret_cast<QMutex *>(*mutex);
-      passed_mutex->lock();
-      return 0;
-    case AV_LOCK_RELEASE:
-      passed_mutex = reinterpret_cast<QMutex *>(*mutex);
-      passed_mutex->unlock();
-      return 0;
-    case AV_LOCK_DESTROY:
-      passed_mutex = reinterpret_cast<QMutex *>(*mutex);
-      delete passed_mutex;
-      return 0;
-  }
-  return 1;
-}
-
-//-----------------------------------------------------------------
-void ProcessDialog::register_av_lock_manager()
-{
-  av_lockmgr_register(ProcessDialog::lock_manager);
-}
-
-//-----------------------------------------------------------------
-void ProcessDialog::unregister_av_lock_manager()
-{
-  av_lockmgr_register(nullptr);
-}
-
 //-----------------------------------------------------------------
 void ProcessDialog::exit_dialog()
 {
@@ -326,9 +309,11 @@ void ProcessDialog::showEvent(QShowEvent *e)
 {
   QDialog::showEvent(e);
 
+#ifdef Q_OS_WIN
   m_taskBarButton = new QWinTaskbarButton(this);
   m_taskBarButton->setWindow(this->windowHandle());
   m_taskBarButton->progress()->setRange(m_globalProgress->minimum(), m_globalProgress->maximum());
   m_taskBarButton->progress()->setVisible(true);
   m_taskBarButton->progress()->setValue(0);
+#endif
 }
@@ -27,15 +27,14 @@
 // Qt
 #include <QDialog>
 #include <QFileInfo>
-#include <QtWinExtras/QWinTaskbarButton>
 
-// libav
-extern "C"
-{
-#include <libavcodec/avcodec.h>
-}
+#ifdef Q_OS_WIN
+#include <QtWinExtras/QWinTaskbarButton>
+#endif
 
 class Worker;
+class Scheduler;
+class FileDiscovery;
 
 /** \class ProcessDialog
  * \brief Dialog that starts the transcoding workers and reports progress and information.
@@ -47,13 +46,15 @@ class ProcessDialog
 {
     Q_OBJECT
   public:
-    /** \brief ProcessDialog class constructor.
-     * \param[in] files List of files to be transcoded.
+    /** \brief ProcessDialog class constructor. The video files of the directory are transcoded while
+     *         it's searched.
+     * \param[in] directory Directory tree with the files to be transcoded.
+     * \param[in] config Application configuration reference.
      * \param[in] parent Raw pointer of the widget parent of this one.
      * \param[in] flags Window flags.
      *
      */
-    explicit ProcessDialog(const std::vector<std::filesystem::path> &files,
+    explicit ProcessDialog(const std::filesystem::path &directory,
                            const Utils::TranscoderConfiguration &config,
                            QWidget *parent = nullptr,
                            Qt::WindowFlags flags = Qt::WindowFlags());
@@ -87,33 +88,52 @@ class ProcessDialog
      */
     void log_information(const QString &message);
 
-    /** \brief When completed a worker increments the counter of completely processed files,
-     *         updates the GUI and launches the next worker thread.
+    /** \brief Assigns a free progress bar to the launched worker.
+     * \param[in] worker Worker raw pointer.
+     * \param[in] name Name of the processed file.
      *
      */
-    void increment_global_progress();
+    void on_worker_started(Worker *worker, const QString &name);
 
-    /** \brief Closes the dialog.
+    /** \brief When completed a worker increments the counter of completely processed files and
+     *         updates the GUI.
+     * \param[in] worker Worker raw pointer.
      *
      */
-    void exit_dialog();
+    void increment_global_progress(Worker *worker);
 
-    /** \brief Copies the contents of the log to the clipboard.
+    /** \brief Updates the GUI when all the workers have finished.
      *
      */
-    void onClipboardPressed() const;
+    void on_scheduler_finished();
 
-  private:
-    /** \brief Creates and launches the workers' threads.
+    /** \brief Gives the files found by the search to the scheduler.
+     *
+     */
+    void on_files_found();
+
+    /** \brief Closes the intake of the scheduler when the search has finished.
      *
      */
-    void create_threads();
+    void on_discovery_finished();
 
-    /** \brief Creates and launches the transcoders threads.
+    /** \brief Updates the maximum of the global progress with the jobs found.
+     * \param[in] count total number of jobs.
      *
      */
-    void create_transcoder();
+    void on_jobs_count_changed(int count);
 
+    /** \brief Closes the dialog.
+     *
+     */
+    void exit_dialog();
+
+    /** \brief Copies the contents of the log to the clipboard.
+     *
+     */
+    void onClipboardPressed() const;
+
+  private:
     /** \brief Assigns a worker thread to the bar that will show it's progress.
      * \param[in] worker worker pointer to assign.
      * \param[in] message message to show in the bar.
@@ -121,32 +141,25 @@ class ProcessDialog
      */
     void assign_bar_to_worker(Worker *worker, const QString &message);
 
-    /** \brief Registers the lock manager for the libav library.
-     *
-     */
-    void register_av_lock_manager();
-
-    /** \brief Unregisters the lock manager for the libav library.
+    /** \brief Creates an idle progress bar and adds it to the workers' layout.
      *
      */
-    void unregister_av_lock_manager();
+    void create_progress_bar();
 
-    /** \brief Lock manager that complies with the specifications required
-     *         by libav. Needed for concurrent file transcoding.
-     *  \param[inout] mutex custom mutex object (QMutex in this case).
-     *  \param[in] op manager operation to perform.
+    /** \brief Shows the number of jobs running in each NUMA node, if the workers are pinned.
      *
      */
-    static int lock_manager(void **mutex, enum AVLockOp op);
+    void update_nodes_occupancy();
 
-    std::vector<std::filesystem::path>    m_files;                /** list of file informations.                 */
-    int                                   m_num_workers;          /** current number of simultaneous threads.    */
+    Scheduler                            *m_scheduler;            /** launches the workers.                      */
+    FileDiscovery                        *m_discovery;            /** searches the files in the background.      */
     const Utils::TranscoderConfiguration &m_configuration;        /** application configuration struct.          */
     int                                   m_errorsCount;          /** number of errors that have ocurred.        */
-    bool                                  m_finished_transcoding; /** true if process finished, false otherwise. */
     QMutex                                m_mutex;                /** protects internal data and writes to log.  */
     QMap<QProgressBar *, Worker *>        m_progress_bars;        /** maps worker<->progress bar.                */
+#ifdef Q_OS_WIN
     QWinTaskbarButton                    *m_taskBarButton;        /** taskbar progress widget.                   */
+#endif
 };
 
 #endif // PROCESSDIALOG_H_
@@ -0,0 +1,55 @@
+/*
+ File: RateLimiter.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <RateLimiter.h>
+
+// Qt
+#include <QMutexLocker>
+
+// C++
+#include <algorithm>
+
+//--------------------------------------------------------------------
+RateLimiter::RateLimiter(const double rate)
+: m_rate{std::max(0., rate)}
+, m_next{0}
+{
+  m_clock.start();
+}
+
+//--------------------------------------------------------------------
+bool RateLimiter::isEnabled() const
+{
+  return m_rate > 0;
+}
+
+//--------------------------------------------------------------------
+long long RateLimiter::reserve(const double amount)
+{
+  if(m_rate <= 0 || amount <= 0) return 0;
+
+  QMutexLocker lock(&m_mutex);
+
+  // the time not used while idle is credited up to the burst.
+  const auto now = m_clock.nsecsElapsed() / 1e9;
+  m_next = std::max(m_next, now - s_burst) + amount / m_rate;
+
+  return std::max(0LL, static_cast<long long>((m_next - now) * 1e6));
+}
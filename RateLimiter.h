@@ -0,0 +1,62 @@
+/*
+ File: RateLimiter.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RATELIMITER_H_
+#define RATELIMITER_H_
+
+// Qt
+#include <QElapsedTimer>
+#include <QMutex>
+
+/** \class RateLimiter
+ * \brief Limits the rate of a quantity (frames, bytes) processed by several workers to a maximum per
+ *        second, allowing short bursts. The workers reserve the quantity they process and wait the returned
+ *        time before going on. Thread safe.
+ *
+ */
+class RateLimiter
+{
+  public:
+    /** \brief RateLimiter class constructor.
+     * \param[in] rate maximum quantity per second, 0 for unlimited.
+     *
+     */
+    explicit RateLimiter(const double rate);
+
+    /** \brief Returns true if the rate is limited and false otherwise.
+     *
+     */
+    bool isEnabled() const;
+
+    /** \brief Reserves a quantity and returns the microseconds the caller must wait before processing it.
+     * \param[in] amount quantity to process.
+     *
+     */
+    long long reserve(const double amount);
+
+  private:
+    const double   m_rate;  /** maximum quantity per second, 0 for unlimited. */
+    double         m_next;  /** time in seconds when the reservations end.    */
+    QElapsedTimer  m_clock; /** time reference.                               */
+    mutable QMutex m_mutex; /** protects the limiter data.                    */
+
+    static constexpr double s_burst = 0.5; /** seconds of quantity that can be processed without waiting. */
+};
+
+#endif // RATELIMITER_H_
@@ -0,0 +1,525 @@
+/*
+ File: Scheduler.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <Scheduler.h>
+#include <Worker.h>
+#include <ExecutionPolicy.h>
+
+// Qt
+#include <QMutex>
+
+// C++
+#include <thread>
+
+//--------------------------------------------------------------------
+Scheduler::Scheduler(const std::vector<std::filesystem::path> &files, const Utils::TranscoderConfiguration &config, QObject *parent)
+: Scheduler(files, config, QString(), parent)
+{
+}
+
+//--------------------------------------------------------------------
+Scheduler::Scheduler(const std::vector<std::filesystem::path> &files, const Utils::TranscoderConfiguration &config, const QString &instance, QObject *parent)
+: QObject         {parent}
+, m_instance      {instance}
+, m_jobs          {config.jobOrder()}
+, m_configuration {config}
+, m_total_jobs    {0}
+, m_finished_jobs {0}
+, m_skipped_jobs  {0}
+, m_index         {nullptr}
+, m_resumed_jobs  {0}
+, m_journal       {nullptr}
+, m_budget        {config.threadBudget()}
+, m_placement     {config.numaPlacement()}
+, m_frame_limiter {static_cast<double>(config.frameRateLimit())}
+, m_byte_limiter  {config.readRateLimit() * 1024. * 1024.}
+, m_memory        {config.memoryBudget()}
+, m_controller    {nullptr}
+, m_sample_frames {0}
+, m_done_frames   {0}
+, m_started       {false}
+, m_intake_open   {false}
+, m_cancelled     {false}
+, m_finished      {false}
+{
+  register_av_lock_manager();
+
+  if(m_configuration.useProbeIndex())
+  {
+    m_index = std::make_unique<ProbeIndex>(m_configuration, m_instance);
+    m_index->load();
+  }
+
+  if(m_configuration.useJobJournal())
+  {
+    m_journal = std::make_unique<JobJournal>(m_instance);
+    if(!m_journal->open()) m_journal = nullptr;
+  }
+
+  auto pending = files;
+  queue(pending);
+
+  m_finished = m_jobs.empty();
+
+  if(m_memory.isEnabled())
+  {
+    m_memory_timer.setInterval(s_memory_interval);
+    connect(&m_memory_timer, SIGNAL(timeout()), this, SLOT(on_memory_timeout()));
+  }
+
+  if(m_configuration.numberOfThreads() == 0)
+  {
+    m_controller = std::make_unique<ConcurrencyController>(static_cast<int>(std::thread::hardware_concurrency()));
+
+    m_sample_timer.setInterval(s_sample_interval);
+    connect(&m_sample_timer, SIGNAL(timeout()), this, SLOT(on_sample_timeout()));
+  }
+}
+
+//--------------------------------------------------------------------
+Scheduler::~Scheduler()
+{
+  for(auto worker: m_workers)
+  {
+    worker->disconnect(this);
+    worker->stop();
+    worker->wait();
+
+    // the stopped workers remove their outputs.
+    if(m_journal) m_journal->record(worker->source_path(), JobJournal::State::QUEUED);
+
+    delete worker;
+  }
+
+  m_workers.clear();
+
+  save_index();
+
+  unregister_av_lock_manager();
+}
+
+//--------------------------------------------------------------------
+void Scheduler::start()
+{
+  m_started = true;
+
+  if(m_configuration.useJobJournal() && !m_journal)
+  {
+    emit error_message(tr("Unable to open the job journal '%1', the batch can't be resumed if interrupted.").arg(JobJournal::journalFilename(m_instance)));
+  }
+
+  report_skipped();
+
+  for(const auto &file: m_cleaned_files)
+  {
+    emit information_message(tr("Removed partial output file '%1' of an interrupted job.").arg(file));
+  }
+
+  if(m_finished)
+  {
+    emit finished();
+    return;
+  }
+
+  if(m_configuration.executionClass() != Utils::TranscoderConfiguration::ExecutionClass::NORMAL)
+  {
+    emit information_message(tr("Running the jobs in the '%1' execution class.").arg(ExecutionPolicy::name(m_configuration.executionClass())));
+  }
+
+  if(m_frame_limiter.isEnabled() || m_byte_limiter.isEnabled())
+  {
+    QStringList limits;
+    if(m_frame_limiter.isEnabled()) limits << tr("%1 frames/s").arg(m_configuration.frameRateLimit());
+    if(m_byte_limiter.isEnabled())  limits << tr("%1 MB/s read").arg(m_configuration.readRateLimit());
+
+    emit information_message(tr("Throughput of all the jobs limited to %1.").arg(limits.join(tr(" and "))));
+  }
+
+  if(m_placement.isEnabled())
+  {
+    emit information_message(tr("Placing the jobs in %1 NUMA nodes.").arg(m_placement.nodesCount()));
+  }
+  else if(m_configuration.numaPlacement())
+  {
+    emit information_message(tr("Only one NUMA node available, the jobs won't be pinned."));
+  }
+
+  if(m_memory.isEnabled())
+  {
+    emit information_message(tr("Jobs admitted while their estimated memory fits in %1 MB.").arg(m_configuration.memoryBudget()));
+    m_memory_timer.start();
+  }
+
+  if(m_controller)
+  {
+    emit information_message(tr("Automatic concurrency, starting with %1 simultaneous jobs.").arg(m_controller->concurrency()));
+
+    m_sample_clock.start();
+    m_sample_timer.start();
+  }
+
+  create_threads();
+}
+
+//--------------------------------------------------------------------
+bool Scheduler::enqueue(const std::filesystem::path &file, const bool replace)
+{
+  const auto key = QString::fromStdWString(file.wstring());
+  if(replace) m_replace.insert(key);
+
+  const auto added = enqueue(std::vector<std::filesystem::path>{file}) > 0;
+  if(replace && !added) m_replace.remove(key);
+
+  return added;
+}
+
+//--------------------------------------------------------------------
+int Scheduler::enqueue(std::vector<std::filesystem::path> files)
+{
+  if(m_cancelled) return 0;
+
+  const auto cleaned = m_cleaned_files.size();
+
+  queue(files);
+
+  // the removals before the start are reported by start().
+  for(auto i = cleaned; m_started && i < m_cleaned_files.size(); ++i)
+  {
+    emit information_message(tr("Removed partial output file '%1' of an interrupted job.").arg(m_cleaned_files.at(i)));
+  }
+
+  if(files.empty()) return 0;
+
+  emit jobs_count_changed(m_total_jobs);
+
+  if(m_started) create_threads();
+
+  return static_cast<int>(files.size());
+}
+
+//--------------------------------------------------------------------
+void Scheduler::setIntakeOpen(const bool open)
+{
+  m_intake_open = open;
+
+  if(open)
+  {
+    m_finished = m_cancelled;
+  }
+  else if(m_started)
+  {
+    // the files enqueued since the start.
+    report_skipped();
+    finish_if_idle();
+  }
+}
+
+//--------------------------------------------------------------------
+int Scheduler::jobsCount() const
+{
+  return m_total_jobs;
+}
+
+//--------------------------------------------------------------------
+int Scheduler::finishedJobsCount() const
+{
+  return m_finished_jobs;
+}
+
+//--------------------------------------------------------------------
+int Scheduler::skippedJobsCount() const
+{
+  return m_skipped_jobs;
+}
+
+//--------------------------------------------------------------------
+int Scheduler::resumedJobsCount() const
+{
+  return m_resumed_jobs;
+}
+
+//--------------------------------------------------------------------
+int Scheduler::maximumWorkers() const
+{
+  if(m_controller) return m_controller->concurrency();
+
+  return std::max(1, m_configuration.numberOfThreads());
+}
+
+//--------------------------------------------------------------------
+QString Scheduler::nodesOccupancy() const
+{
+  return m_placement.occupancy();
+}
+
+//--------------------------------------------------------------------
+bool Scheduler::isFinished() const
+{
+  return m_finished;
+}
+
+//--------------------------------------------------------------------
+bool Scheduler::hasBeenCancelled() const
+{
+  return m_cancelled;
+}
+
+//--------------------------------------------------------------------
+void Scheduler::stop()
+{
+  if(m_cancelled) return;
+
+  m_cancelled = true;
+  m_sample_timer.stop();
+  m_memory_timer.stop();
+
+  for(auto worker: m_workers)
+  {
+    worker->stop();
+    worker->wait();
+  }
+
+  finish_if_idle();
+}
+
+//--------------------------------------------------------------------
+void Scheduler::on_worker_finished()
+{
+  auto worker = qobject_cast<Worker *>(sender());
+  Q_ASSERT(worker);
+
+  worker->disconnect(this);
+  m_workers.removeOne(worker);
+  m_done_frames += worker->frames_count();
+  m_placement.release(worker->numa_node());
+
+  const auto reason = m_last_errors.take(worker);
+
+  if(m_journal)
+  {
+    auto state = JobJournal::State::DONE;
+    if(worker->has_been_cancelled()) state = JobJournal::State::QUEUED;
+    else if(worker->has_failed())    state = JobJournal::State::FAILED;
+
+    m_journal->record(worker->source_path(), state, state == JobJournal::State::FAILED ? reason : QString());
+  }
+
+  if(!worker->has_been_cancelled())
+  {
+    ++m_finished_jobs;
+
+    if(m_index)
+    {
+      const auto &probe = worker->probe_result();
+
+      auto outcome = ProbeIndex::Outcome::TRANSCODED;
+      if(worker->has_failed())               outcome = ProbeIndex::Outcome::FAILED;
+      else if(!probe.needsProcessing())      outcome = ProbeIndex::Outcome::NOT_PROCESSED;
+
+      m_index->record(worker->source_path(), probe, outcome);
+    }
+  }
+
+  emit worker_finished(worker);
+
+  delete worker;
+
+  if(!m_cancelled)
+  {
+    create_threads();
+  }
+
+  finish_if_idle();
+}
+
+//--------------------------------------------------------------------
+void Scheduler::on_sample_timeout()
+{
+  if(!m_controller || m_cancelled || m_finished) return;
+
+  long long frames = m_done_frames;
+  for(auto worker: m_workers) frames += worker->frames_count();
+
+  const auto elapsed = m_sample_clock.restart();
+  const auto framesPerSecond = (frames - m_sample_frames) * 1000.0 / std::max(1LL, static_cast<long long>(elapsed));
+  m_sample_frames = frames;
+
+  // no decisions once there are no jobs left to launch.
+  if(m_jobs.empty()) return;
+
+  emit information_message(m_controller->update(framesPerSecond));
+
+  // the running workers above the new target finish their files, only the new ones wait.
+  create_threads();
+}
+
+//--------------------------------------------------------------------
+void Scheduler::on_memory_timeout()
+{
+  m_memory.sample();
+}
+
+//--------------------------------------------------------------------
+void Scheduler::on_worker_error(const QString &message)
+{
+  auto worker = qobject_cast<Worker *>(sender());
+  if(worker) m_last_errors[worker] = message;
+}
+
+//--------------------------------------------------------------------
+void Scheduler::on_worker_outputs(const QString &source, const QStringList &files)
+{
+  if(m_journal) m_journal->recordOutputs(std::filesystem::path(source.toStdWString()), files);
+}
+
+//--------------------------------------------------------------------
+void Scheduler::queue(std::vector<std::filesystem::path> &files)
+{
+  if(m_index) m_skipped_jobs += m_index->filter(files);
+
+  if(m_journal)
+  {
+    std::vector<std::filesystem::path> replaced;
+    m_resumed_jobs += m_journal->resume(files, m_cleaned_files, replaced);
+
+    for(const auto &file: replaced) m_replace.insert(QString::fromStdWString(file.wstring()));
+    m_journal->recordQueued(files);
+  }
+
+  m_jobs.push(files);
+
+  m_total_jobs += static_cast<int>(files.size());
+}
+
+//--------------------------------------------------------------------
+void Scheduler::report_skipped()
+{
+  if(m_skipped_jobs > 0)
+  {
+    emit information_message(tr("Skipped %1 unchanged files that are already in the correct format for Chromecast.").arg(m_skipped_jobs));
+  }
+
+  if(m_resumed_jobs > 0)
+  {
+    emit information_message(tr("Skipped %1 files finished in a previous run.").arg(m_resumed_jobs));
+  }
+}
+
+//--------------------------------------------------------------------
+void Scheduler::finish_if_idle()
+{
+  if(m_finished || !m_workers.isEmpty()) return;
+
+  // an open intake can still receive jobs.
+  if(!m_cancelled && (m_intake_open || !m_jobs.empty())) return;
+
+  m_sample_timer.stop();
+  m_memory_timer.stop();
+  save_index();
+
+  m_finished = true;
+  emit finished();
+}
+
+//--------------------------------------------------------------------
+void Scheduler::save_index()
+{
+  if(m_index && !m_index->save())
+  {
+    emit error_message(tr("Unable to save the probe index '%1'.").arg(ProbeIndex::indexFilename(m_instance)));
+  }
+}
+
+//--------------------------------------------------------------------
+void Scheduler::create_threads()
+{
+  // the cores not used by the finished jobs go to the last ones.
+  m_budget.setConcurrency(std::min(maximumWorkers(), m_workers.size() + static_cast<int>(m_jobs.size())));
+
+  while(m_workers.size() < maximumWorkers() && !m_jobs.empty())
+  {
+    create_transcoder();
+  }
+}
+
+//--------------------------------------------------------------------
+void Scheduler::create_transcoder()
+{
+  std::filesystem::path filename;
+  if(!m_jobs.pop(filename)) return;
+
+  if(m_journal) m_journal->record(filename, JobJournal::State::RUNNING);
+
+  auto worker = new Worker(filename, m_configuration, &m_budget);
+  worker->set_placement(&m_placement, m_placement.acquire());
+  worker->set_rate_limits(&m_frame_limiter, &m_byte_limiter);
+  worker->set_memory_budget(&m_memory);
+  worker->set_replace_outputs(m_replace.remove(QString::fromStdWString(filename.wstring())));
+  m_workers << worker;
+
+  connect(worker, SIGNAL(error_message(const QString &)),       this, SIGNAL(error_message(const QString &)));
+  connect(worker, SIGNAL(information_message(const QString &)), this, SIGNAL(information_message(const QString &)));
+  connect(worker, SIGNAL(error_message(const QString &)),       this, SLOT(on_worker_error(const QString &)));
+  connect(worker, SIGNAL(finished()),                           this, SLOT(on_worker_finished()));
+
+  // the outputs are in the journal before the worker writes them.
+  connect(worker, SIGNAL(output_files_created(const QString &, const QStringList &)), this, SLOT(on_worker_outputs(const QString &, const QStringList &)), Qt::DirectConnection);
+
+  emit worker_started(worker, QString::fromStdWString(filename.filename().wstring()));
+
+  worker->start();
+}
+
+//-----------------------------------------------------------------
+int Scheduler::lock_manager(void **mutex, AVLockOp operation)
+{
+  QMutex *passed_mutex;
+  switch (operation)
+  {
+    case AV_LOCK_CREATE:
+      *mutex = new QMutex();
+      return 0;
+    case AV_LOCK_OBTAIN:
+      passed_mutex = reinterpret_cast<QMutex *>(*mutex);
+      passed_mutex->lock();
+      return 0;
+    case AV_LOCK_RELEASE:
+      passed_mutex = reinterpret_cast<QMutex *>(*mutex);
+      passed_mutex->unlock();
+      return 0;
+    case AV_LOCK_DESTROY:
+      passed_mutex = reinterpret_cast<QMutex *>(*mutex);
+      delete passed_mutex;
+      return 0;
+  }
+  return 1;
+}
+
+//-----------------------------------------------------------------
+void Scheduler::register_av_lock_manager()
+{
+  av_lockmgr_register(Scheduler::lock_manager);
+}
+
+//-----------------------------------------------------------------
+void Scheduler::unregister_av_lock_manager()
+{
+  av_lockmgr_register(nullptr);
+}
@@ -0,0 +1,323 @@
+/*
+ File: Scheduler.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+// Project
+#include <Utils.h>
+#include <ProbeIndex.h>
+#include <JobJournal.h>
+#include <JobQueue.h>
+#include <ThreadBudget.h>
+#include <ConcurrencyController.h>
+#include <NumaPlacement.h>
+#include <RateLimiter.h>
+#include <MemoryBudget.h>
+
+// Qt
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// libav
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+// C++
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+class Worker;
+
+/** \class Scheduler
+ * \brief Launches the transcoding workers, keeping the configured number of them running until all
+ *        the files have been processed. The files are processed in the configured job order. Doesn't depend on the GUI, it's used by the process dialog
+ *        and the command line application.
+ *
+ */
+class Scheduler
+: public QObject
+{
+    Q_OBJECT
+  public:
+    /** \brief Scheduler class constructor.
+     * \param[in] files List of files to be transcoded.
+     * \param[in] config Application configuration reference.
+     * \param[in] parent Raw pointer of the object parent of this one.
+     *
+     */
+    explicit Scheduler(const std::vector<std::filesystem::path> &files,
+                       const Utils::TranscoderConfiguration &config,
+                       QObject *parent = nullptr);
+
+    /** \brief Scheduler class constructor for one of several instances running in the same machine, each
+     *         with its own probe index and job journal.
+     * \param[in] files List of files to be transcoded.
+     * \param[in] config Application configuration reference.
+     * \param[in] instance Name of the instance.
+     * \param[in] parent Raw pointer of the object parent of this one.
+     *
+     */
+    explicit Scheduler(const std::vector<std::filesystem::path> &files,
+                       const Utils::TranscoderConfiguration &config,
+                       const QString &instance,
+                       QObject *parent = nullptr);
+
+    /** \brief Scheduler class virtual destructor. Stops and deletes the running workers.
+     *
+     */
+    virtual ~Scheduler();
+
+    /** \brief Launches the first workers.
+     *
+     */
+    void start();
+
+    /** \brief Adds a file to the jobs, launching it if there is a free worker. Returns false if the file
+     *         has been skipped by the probe index or the journal, or if the process has been cancelled.
+     * \param[in] file file to be transcoded.
+     * \param[in] replace true if the file has changed and its previous outputs must be replaced once
+     *            the new ones are complete.
+     *
+     */
+    bool enqueue(const std::filesystem::path &file, const bool replace = false);
+
+    /** \brief Adds several files to the jobs, launching them if there are free workers. Returns the number
+     *         of files added, the ones skipped by the probe index or the journal aren't.
+     * \param[in] files files to be transcoded.
+     *
+     */
+    int enqueue(std::vector<std::filesystem::path> files);
+
+    /** \brief Keeps the scheduler waiting for new jobs when it runs out of them while the intake is open,
+     *         the finished signal is emitted once it's closed and the last job has finished.
+     * \param[in] open true to wait for new jobs and false otherwise.
+     *
+     */
+    void setIntakeOpen(const bool open);
+
+    /** \brief Returns the total number of jobs.
+     *
+     */
+    int jobsCount() const;
+
+    /** \brief Returns the number of files skipped because the probe index says they don't need processing.
+     *
+     */
+    int skippedJobsCount() const;
+
+    /** \brief Returns the number of files skipped because the journal says they were finished in a previous run.
+     *
+     */
+    int resumedJobsCount() const;
+
+    /** \brief Returns the number of jobs that have been completed.
+     *
+     */
+    int finishedJobsCount() const;
+
+    /** \brief Returns the maximum number of simultaneous workers. In automatic mode it's the
+     *         current decision of the concurrency controller.
+     *
+     */
+    int maximumWorkers() const;
+
+    /** \brief Returns the number of jobs running in each NUMA node, empty if the workers aren't pinned.
+     *
+     */
+    QString nodesOccupancy() const;
+
+    /** \brief Returns true if all the jobs have finished or the process has been cancelled.
+     *
+     */
+    bool isFinished() const;
+
+    /** \brief Returns true if the process has been cancelled.
+     *
+     */
+    bool hasBeenCancelled() const;
+
+  public slots:
+    /** \brief Stops the running workers and doesn't launch new ones.
+     *
+     */
+    void stop();
+
+  signals:
+    /** \brief Emitted when a worker has been launched.
+     * \param[in] worker Worker raw pointer.
+     * \param[in] name Name of the processed file.
+     *
+     */
+    void worker_started(Worker *worker, const QString &name);
+
+    /** \brief Emitted when a worker has finished, before deleting it.
+     * \param[in] worker Worker raw pointer.
+     *
+     */
+    void worker_finished(Worker *worker);
+
+    /** \brief Emitted when jobs are added after the construction.
+     * \param[in] count new total number of jobs.
+     *
+     */
+    void jobs_count_changed(int count);
+
+    /** \brief Emits an error message from the workers.
+     * \param[in] message error message.
+     *
+     */
+    void error_message(const QString &message);
+
+    /** \brief Emits an information message from the workers.
+     * \param[in] message information message.
+     *
+     */
+    void information_message(const QString &message);
+
+    /** \brief Emitted when all the jobs have finished or the process has been cancelled and all the
+     *         workers have stopped.
+     *
+     */
+    void finished();
+
+  private slots:
+    /** \brief Updates the counters, deletes the worker that emitted the signal and launches the next one.
+     *
+     */
+    void on_worker_finished();
+
+    /** \brief Measures the throughput of the running workers and adjusts the number of simultaneous
+     *         workers in automatic mode.
+     *
+     */
+    void on_sample_timeout();
+
+    /** \brief Measures the memory used by the running workers to correct their estimates.
+     *
+     */
+    void on_memory_timeout();
+
+    /** \brief Keeps the last error of the worker that emitted the signal as the reason of its failure.
+     * \param[in] message error message.
+     *
+     */
+    void on_worker_error(const QString &message);
+
+    /** \brief Stores in the journal the output files of a worker. Called from the worker thread, where
+     *         sender() isn't valid, so the source comes with the signal.
+     * \param[in] source source file path.
+     * \param[in] files output file paths.
+     *
+     */
+    void on_worker_outputs(const QString &source, const QStringList &files);
+
+  private:
+    /** \brief Creates and launches the workers' threads.
+     *
+     */
+    void create_threads();
+
+    /** \brief Filters the given files with the probe index and the journal and adds the rest to the jobs.
+     * \param[inout] files list of files, the skipped ones are removed.
+     *
+     */
+    void queue(std::vector<std::filesystem::path> &files);
+
+    /** \brief Reports the number of files skipped by the probe index and the journal.
+     *
+     */
+    void report_skipped();
+
+    /** \brief Emits the finished signal if there are no running workers and no jobs left or the process
+     *         has been cancelled.
+     *
+     */
+    void finish_if_idle();
+
+    /** \brief Creates and launches the transcoder of the next file.
+     *
+     */
+    void create_transcoder();
+
+    /** \brief Saves the probe index, if used, reporting the errors.
+     *
+     */
+    void save_index();
+
+    /** \brief Registers the lock manager for the libav library.
+     *
+     */
+    void register_av_lock_manager();
+
+    /** \brief Unregisters the lock manager for the libav library.
+     *
+     */
+    void unregister_av_lock_manager();
+
+    /** \brief Lock manager that complies with the specifications required
+     *         by libav. Needed for concurrent file transcoding.
+     *  \param[inout] mutex custom mutex object (QMutex in this case).
+     *  \param[in] op manager operation to perform.
+     *
+     */
+    static int lock_manager(void **mutex, enum AVLockOp op);
+
+    static const int s_sample_interval = 20000; /** throughput sampling interval in ms. */
+    static const int s_memory_interval = 2000;  /** memory sampling interval in ms.     */
+
+    const QString                          m_instance;      /** instance name, empty for the default one.  */
+    JobQueue                               m_jobs;          /** files waiting to be processed.             */
+    const Utils::TranscoderConfiguration  &m_configuration; /** application configuration struct.          */
+    QList<Worker *>                        m_workers;       /** running workers.                           */
+    int                                    m_total_jobs;    /** total number of jobs.                      */
+    int                                    m_finished_jobs; /** number of completed jobs.                  */
+    int                                    m_skipped_jobs;  /** number of files skipped by the index.      */
+    std::unique_ptr<ProbeIndex>            m_index;         /** probe index, nullptr if not used.          */
+    int                                    m_resumed_jobs;  /** files finished in a previous run.          */
+    QStringList                            m_cleaned_files; /** partial outputs removed on resume.         */
+    QSet<QString>                          m_replace;       /** files replacing their previous outputs.    */
+    std::unique_ptr<JobJournal>            m_journal;       /** job journal, nullptr if not used.          */
+    QHash<Worker *, QString>               m_last_errors;   /** last error of the running workers.         */
+    ThreadBudget                           m_budget;        /** cores shared by the workers' codecs.       */
+    NumaPlacement                          m_placement;     /** NUMA nodes of the workers.                 */
+    RateLimiter                            m_frame_limiter; /** frames per second cap of the workers.      */
+    RateLimiter                            m_byte_limiter;  /** read bytes per second cap of the workers.  */
+    MemoryBudget                           m_memory;        /** memory admission of the workers.           */
+    QTimer                                 m_memory_timer;  /** memory sampling timer.                     */
+    std::unique_ptr<ConcurrencyController> m_controller;    /** automatic concurrency or nullptr if fixed. */
+    QTimer                                 m_sample_timer;  /** throughput sampling timer.                 */
+    QElapsedTimer                          m_sample_clock;  /** time since the last sample.                */
+    long long                              m_sample_frames; /** frames processed at the last sample.       */
+    long long                              m_done_frames;   /** frames processed by the finished workers.  */
+    bool                                   m_started;       /** true if the scheduler has been started.    */
+    bool                                   m_intake_open;   /** true while new jobs can be enqueued.       */
+    bool                                   m_cancelled;     /** true if the process has been cancelled.    */
+    bool                                   m_finished;      /** true if process finished, false otherwise. */
+};
+
+#endif // SCHEDULER_H_
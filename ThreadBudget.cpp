@@ -0,0 +1,81 @@
+/*
+ File: ThreadBudget.cpp
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Project
+#include <ThreadBudget.h>
+
+// Qt
+#include <QMutexLocker>
+
+// C++
+#include <algorithm>
+#include <thread>
+
+//--------------------------------------------------------------------
+ThreadBudget::ThreadBudget(const int cores)
+: m_cores      {cores > 0 ? cores : std::max(1, static_cast<int>(std::thread::hardware_concurrency()))}
+, m_concurrency{1}
+, m_used       {0}
+{
+}
+
+//--------------------------------------------------------------------
+void ThreadBudget::setConcurrency(const int jobs)
+{
+  QMutexLocker lock(&m_mutex);
+
+  m_concurrency = std::max(1, jobs);
+}
+
+//--------------------------------------------------------------------
+int ThreadBudget::acquire(const int wanted)
+{
+  QMutexLocker lock(&m_mutex);
+
+  const auto share     = std::max(1, m_cores / m_concurrency);
+  const auto available = m_cores - m_used;
+  const auto granted   = std::max(1, std::min({wanted, share, available}));
+
+  m_used += granted;
+
+  return granted;
+}
+
+//--------------------------------------------------------------------
+void ThreadBudget::release(const int threads)
+{
+  QMutexLocker lock(&m_mutex);
+
+  m_used = std::max(0, m_used - threads);
+}
+
+//--------------------------------------------------------------------
+int ThreadBudget::cores() const
+{
+  return m_cores;
+}
+
+//--------------------------------------------------------------------
+int ThreadBudget::wantedThreads(const int width, const int height, const bool complex)
+{
+  // one thread per 720p frame area, codec threading doesn't scale well beyond that on smaller frames.
+  const auto units = std::max(1, (width * height + 1280 * 720 - 1) / (1280 * 720));
+
+  return complex ? 2 * units : units;
+}
@@ -0,0 +1,80 @@
+/*
+ File: ThreadBudget.h
+ Created on: 15/10/2026
+ Author: Felix de las Pozas Alvarez
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREADBUDGET_H_
+#define THREADBUDGET_H_
+
+// Qt
+#include <QMutex>
+
+/** \class ThreadBudget
+ * \brief Splits a fixed number of cores between the concurrent workers and the threads of their codecs.
+ *        Each worker gets at most its share of the cores for the expected number of concurrent jobs and
+ *        never more than the cores not used by the other workers, so the cores freed when the batch
+ *        runs out of jobs go to the last workers. Thread safe.
+ *
+ */
+class ThreadBudget
+{
+  public:
+    /** \brief ThreadBudget class constructor.
+     * \param[in] cores number of cores to share, 0 to use all the cores of the machine.
+     *
+     */
+    explicit ThreadBudget(const int cores);
+
+    /** \brief Sets the number of jobs expected to run at the same time.
+     * \param[in] jobs number of concurrent jobs.
+     *
+     */
+    void setConcurrency(const int jobs);
+
+    /** \brief Reserves threads for the codecs of a job and returns the number of threads granted, at least one.
+     * \param[in] wanted number of threads that the job can use.
+     *
+     */
+    int acquire(const int wanted);
+
+    /** \brief Returns the threads granted to a job to the budget.
+     * \param[in] threads number of threads granted by acquire().
+     *
+     */
+    void release(const int threads);
+
+    /** \brief Returns the number of cores of the budget.
+     *
+     */
+    int cores() const;
+
+    /** \brief Returns the number of threads a video transcoding job can use.
+     * \param[in] width frame width.
+     * \param[in] height frame height.
+     * \param[in] complex true if the encoder is computationally expensive (VP9, H.265).
+     *
+     */
+    static int wantedThreads(const int width, const int height, const bool complex);
+
+  private:
+    const int      m_cores;       /** number of cores to share.          */
+    int            m_concurrency; /** expected number of concurrent jobs. */
+    int            m_used;        /** threads granted.                   */
+    mutable QMutex m_mutex;       /** protects the budget data.          */
+};
+
+#endif // THREADBUDGET_H_
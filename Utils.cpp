@@ -24,11 +24,16 @@
 #include <QSettings>
 #include <QDirIterator>
 #include <QTemporaryFile>
-#include <QApplication>
 #include <QFile>
 #include <QTextStream>
+#include <QFileInfo>
+#include <QDateTime>
 
 // C++
+#include <algorithm>
+#include <condition_variable>
+#include <cwctype>
+#include <mutex>
 #include <thread>
 
 const std::vector<std::wstring> Utils::MOVIE_FILE_EXTENSIONS   = { L".mp4", L".avi", L".ogv", L".webm", L".mkv", L".mpg", L".mpeg" };
@@ -44,6 +49,29 @@ const QString Utils::TranscoderConfiguration::AUDIO_LANGUAGE     = QObject::tr("
 const QString Utils::TranscoderConfiguration::SUBTITLE_EXTRACT   = QObject::tr("Extract subtitles");
 const QString Utils::TranscoderConfiguration::SUBTITLE_LANGUAGE  = QObject::tr("Preferred subtitle language");
 const QString Utils::TranscoderConfiguration::THEME              = QObject::tr("Visual theme");
+const QString Utils::TranscoderConfiguration::AUDIO_QUEUE_SIZE   = QObject::tr("Audio queue size");
+const QString Utils::TranscoderConfiguration::VIDEO_QUEUE_SIZE   = QObject::tr("Video queue size");
+const QString Utils::TranscoderConfiguration::MUXER_QUEUE_SIZE   = QObject::tr("Muxer queue size");
+const QString Utils::TranscoderConfiguration::CHUNKED_ENCODING   = QObject::tr("Chunked encoding");
+const QString Utils::TranscoderConfiguration::NUMBER_OF_CHUNKS   = QObject::tr("Number of chunks");
+const QString Utils::TranscoderConfiguration::PREFETCH_INPUT     = QObject::tr("Prefetch input");
+const QString Utils::TranscoderConfiguration::INPUT_BLOCK_SIZE   = QObject::tr("Input block size");
+const QString Utils::TranscoderConfiguration::PREFETCH_DEPTH     = QObject::tr("Prefetch depth");
+const QString Utils::TranscoderConfiguration::OUTPUT_BUFFER_SIZE = QObject::tr("Output buffer size");
+const QString Utils::TranscoderConfiguration::OUTPUT_BUFFERS     = QObject::tr("Output buffers");
+const QString Utils::TranscoderConfiguration::SYNC_OUTPUT        = QObject::tr("Sync output");
+const QString Utils::TranscoderConfiguration::PROBE_INDEX        = QObject::tr("Probe index");
+const QString Utils::TranscoderConfiguration::LANGUAGES          = QObject::tr("Languages");
+const QString Utils::TranscoderConfiguration::ALL_LANGUAGES      = QObject::tr("All languages");
+const QString Utils::TranscoderConfiguration::JOB_ORDER          = QObject::tr("Job order");
+const QString Utils::TranscoderConfiguration::THREAD_BUDGET      = QObject::tr("Thread budget");
+const QString Utils::TranscoderConfiguration::NUMA_PLACEMENT     = QObject::tr("NUMA placement");
+const QString Utils::TranscoderConfiguration::JOB_JOURNAL        = QObject::tr("Job journal");
+const QString Utils::TranscoderConfiguration::CHECKPOINT_INTERVAL = QObject::tr("Checkpoint interval");
+const QString Utils::TranscoderConfiguration::EXECUTION_CLASS    = QObject::tr("Execution class");
+const QString Utils::TranscoderConfiguration::FRAME_RATE_LIMIT   = QObject::tr("Frame rate limit");
+const QString Utils::TranscoderConfiguration::READ_RATE_LIMIT    = QObject::tr("Read rate limit");
+const QString Utils::TranscoderConfiguration::MEMORY_BUDGET      = QObject::tr("Memory budget");
 
 //-----------------------------------------------------------------
 bool Utils::isVideoFile(const std::filesystem::path &file)
@@ -59,39 +87,206 @@ bool Utils::isVideoFile(const std::filesystem::path &file)
   return false;
 }
 
+//--------------------------------------------------------------------
+QString Utils::stateFilename(const QString &extension, const QString &instance)
+{
+  QSettings settings(QSettings::IniFormat, QSettings::UserScope, "Felix de las Pozas Alvarez", "VideoTranscoder");
+
+  QString name = "VideoTranscoder";
+  if(!instance.isEmpty())
+  {
+    auto suffix = instance;
+    for(auto &c: suffix)
+    {
+      if(!c.isLetterOrNumber() && c != '-' && c != '_') c = '_';
+    }
+
+    name += "." + suffix;
+  }
+
+  return QFileInfo(settings.fileName()).absolutePath() + "/" + name + "." + extension;
+}
+
+//--------------------------------------------------------------------
+std::filesystem::path Utils::outputFile(const std::filesystem::path &source, const std::wstring &part)
+{
+  return std::filesystem::path{source.wstring() + (part.empty() ? std::wstring() : L"." + part) + L".mkv"};
+}
+
+//--------------------------------------------------------------------
+bool Utils::isOutputFile(const std::filesystem::path &file)
+{
+  auto lower = [](std::wstring text) { for(auto &c: text) c = std::tolower(c); return text; };
+
+  if(lower(file.extension().wstring()) != L".mkv") return false;
+
+  auto source = file.parent_path() / file.stem();
+
+  // temporary parts, <source>.audio.mkv and <source>.chunk<n>.mkv.
+  const auto part = lower(source.extension().wstring());
+  const bool isChunk = part.size() > 6 && part.compare(0, 6, L".chunk") == 0 &&
+                       std::all_of(part.cbegin() + 6, part.cend(), [](const wchar_t c) { return std::iswdigit(c); });
+
+  if(part == L".audio" || isChunk) source = source.parent_path() / source.stem();
+
+  return isVideoFile(source);
+}
+
 //-----------------------------------------------------------------
-std::vector<std::filesystem::path> Utils::findFiles(const std::filesystem::path &initialDir,
-                                                    const std::vector<std::wstring> &extensions,
-                                                    bool with_subdirectories,
-                                                    const std::function<bool (const std::filesystem::path &)> &condition)
+bool Utils::matchesWildcard(const std::wstring &name, const std::wstring &pattern)
 {
-  std::vector<std::filesystem::path> filesFound;
+  // iterative matching with backtracking to the last '*'.
+  size_t n = 0, p = 0, star = std::wstring::npos, mark = 0;
 
-  if(!initialDir.empty() && std::filesystem::is_directory(initialDir))
+  while(n < name.size())
   {
-    for(auto &name: std::filesystem::directory_iterator(initialDir))
+    if(p < pattern.size() && (pattern[p] == L'?' || std::towlower(pattern[p]) == std::towlower(name[n])))
+    {
+      ++n;
+      ++p;
+    }
+    else if(p < pattern.size() && pattern[p] == L'*')
+    {
+      star = p++;
+      mark = n;
+    }
+    else if(star != std::wstring::npos)
     {
-      const auto entry = name.path();
-      if(entry.filename() == "." || entry.filename() == "..") continue;
+      p = star + 1;
+      n = ++mark;
+    }
+    else
+    {
+      return false;
+    }
+  }
 
-      if(with_subdirectories && std::filesystem::is_directory(entry))
-      {
-        auto files = findFiles(name, extensions, with_subdirectories, condition);
+  while(p < pattern.size() && pattern[p] == L'*') ++p;
+
+  return p == pattern.size();
+}
 
-        if(!files.empty()) std::copy(files.begin(), files.end(), std::back_inserter(filesFound));
+//-----------------------------------------------------------------
+void Utils::findFiles(const std::filesystem::path &rootDirectory,
+                      const SearchFilter &filter,
+                      const std::function<bool (std::filesystem::path &&)> &found)
+{
+  std::error_code error;
+  if(rootDirectory.empty() || !std::filesystem::is_directory(rootDirectory, error)) return;
+
+  auto isExcluded = [&filter](const std::filesystem::path &entry)
+  {
+    const auto name = entry.filename().wstring();
+    return std::any_of(filter.excludes.cbegin(), filter.excludes.cend(), [&name](const std::wstring &pattern) { return matchesWildcard(name, pattern); });
+  };
+
+  const bool needsStat = filter.minimumSize > 0 || filter.maximumSize > 0 || filter.modifiedAfter > 0;
+
+  // directories waiting to be listed and number of them being listed, protected by the mutex.
+  std::vector<std::filesystem::path> pending{rootDirectory};
+  std::mutex mutex;
+  std::condition_variable condition;
+  int busy = 0;
+  bool stop = false;
+
+  // the found callback is called by one thread at a time.
+  std::mutex foundMutex;
+
+  auto list = [&](const std::filesystem::path &directory, std::vector<std::filesystem::path> &subdirectories)
+  {
+    const auto options = std::filesystem::directory_options::skip_permission_denied;
+
+    std::error_code status;
+    for(std::filesystem::directory_iterator it(directory, options, status), end; !status && it != end; it.increment(status))
+    {
+      const auto &entry = *it;
+
+      // the type comes from the listing, only links and unknown types need a stat.
+      std::error_code type;
+      if(entry.is_directory(type))
+      {
+        if(filter.subdirectories && !isExcluded(entry.path())) subdirectories.push_back(entry.path());
+        continue;
       }
-      else
+
+      if(!entry.is_regular_file(type)) continue;
+
+      auto extension = entry.path().extension().wstring();
+      for(auto &c: extension) c = std::tolower(c);
+
+      if(std::find(filter.extensions.cbegin(), filter.extensions.cend(), extension) == filter.extensions.cend()) continue;
+      if(isExcluded(entry.path())) continue;
+
+      if(needsStat)
       {
-        auto extension = entry.extension().wstring();
-        for(auto &c: extension) c = std::tolower(c);
+        const QFileInfo info(QString::fromStdWString(entry.path().wstring()));
+        if(info.size() < filter.minimumSize) continue;
+        if(filter.maximumSize > 0 && info.size() > filter.maximumSize) continue;
+        if(filter.modifiedAfter > 0 && info.lastModified().toMSecsSinceEpoch() < filter.modifiedAfter) continue;
+      }
 
-        if(std::find(extensions.cbegin(), extensions.cend(), extension) != extensions.cend() && condition(name))
-        {
-          filesFound.emplace_back(name);
-        }
+      std::lock_guard<std::mutex> lock(foundMutex);
+      if(stop) return;
+      if(!found(std::filesystem::path(entry.path())))
+      {
+        std::lock_guard<std::mutex> pendingLock(mutex);
+        stop = true;
+        condition.notify_all();
+        return;
       }
     }
-  }
+  };
+
+  auto search = [&]()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(true)
+    {
+      condition.wait(lock, [&]() { return stop || !pending.empty() || busy == 0; });
+      if(stop || pending.empty()) break;
+
+      // depth first, the last directory found is listed next.
+      const auto directory = std::move(pending.back());
+      pending.pop_back();
+      ++busy;
+      lock.unlock();
+
+      std::vector<std::filesystem::path> subdirectories;
+      list(directory, subdirectories);
+
+      lock.lock();
+      --busy;
+      std::move(subdirectories.begin(), subdirectories.end(), std::back_inserter(pending));
+
+      // wakes the idle threads, or all of them when the search has ended.
+      condition.notify_all();
+    }
+  };
+
+  const auto threads = filter.subdirectories ? (filter.threads > 0 ? filter.threads : std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 2, 8)) : 1;
+
+  std::vector<std::thread> pool;
+  for(int i = 1; i < threads; ++i) pool.emplace_back(search);
+
+  search();
+
+  for(auto &thread: pool) thread.join();
+}
+
+//-----------------------------------------------------------------
+std::vector<std::filesystem::path> Utils::findFiles(const std::filesystem::path &rootDirectory, const SearchFilter &filter)
+{
+  std::vector<std::filesystem::path> filesFound;
+
+  findFiles(rootDirectory, filter, [&filesFound](std::filesystem::path &&file)
+  {
+    filesFound.push_back(std::move(file));
+    return true;
+  });
+
+  // the threads find the files in any order.
+  std::sort(filesFound.begin(), filesFound.end());
 
   return filesFound;
 }
@@ -108,6 +303,29 @@ Utils::TranscoderConfiguration::TranscoderConfiguration()
 , m_audioChannels                 {2}
 , m_subtitleLanguage              {Language::DEFAULT}
 , m_theme                         {true}
+, m_audioQueueSize                {128}
+, m_videoQueueSize                {64}
+, m_muxerQueueSize                {256}
+, m_chunkedEncoding               {false}
+, m_numberOfChunks                {4}
+, m_prefetchInput                 {false}
+, m_inputBlockSize                {4}
+, m_prefetchDepth                 {4}
+, m_outputBufferSize              {4}
+, m_outputBuffers                 {4}
+, m_syncOutput                    {false}
+, m_probeIndex                    {true}
+, m_languages                     {}
+, m_allLanguages                  {false}
+, m_jobOrder                      {JobOrder::LARGEST_FIRST}
+, m_threadBudget                  {0}
+, m_numaPlacement                 {false}
+, m_useJobJournal                 {true}
+, m_checkpointMinutes             {0}
+, m_executionClass                {ExecutionClass::NORMAL}
+, m_frameRateLimit                {0}
+, m_readRateLimit                 {0}
+, m_memoryBudget                  {0}
 {
 }
 
@@ -127,6 +345,29 @@ void Utils::TranscoderConfiguration::load()
   m_audioChannels     = settings.value(AUDIO_CHANNELS_NUM, 2).toInt();
   m_subtitleLanguage  = static_cast<Language>(settings.value(SUBTITLE_LANGUAGE, 0).toInt());
   m_theme             = settings.value(THEME, true).toBool();
+  m_audioQueueSize    = settings.value(AUDIO_QUEUE_SIZE, 128).toInt();
+  m_videoQueueSize    = settings.value(VIDEO_QUEUE_SIZE, 64).toInt();
+  m_muxerQueueSize    = settings.value(MUXER_QUEUE_SIZE, 256).toInt();
+  m_chunkedEncoding   = settings.value(CHUNKED_ENCODING, false).toBool();
+  m_numberOfChunks    = settings.value(NUMBER_OF_CHUNKS, std::max(2u, std::thread::hardware_concurrency() / 2)).toInt();
+  m_prefetchInput     = settings.value(PREFETCH_INPUT, false).toBool();
+  m_inputBlockSize    = settings.value(INPUT_BLOCK_SIZE, 4).toInt();
+  m_prefetchDepth     = settings.value(PREFETCH_DEPTH, 4).toInt();
+  m_outputBufferSize  = settings.value(OUTPUT_BUFFER_SIZE, 4).toInt();
+  m_outputBuffers     = settings.value(OUTPUT_BUFFERS, 4).toInt();
+  m_syncOutput        = settings.value(SYNC_OUTPUT, false).toBool();
+  m_probeIndex        = settings.value(PROBE_INDEX, true).toBool();
+  m_languages         = settings.value(LANGUAGES, QStringList()).toStringList();
+  m_allLanguages      = settings.value(ALL_LANGUAGES, false).toBool();
+  m_jobOrder          = static_cast<JobOrder>(settings.value(JOB_ORDER, 1).toInt());
+  m_threadBudget      = settings.value(THREAD_BUDGET, 0).toInt();
+  m_numaPlacement     = settings.value(NUMA_PLACEMENT, false).toBool();
+  m_useJobJournal     = settings.value(JOB_JOURNAL, true).toBool();
+  m_checkpointMinutes = settings.value(CHECKPOINT_INTERVAL, 0).toInt();
+  m_executionClass    = static_cast<ExecutionClass>(settings.value(EXECUTION_CLASS, 0).toInt());
+  m_frameRateLimit    = settings.value(FRAME_RATE_LIMIT, 0).toInt();
+  m_readRateLimit     = settings.value(READ_RATE_LIMIT, 0).toInt();
+  m_memoryBudget      = settings.value(MEMORY_BUDGET, 0).toInt();
 
   // go to parent or home if the saved directory no longer exists.
   m_root_directory = validDirectoryCheck(m_root_directory);
@@ -148,6 +389,29 @@ void Utils::TranscoderConfiguration::save() const
   settings.setValue(AUDIO_CHANNELS_NUM, m_audioChannels);
   settings.setValue(SUBTITLE_LANGUAGE, static_cast<int>(m_subtitleLanguage));
   settings.setValue(THEME, m_theme);
+  settings.setValue(AUDIO_QUEUE_SIZE, m_audioQueueSize);
+  settings.setValue(VIDEO_QUEUE_SIZE, m_videoQueueSize);
+  settings.setValue(MUXER_QUEUE_SIZE, m_muxerQueueSize);
+  settings.setValue(CHUNKED_ENCODING, m_chunkedEncoding);
+  settings.setValue(NUMBER_OF_CHUNKS, m_numberOfChunks);
+  settings.setValue(PREFETCH_INPUT, m_prefetchInput);
+  settings.setValue(INPUT_BLOCK_SIZE, m_inputBlockSize);
+  settings.setValue(PREFETCH_DEPTH, m_prefetchDepth);
+  settings.setValue(OUTPUT_BUFFER_SIZE, m_outputBufferSize);
+  settings.setValue(OUTPUT_BUFFERS, m_outputBuffers);
+  settings.setValue(SYNC_OUTPUT, m_syncOutput);
+  settings.setValue(PROBE_INDEX, m_probeIndex);
+  settings.setValue(LANGUAGES, m_languages);
+  settings.setValue(ALL_LANGUAGES, m_allLanguages);
+  settings.setValue(JOB_ORDER, static_cast<int>(m_jobOrder));
+  settings.setValue(THREAD_BUDGET, m_threadBudget);
+  settings.setValue(NUMA_PLACEMENT, m_numaPlacement);
+  settings.setValue(JOB_JOURNAL, m_useJobJournal);
+  settings.setValue(CHECKPOINT_INTERVAL, m_checkpointMinutes);
+  settings.setValue(EXECUTION_CLASS, static_cast<int>(m_executionClass));
+  settings.setValue(FRAME_RATE_LIMIT, m_frameRateLimit);
+  settings.setValue(READ_RATE_LIMIT, m_readRateLimit);
+  settings.setValue(MEMORY_BUDGET, m_memoryBudget);
 
   settings.sync();
 }
@@ -294,41 +558,302 @@ QString Utils::TranscoderConfiguration::visualTheme() const
 }
 
 //-----------------------------------------------------------------
-std::filesystem::path Utils::validDirectoryCheck(const std::filesystem::path& directory)
+int Utils::TranscoderConfiguration::audioQueueSize() const
 {
-  auto current = directory;
+  return m_audioQueueSize;
+}
 
-  while(!std::filesystem::is_directory(current) && !current.empty() && !(current.root_directory() == current))
-  {
-    current = current.parent_path();
-  }
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setAudioQueueSize(const int size)
+{
+  m_audioQueueSize = std::max(1, size);
+}
 
-  if(!std::filesystem::is_directory(current) || current.empty() || current.root_directory() == current)
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::videoQueueSize() const
+{
+  return m_videoQueueSize;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setVideoQueueSize(const int size)
+{
+  m_videoQueueSize = std::max(1, size);
+}
+
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::muxerQueueSize() const
+{
+  return m_muxerQueueSize;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setMuxerQueueSize(const int size)
+{
+  m_muxerQueueSize = std::max(1, size);
+}
+
+//-----------------------------------------------------------------
+bool Utils::TranscoderConfiguration::chunkedEncoding() const
+{
+  return m_chunkedEncoding;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setChunkedEncoding(const bool value)
+{
+  m_chunkedEncoding = value;
+}
+
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::numberOfChunks() const
+{
+  return m_numberOfChunks;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setNumberOfChunks(const int value)
+{
+  m_numberOfChunks = std::min(64, std::max(2, value));
+}
+
+//-----------------------------------------------------------------
+bool Utils::TranscoderConfiguration::prefetchInput() const
+{
+  return m_prefetchInput;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setPrefetchInput(const bool value)
+{
+  m_prefetchInput = value;
+}
+
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::inputBlockSize() const
+{
+  return m_inputBlockSize;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setInputBlockSize(const int value)
+{
+  m_inputBlockSize = std::min(64, std::max(1, value));
+}
+
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::prefetchDepth() const
+{
+  return m_prefetchDepth;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setPrefetchDepth(const int value)
+{
+  m_prefetchDepth = std::min(64, std::max(1, value));
+}
+
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::outputBufferSize() const
+{
+  return m_outputBufferSize;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setOutputBufferSize(const int value)
+{
+  m_outputBufferSize = std::min(64, std::max(1, value));
+}
+
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::outputBuffers() const
+{
+  return m_outputBuffers;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setOutputBuffers(const int value)
+{
+  m_outputBuffers = std::min(32, std::max(1, value));
+}
+
+//-----------------------------------------------------------------
+bool Utils::TranscoderConfiguration::syncOutput() const
+{
+  return m_syncOutput;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setSyncOutput(const bool value)
+{
+  m_syncOutput = value;
+}
+
+//-----------------------------------------------------------------
+bool Utils::TranscoderConfiguration::useProbeIndex() const
+{
+  return m_probeIndex;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setUseProbeIndex(const bool value)
+{
+  m_probeIndex = value;
+}
+
+//-----------------------------------------------------------------
+QStringList Utils::TranscoderConfiguration::languages() const
+{
+  return m_languages;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setLanguages(const QStringList &value)
+{
+  m_languages.clear();
+  for(const auto &language: value)
   {
-    current = std::filesystem::path(QDir::homePath().toStdWString());
+    const auto code = language.trimmed().toLower();
+    if(!code.isEmpty() && !m_languages.contains(code)) m_languages << code;
   }
+}
 
-  return current;
+//-----------------------------------------------------------------
+bool Utils::TranscoderConfiguration::allLanguages() const
+{
+  return m_allLanguages;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setAllLanguages(const bool value)
+{
+  m_allLanguages = value;
+}
+
+//-----------------------------------------------------------------
+Utils::TranscoderConfiguration::JobOrder Utils::TranscoderConfiguration::jobOrder() const
+{
+  return m_jobOrder;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setJobOrder(const JobOrder order)
+{
+  m_jobOrder = order;
+}
+
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::threadBudget() const
+{
+  return m_threadBudget;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setThreadBudget(const int value)
+{
+  m_threadBudget = std::max(0, value);
+}
+
+//-----------------------------------------------------------------
+bool Utils::TranscoderConfiguration::numaPlacement() const
+{
+  return m_numaPlacement;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setNumaPlacement(const bool value)
+{
+  m_numaPlacement = value;
+}
+
+//-----------------------------------------------------------------
+bool Utils::TranscoderConfiguration::useJobJournal() const
+{
+  return m_useJobJournal;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setUseJobJournal(const bool value)
+{
+  m_useJobJournal = value;
 }
 
 //-----------------------------------------------------------------
-void Utils::setApplicationTheme(const QString &theme)
+int Utils::TranscoderConfiguration::checkpointInterval() const
 {
-  QApplication::setOverrideCursor(Qt::WaitCursor);
+  return m_checkpointMinutes;
+}
 
-  QString sheet;
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setCheckpointInterval(const int value)
+{
+  m_checkpointMinutes = std::max(0, value);
+}
 
-  if (theme.compare("Light", Qt::CaseInsensitive) != 0)
+//-----------------------------------------------------------------
+Utils::TranscoderConfiguration::ExecutionClass Utils::TranscoderConfiguration::executionClass() const
+{
+  return m_executionClass;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setExecutionClass(const ExecutionClass value)
+{
+  m_executionClass = value;
+}
+
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::frameRateLimit() const
+{
+  return m_frameRateLimit;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setFrameRateLimit(const int value)
+{
+  m_frameRateLimit = std::max(0, value);
+}
+
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::readRateLimit() const
+{
+  return m_readRateLimit;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setReadRateLimit(const int value)
+{
+  m_readRateLimit = std::max(0, value);
+}
+
+//-----------------------------------------------------------------
+int Utils::TranscoderConfiguration::memoryBudget() const
+{
+  return m_memoryBudget;
+}
+
+//-----------------------------------------------------------------
+void Utils::TranscoderConfiguration::setMemoryBudget(const int value)
+{
+  m_memoryBudget = std::max(0, value);
+}
+
+//-----------------------------------------------------------------
+std::filesystem::path Utils::validDirectoryCheck(const std::filesystem::path& directory)
+{
+  auto current = directory;
+
+  while(!std::filesystem::is_directory(current) && !current.empty() && !(current.root_directory() == current))
   {
-    QFile file(":qdarkstyle/style.qss");
-    file.open(QFile::ReadOnly | QFile::Text);
-    QTextStream ts(&file);
-    sheet = ts.readAll();
+    current = current.parent_path();
   }
 
-  qApp->setStyleSheet(sheet);
+  if(!std::filesystem::is_directory(current) || current.empty() || current.root_directory() == current)
+  {
+    current = std::filesystem::path(QDir::homePath().toStdWString());
+  }
 
-  QApplication::restoreOverrideCursor();
+  return current;
 }
 
 //-----------------------------------------------------------------
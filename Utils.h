@@ -26,6 +26,7 @@
 // Qt
 #include <QDir>
 #include <QString>
+#include <QStringList>
 #include <QPair>
 #include <QMutex>
 
@@ -43,6 +44,20 @@ namespace Utils
    */
   bool isVideoFile(const std::filesystem::path &file);
 
+  /** \brief Returns the path of an output file of the given source: the transcoded file <source>.mkv if
+   *         the part is empty and the temporary file <source>.<part>.mkv of the chunked transcoding otherwise.
+   * \param[in] source source file path.
+   * \param[in] part name of the temporary part, "audio" or "chunk<n>".
+   *
+   */
+  std::filesystem::path outputFile(const std::filesystem::path &source, const std::wstring &part = std::wstring());
+
+  /** \brief Returns true if the file is the transcoded file or a temporary file of an existing source.
+   * \param[in] file file path.
+   *
+   */
+  bool isOutputFile(const std::filesystem::path &file);
+
   /** \brief Checks the given directory for existance and readability. If the directory is
    *  not readable or doesn't exist it will try the parent recursively until returning a valid
    *  path or the user home directory.
@@ -50,24 +65,57 @@ namespace Utils
    */
   std::filesystem::path validDirectoryCheck(const std::filesystem::path &directory);
 
-  /** \brief Returns the files in the specified directory tree that has the specified extensions.
-   * \param[in] rootDir starting directory.
-   * \param[in] filters extensions of the files to return.
-   * \param[in] with_subdirectories boolean that indicates if all the files in the subdiretories that
-   *            comply the conditions must be returned.
-   * \param[in] condition additional condition that the files must comply with.
+  /** \brief Returns the path of a state file of the application, next to the settings file.
+   * \param[in] extension extension of the file without the dot.
+   * \param[in] instance name of the instance using the file, added to the name if not empty so several
+   *            instances don't share it.
+   *
+   */
+  QString stateFilename(const QString &extension, const QString &instance = QString());
+
+  /** \struct SearchFilter
+   * \brief Conditions of the files returned by a search.
+   *
+   */
+  struct SearchFilter
+  {
+    std::vector<std::wstring> extensions     = MOVIE_FILE_EXTENSIONS; /** lower case extensions of the files.                   */
+    std::vector<std::wstring> excludes;                               /** wildcard patterns of the names of skipped entries.    */
+    long long                 minimumSize    = 0;                     /** minimum size in bytes.                                */
+    long long                 maximumSize    = 0;                     /** maximum size in bytes, 0 for unlimited.               */
+    qint64                    modifiedAfter  = 0;                     /** ms since epoch of the oldest modification, 0 for any. */
+    bool                      subdirectories = true;                  /** true to search the subdirectories.                    */
+    int                       threads        = 0;                     /** directories listed in parallel, 0 for automatic.      */
+  };
+
+  /** \brief Searches the specified directory tree for the regular files that comply with the filter. The
+   *         subdirectories are listed in parallel by a bounded pool of threads and the type of the entries
+   *         comes from the listing, the files are only stat'ed if the filter has size or time conditions.
+   * \param[in] rootDirectory starting directory.
+   * \param[in] filter conditions of the files.
+   * \param[in] found called from the search threads, one at a time, for each file found. The search stops
+   *            if it returns false.
+   *
+   */
+  void findFiles(const std::filesystem::path &rootDirectory,
+                 const SearchFilter &filter,
+                 const std::function<bool (std::filesystem::path &&)> &found);
+
+  /** \brief Returns the files in the specified directory tree that comply with the filter, sorted by path.
+   * \param[in] rootDirectory starting directory.
+   * \param[in] filter conditions of the files.
    *
    */
   std::vector<std::filesystem::path> findFiles(const std::filesystem::path &rootDirectory,
-                                               const std::vector<std::wstring> &extensions,
-                                               bool with_subdirectories = true,
-                                               const std::function<bool (const std::filesystem::path &)> &condition = Utils::isVideoFile);
+                                               const SearchFilter &filter = SearchFilter());
 
-  /** \brief Sets the visual theme of the application.
-   * \param[in] theme Possible values: Light/Dark
+  /** \brief Returns true if the name matches the wildcard pattern ('*' for any sequence and '?' for any
+   *         character), ignoring the case.
+   * \param[in] name file name.
+   * \param[in] pattern wildcard pattern.
    *
    */
-  void setApplicationTheme(const QString &theme);
+  bool matchesWildcard(const std::wstring &name, const std::wstring &pattern);
 
   /** \brief Converts the contents of the file to UCS-2 little endian. If the file is not text
    *  then the result is undefined. Returns true on success and false otherwise.
@@ -82,9 +130,11 @@ namespace Utils
   class TranscoderConfiguration
   {
     public:
-      enum class VideoCodec { VP8 = 0, VP9, H264, H265 };      /** video codec identifiers. */
-      enum class AudioCodec { VORBIS = 0, AAC };               /** audio codec identifiers. */
-      enum class Language   { DEFAULT = 0, ENGLISH, SPANISH }; /** language identifiers.    */
+      enum class VideoCodec     { VP8 = 0, VP9, H264, H265 };                /** video codec identifiers.     */
+      enum class AudioCodec     { VORBIS = 0, AAC };                         /** audio codec identifiers.     */
+      enum class Language       { DEFAULT = 0, ENGLISH, SPANISH };           /** language identifiers.        */
+      enum class JobOrder       { FIFO = 0, LARGEST_FIRST, SHORTEST_FIRST }; /** job order identifiers.       */
+      enum class ExecutionClass { NORMAL = 0, BATCH, IDLE };                 /** execution class identifiers. */
 
       /** \brief TranscoderConfiguration class constructor.
        *
@@ -226,6 +276,262 @@ namespace Utils
        */
       QString visualTheme() const;
 
+      /** \brief Returns the maximum number of packets waiting to be transcoded by the audio stage.
+       *
+       */
+      int audioQueueSize() const;
+
+      /** \brief Sets the maximum number of packets waiting to be transcoded by the audio stage.
+       * \param[in] size Number of packets.
+       *
+       */
+      void setAudioQueueSize(const int size);
+
+      /** \brief Returns the maximum number of packets waiting to be transcoded by the video stage.
+       *
+       */
+      int videoQueueSize() const;
+
+      /** \brief Sets the maximum number of packets waiting to be transcoded by the video stage.
+       * \param[in] size Number of packets.
+       *
+       */
+      void setVideoQueueSize(const int size);
+
+      /** \brief Returns the maximum number of packets waiting to be written by the muxer stage.
+       *
+       */
+      int muxerQueueSize() const;
+
+      /** \brief Sets the maximum number of packets waiting to be written by the muxer stage.
+       * \param[in] size Number of packets.
+       *
+       */
+      void setMuxerQueueSize(const int size);
+
+      /** \brief Returns true if the video of a single file must be split at keyframes and the chunks
+       *         encoded in parallel.
+       *
+       */
+      bool chunkedEncoding() const;
+
+      /** \brief Enables or disables the parallel encoding of video chunks.
+       * \param[in] value True to enable and false otherwise.
+       *
+       */
+      void setChunkedEncoding(const bool value);
+
+      /** \brief Returns the number of chunks to split the video into when chunked encoding is enabled.
+       *
+       */
+      int numberOfChunks() const;
+
+      /** \brief Sets the number of chunks to split the video into when chunked encoding is enabled.
+       * \param[in] value Number of chunks [2-64].
+       *
+       */
+      void setNumberOfChunks(const int value);
+
+      /** \brief Returns true if the input files must be read ahead by a background thread instead of memory mapped.
+       *
+       */
+      bool prefetchInput() const;
+
+      /** \brief Enables or disables the background read-ahead of the input files.
+       * \param[in] value True to enable and false otherwise.
+       *
+       */
+      void setPrefetchInput(const bool value);
+
+      /** \brief Returns the size in MB of the blocks read ahead from the input files.
+       *
+       */
+      int inputBlockSize() const;
+
+      /** \brief Sets the size in MB of the blocks read ahead from the input files.
+       * \param[in] value Block size in MB [1-64].
+       *
+       */
+      void setInputBlockSize(const int value);
+
+      /** \brief Returns the number of blocks read ahead of the demuxer.
+       *
+       */
+      int prefetchDepth() const;
+
+      /** \brief Sets the number of blocks read ahead of the demuxer.
+       * \param[in] value Number of blocks [1-64].
+       *
+       */
+      void setPrefetchDepth(const int value);
+
+      /** \brief Returns the size in MB of the buffers used to write the output files.
+       *
+       */
+      int outputBufferSize() const;
+
+      /** \brief Sets the size in MB of the buffers used to write the output files.
+       * \param[in] value Buffer size in MB [1-64].
+       *
+       */
+      void setOutputBufferSize(const int value);
+
+      /** \brief Returns the number of output buffers that can be waiting to be written to disk.
+       *
+       */
+      int outputBuffers() const;
+
+      /** \brief Sets the number of output buffers that can be waiting to be written to disk.
+       * \param[in] value Number of buffers [1-32].
+       *
+       */
+      void setOutputBuffers(const int value);
+
+      /** \brief Returns true if the output files data must be flushed to the storage device when closed.
+       *
+       */
+      bool syncOutput() const;
+
+      /** \brief Enables or disables flushing the output files data to the storage device when closed.
+       * \param[in] value True to enable and false otherwise.
+       *
+       */
+      void setSyncOutput(const bool value);
+
+      /** \brief Returns true if the probe results of the files are stored to skip the unchanged files that don't need processing.
+       *
+       */
+      bool useProbeIndex() const;
+
+      /** \brief Enables or disables storing the probe results of the files to skip the unchanged files that don't need processing.
+       * \param[in] value True to enable and false otherwise.
+       *
+       */
+      void setUseProbeIndex(const bool value);
+
+      /** \brief Returns the ordered list of preferred ISO-639-2 language codes of the audio and subtitle
+       *         streams. If empty the preferred audio and subtitle languages are used.
+       *
+       */
+      QStringList languages() const;
+
+      /** \brief Sets the ordered list of preferred ISO-639-2 language codes of the audio and subtitle streams.
+       * \param[in] value List of language codes, most preferred first.
+       *
+       */
+      void setLanguages(const QStringList &value);
+
+      /** \brief Returns true if all the audio and subtitle streams in the preferred languages are processed
+       *         instead of only the most preferred one.
+       *
+       */
+      bool allLanguages() const;
+
+      /** \brief Enables or disables processing all the audio and subtitle streams in the preferred languages.
+       * \param[in] value True to enable and false otherwise.
+       *
+       */
+      void setAllLanguages(const bool value);
+
+      /** \brief Returns the order in which the files are processed.
+       *
+       */
+      JobOrder jobOrder() const;
+
+      /** \brief Sets the order in which the files are processed.
+       * \param[in] order Job order identifier.
+       *
+       */
+      void setJobOrder(const JobOrder order);
+
+      /** \brief Returns the number of cores shared by the workers and their codecs, 0 to use all the cores.
+       *
+       */
+      int threadBudget() const;
+
+      /** \brief Sets the number of cores shared by the workers and their codecs.
+       * \param[in] value Number of cores, 0 to use all the cores.
+       *
+       */
+      void setThreadBudget(const int value);
+
+      /** \brief Returns true if each worker and its codec threads are pinned to the cores of one NUMA node.
+       *
+       */
+      bool numaPlacement() const;
+
+      /** \brief Enables or disables pinning each worker and its codec threads to the cores of one NUMA node.
+       * \param[in] value True to enable and false otherwise.
+       *
+       */
+      void setNumaPlacement(const bool value);
+
+      /** \brief Returns true if the states of the jobs are written to a journal to resume interrupted batches.
+       *
+       */
+      bool useJobJournal() const;
+
+      /** \brief Enables or disables the journal of the states of the jobs.
+       * \param[in] value True to enable and false otherwise.
+       *
+       */
+      void setUseJobJournal(const bool value);
+
+      /** \brief Returns the minutes of video between checkpoints of the video transcoding, 0 if disabled.
+       *
+       */
+      int checkpointInterval() const;
+
+      /** \brief Sets the minutes of video between checkpoints of the video transcoding.
+       * \param[in] value Minutes of video, 0 to disable the checkpoints.
+       *
+       */
+      void setCheckpointInterval(const int value);
+
+      /** \brief Returns the scheduling policy, nice level and I/O priority class of the workers.
+       *
+       */
+      ExecutionClass executionClass() const;
+
+      /** \brief Sets the scheduling policy, nice level and I/O priority class of the workers.
+       * \param[in] value Execution class identifier.
+       *
+       */
+      void setExecutionClass(const ExecutionClass value);
+
+      /** \brief Returns the maximum number of frames per second processed by all the workers, 0 if unlimited.
+       *
+       */
+      int frameRateLimit() const;
+
+      /** \brief Sets the maximum number of frames per second processed by all the workers.
+       * \param[in] value Frames per second, 0 for unlimited.
+       *
+       */
+      void setFrameRateLimit(const int value);
+
+      /** \brief Returns the maximum number of MB per second read by all the workers, 0 if unlimited.
+       *
+       */
+      int readRateLimit() const;
+
+      /** \brief Sets the maximum number of MB per second read by all the workers.
+       * \param[in] value MB per second, 0 for unlimited.
+       *
+       */
+      void setReadRateLimit(const int value);
+
+      /** \brief Returns the MB of memory that the running jobs can use, 0 if unlimited.
+       *
+       */
+      int memoryBudget() const;
+
+      /** \brief Sets the MB of memory that the running jobs can use.
+       * \param[in] value Memory in MB, 0 for unlimited.
+       *
+       */
+      void setMemoryBudget(const int value);
+
     private:
       std::filesystem::path m_root_directory;    /** last used directory.                                 */
       int                   m_number_of_threads; /** number of threads to use.                            */
@@ -238,6 +544,29 @@ namespace Utils
       int                   m_audioChannels;     /** output audio number of channels.                     */
       Language              m_subtitleLanguage;  /** Subtitle language to extract.                        */
       bool                  m_theme;             /** true for light theme, false for dark theme.          */
+      int                   m_audioQueueSize;    /** audio stage queue depth in packets.                  */
+      int                   m_videoQueueSize;    /** video stage queue depth in packets.                  */
+      int                   m_muxerQueueSize;    /** muxer stage queue depth in packets.                  */
+      bool                  m_chunkedEncoding;   /** true to encode video chunks in parallel.             */
+      int                   m_numberOfChunks;    /** number of video chunks in chunked encoding.          */
+      bool                  m_prefetchInput;     /** true to read ahead the input in a thread.            */
+      int                   m_inputBlockSize;    /** input read-ahead block size in MB.                   */
+      int                   m_prefetchDepth;     /** number of input blocks read ahead.                   */
+      int                   m_outputBufferSize;  /** output write buffer size in MB.                      */
+      int                   m_outputBuffers;     /** number of output write buffers.                      */
+      bool                  m_syncOutput;        /** true to sync the output files on close.              */
+      bool                  m_probeIndex;        /** true to use the probe results index.                 */
+      QStringList           m_languages;         /** preferred ISO-639-2 language codes.                  */
+      bool                  m_allLanguages;      /** true to process all preferred languages.             */
+      JobOrder              m_jobOrder;          /** order of the jobs.                                   */
+      int                   m_threadBudget;      /** cores shared by the codecs, 0 for all.               */
+      bool                  m_numaPlacement;     /** true to pin workers to NUMA nodes.                   */
+      bool                  m_useJobJournal;     /** true to resume interrupted batches.                  */
+      int                   m_checkpointMinutes; /** minutes between checkpoints, 0 disabled.             */
+      ExecutionClass        m_executionClass;    /** priority class of the workers.                       */
+      int                   m_frameRateLimit;    /** frames per second cap, 0 unlimited.                  */
+      int                   m_readRateLimit;     /** read MB per second cap, 0 unlimited.                 */
+      int                   m_memoryBudget;      /** memory of the jobs in MB, 0 unlimited.               */
 
       /** settings key strings. */
       static const QString ROOT_DIRECTORY;
@@ -251,6 +580,29 @@ namespace Utils
       static const QString SUBTITLE_EXTRACT;
       static const QString SUBTITLE_LANGUAGE;
       static const QString THEME;
+      static const QString AUDIO_QUEUE_SIZE;
+      static const QString VIDEO_QUEUE_SIZE;
+      static const QString MUXER_QUEUE_SIZE;
+      static const QString CHUNKED_ENCODING;
+      static const QString NUMBER_OF_CHUNKS;
+      static const QString PREFETCH_INPUT;
+      static const QString INPUT_BLOCK_SIZE;
+      static const QString PREFETCH_DEPTH;
+      static const QString OUTPUT_BUFFER_SIZE;
+      static const QString OUTPUT_BUFFERS;
+      static const QString SYNC_OUTPUT;
+      static const QString PROBE_INDEX;
+      static const QString LANGUAGES;
+      static const QString ALL_LANGUAGES;
+      static const QString JOB_ORDER;
+      static const QString THREAD_BUDGET;
+      static const QString NUMA_PLACEMENT;
+      static const QString JOB_JOURNAL;
+      static const QString CHECKPOINT_INTERVAL;
+      static const QString EXECUTION_CLASS;
+      static const QString FRAME_RATE_LIMIT;
+      static const QString READ_RATE_LIMIT;
+      static const QString MEMORY_BUDGET;
   };
 }
 
@@ -48,9 +48,10 @@ VideoTranscoder::VideoTranscoder()
 
   m_configuration.load();
 
-  Utils::setApplicationTheme(m_configuration.visualTheme());
+  ConfigurationDialog::setApplicationTheme(m_configuration.visualTheme());
 
-  m_threads->setMinimum(1);
+  m_threads->setMinimum(0);
+  m_threads->setSpecialValueText(tr("Auto"));
   m_threads->setMaximum(std::thread::hardware_concurrency());
   m_threads->setValue(m_configuration.numberOfThreads());
   m_directoryText->setText(QDir::toNativeSeparators(QString::fromStdWString(m_configuration.rootDirectory().wstring())));
@@ -99,13 +100,13 @@ void VideoTranscoder::onStartButtonPressed()
 {
   const auto path = std::filesystem::path(m_directoryText->text().toStdWString());
 
-  const auto files = Utils::findFiles(path, Utils::MOVIE_FILE_EXTENSIONS);
+  m_configuration.setNumberOfThreads(m_threads->value());
 
-  if(!files.empty())
+  if(std::filesystem::is_directory(path))
   {
     hide();
 
-    ProcessDialog dialog{files, m_configuration}; // using 'this' as parent makes the dialog not appear, WTF?
+    ProcessDialog dialog{path, m_configuration}; // using 'this' as parent makes the dialog not appear, WTF?
     dialog.exec();
 
     show();
@@ -113,7 +114,7 @@ void VideoTranscoder::onStartButtonPressed()
   else
   {
     QMessageBox msgBox;
-    msgBox.setText("Can't find any video file in the specified folder that can be processed.");
+    msgBox.setText("The specified folder doesn't exist.");
     msgBox.setStandardButtons(QMessageBox::Ok);
     msgBox.setIcon(QMessageBox::Information);
     msgBox.setWindowIcon(QIcon(":/VideoTranscoder/application.ico"));
@@ -19,13 +19,18 @@
 
 // Project
 #include <Worker.h>
+#include <MappedInputReader.h>
+#include <PrefetchInputReader.h>
+#include <ExecutionPolicy.h>
 
 // C++
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 #include <string.h>
 
 #include <QTime>
+#include <QHash>
 
 // libav
 extern "C"
@@ -40,23 +45,46 @@ extern "C"
 #include <libavfilter/buffersrc.h>
 #include <libavfilter/buffersink.h>
 #include <libavutil/opt.h>
+#include <libavutil/imgutils.h>
 }
 
-#include <iostream>
-
 const std::wstring SUBTITLE_EXTENSION = L".srt";
-const std::wstring VIDEO_EXTENSION    = L".mkv";
+const QString      PREVIOUS_SUFFIX    = ".previous";
 
 constexpr auto NO_PTS_VALUE = static_cast<long long int>(AV_NOPTS_VALUE);
 
 //--------------------------------------------------------------------
-Worker::Worker(const std::filesystem::path &source_info, const Utils::TranscoderConfiguration &config)
+Worker::Worker(const std::filesystem::path &source_info, const Utils::TranscoderConfiguration &config, ThreadBudget *budget)
+: Worker(source_info, config, Chunk(), budget)
+{
+}
+
+//--------------------------------------------------------------------
+Worker::Worker(const std::filesystem::path &source_info, const Utils::TranscoderConfiguration &config, const Chunk &chunk, ThreadBudget *budget)
 : m_configuration           {config}
 , m_input_context           {nullptr}
 , m_output_context          {nullptr}
-, m_frame                   {nullptr}
 , m_packet                  {nullptr}
 , m_source_info             (source_info)
+, m_chunk                   (chunk)
+, m_progress                {0}
+, m_bytes_copied            {0}
+, m_frames                  {0}
+, m_discarded_streams       {0}
+, m_budget                  {budget}
+, m_threads                 {0}
+, m_placement               {nullptr}
+, m_node                    {-1}
+, m_checkpoint              {nullptr}
+, m_frame_limiter           {nullptr}
+, m_byte_limiter            {nullptr}
+, m_memory                  {nullptr}
+, m_memory_estimate         {0}
+, m_memory_reserved         {-1}
+, m_replace_outputs         {false}
+, m_audio_queue             {config.audioQueueSize()}
+, m_video_queue             {config.videoQueueSize()}
+, m_muxer_queue             {config.muxerQueueSize()}
 , m_fail                    {false}
 , m_stop                    {false}
 {
@@ -81,162 +109,889 @@ bool Worker::has_failed()
   return m_fail;
 }
 
+//--------------------------------------------------------------------
+void Worker::set_placement(const NumaPlacement *placement, const int node)
+{
+  m_placement = (node >= 0) ? placement : nullptr;
+  m_node      = node;
+}
+
+//--------------------------------------------------------------------
+void Worker::set_rate_limits(RateLimiter *frames, RateLimiter *bytes)
+{
+  m_frame_limiter = (frames && frames->isEnabled()) ? frames : nullptr;
+  m_byte_limiter  = (bytes && bytes->isEnabled()) ? bytes : nullptr;
+}
+
+//--------------------------------------------------------------------
+void Worker::set_memory_budget(MemoryBudget *budget)
+{
+  m_memory = (budget && budget->isEnabled()) ? budget : nullptr;
+}
+
+//--------------------------------------------------------------------
+void Worker::set_replace_outputs(const bool replace)
+{
+  m_replace_outputs = replace;
+}
+
+//--------------------------------------------------------------------
+qint64 Worker::estimate_memory() const
+{
+  constexpr qint64 BASE_MEMORY  = 32 * 1024 * 1024; // demuxer, muxer, audio codecs and buffers.
+  constexpr qint64 PACKET_BYTES = 64 * 1024;        // minimum size of a queued packet.
+
+  const auto queuedPackets = static_cast<qint64>(m_configuration.audioQueueSize() + m_configuration.videoQueueSize() + m_configuration.muxerQueueSize());
+  const auto parameters    = (m_video_stream.id >= 0) ? m_input_context->streams[m_video_stream.id]->codecpar : nullptr;
+
+  auto packetBytes = PACKET_BYTES;
+  if(parameters && parameters->bit_rate > 0) packetBytes = std::max(packetBytes, static_cast<qint64>(parameters->bit_rate / 8 / 24));
+
+  qint64 memory = BASE_MEMORY + queuedPackets * packetBytes;
+
+  if(parameters && needsVideoProcessing())
+  {
+    const auto width  = std::max(1, parameters->width);
+    const auto height = std::max(1, parameters->height);
+    auto format = static_cast<AVPixelFormat>(parameters->format);
+    if(format == AV_PIX_FMT_NONE) format = AV_PIX_FMT_YUV420P;
+
+    const auto decodedFrame = static_cast<qint64>(std::max(0, av_image_get_buffer_size(format, width, height, 1)));
+    const auto encodedFrame = static_cast<qint64>(std::max(0, av_image_get_buffer_size(AV_PIX_FMT_YUV420P, width, height, 1)));
+
+    const auto complex = (videoCodecId() == AV_CODEC_ID_VP9 || videoCodecId() == AV_CODEC_ID_HEVC);
+    const auto threads = ThreadBudget::wantedThreads(width, height, complex);
+
+    // reference frames and reordering delay of the decoder, one frame per thread.
+    const auto decoderFrames = 4 + parameters->video_delay + threads;
+
+    // default lookahead of the encoders: libvpx lag_in_frames, x264 rc-lookahead and x265 lookahead plus b-frames.
+    int lookahead = 25;
+    if(videoCodecId() == AV_CODEC_ID_H264) lookahead = 40;
+    if(videoCodecId() == AV_CODEC_ID_HEVC) lookahead = 24;
+
+    memory += decodedFrame * decoderFrames + encodedFrame * (lookahead + threads);
+  }
+
+  return memory;
+}
+
+//--------------------------------------------------------------------
+bool Worker::reserve_memory(const size_t chunks)
+{
+  // the parent worker reserves the memory of its chunks.
+  if(!m_memory || m_chunk.type != Chunk::Type::NONE) return true;
+
+  // the chunks are transcoded a window at a time, see transcode_chunks().
+  const size_t concurrent = (chunks == 0) ? 1 : std::min(chunks, static_cast<size_t>(m_configuration.chunkedEncoding() ? m_configuration.numberOfChunks() : 1));
+
+  m_memory_estimate = estimate_memory() * static_cast<qint64>(concurrent);
+
+  if(!m_memory->fits(m_memory_estimate))
+  {
+    emit information_message(tr("'%1' waiting for memory, needs about %2 MB.").arg(QString::fromStdString(m_source_info.stem().string()))
+                                                                              .arg(m_memory->corrected(m_memory_estimate) / (1024 * 1024)));
+  }
+
+  m_memory_reserved = m_memory->acquire(m_memory_estimate, m_stop);
+
+  return m_memory_reserved >= 0;
+}
+
+//--------------------------------------------------------------------
+void Worker::release_memory()
+{
+  if(m_memory && m_memory_reserved >= 0)
+  {
+    m_memory->release(m_memory_estimate, m_memory_reserved);
+  }
+
+  m_memory_reserved = -1;
+}
+
+//--------------------------------------------------------------------
+void Worker::throttle(const long long frames, const long long bytes)
+{
+  long long wait = 0;
+  if(m_frame_limiter && frames > 0) wait = std::max(wait, m_frame_limiter->reserve(frames));
+  if(m_byte_limiter && bytes > 0)   wait = std::max(wait, m_byte_limiter->reserve(bytes));
+
+  // in small steps to stop quickly if cancelled.
+  while(wait > 0 && !has_been_cancelled())
+  {
+    const auto step = std::min(wait, 100000LL);
+    usleep(step);
+    wait -= step;
+  }
+}
+
 //--------------------------------------------------------------------
 void Worker::run()
 {
+  // the threads of the pipeline and the codecs inherit the placement and execution class of this one.
+  if(m_placement) m_placement->bindCurrentThread(m_node);
+
+  QString policyError;
+  if(!ExecutionPolicy::applyToCurrentThread(m_configuration.executionClass(), policyError) && m_chunk.type == Chunk::Type::NONE)
+  {
+    emit information_message(tr("Unable to apply the '%1' execution class, running with normal priority (%2).").arg(ExecutionPolicy::name(m_configuration.executionClass())).arg(policyError));
+  }
+
   if(check_input_file_permissions() && init_libav() && check_output_file_permissions())
   {
     if(inputNeedsProcessing())
     {
-      if(create_output())
+      std::vector<Chunk> chunks;
+
+      if(!needsAudioProcessing() && !needsVideoProcessing())
       {
-        const bool transcodeAudio   = m_audio_stream.encoder != nullptr;
-        const bool transcodeVideo   = m_video_stream.encoder != nullptr;
-        const bool extractSubtitles = m_subtitle_file.isOpen();
+        extract_subtitles();
+      }
+      else
+      {
+        const auto chunked = m_chunk.type == Chunk::Type::NONE && (m_configuration.chunkedEncoding() || m_configuration.checkpointInterval() > 0) &&
+                             needsVideoProcessing() && compute_chunks(chunks);
+
+        // the decoders and encoders are only allocated once the job fits the memory budget.
+        if(reserve_memory(chunks.size()))
+        {
+          if(chunked)
+          {
+            transcode_chunks(chunks);
+          }
+          else if(init_decoders() && create_output())
+          {
+            transcode();
+          }
+          else
+          {
+            emit error_message(tr("Unable to create output or configure it for file: '%1'").arg(QString::fromStdWString(m_source_info.wstring())));
+            m_fail = true;
+          }
+        }
+
+        release_memory();
+      }
+    }
+    else
+    {
+      emit information_message(tr("Not processed: '%1' is already in the correct format for Chromecast").arg(QString::fromStdWString(m_source_info.wstring())));
+    }
+
+    deinit_libav();
+  }
+  else
+  {
+    m_fail = true;
+  }
+
+  if(m_stop)
+  {
+    // If cancelled remove output files.
+    QStringList files;
 
-        QStringList processingStrings;
-        if(transcodeAudio)   processingStrings.push_back(tr("audio"));
-        if(transcodeVideo)   processingStrings.push_back(tr("video"));
-        if(extractSubtitles) processingStrings.push_back(tr("extracting subtitles"));
+    const auto output_video = output_video_filename();
 
-        QString processingText;
-        switch(processingStrings.size())
+    if(QFile::exists(output_video))
+    {
+      if(!QFile::remove(output_video))
+      {
+        emit error_message(tr("Unable to remove output file: '%1'").arg(output_video));
+      }
+    }
+
+    for(auto &track: m_subtitle_tracks)
+    {
+      if(!track.file || !track.file->isOpen()) continue;
+
+      track.file->close();
+      if(!track.file->remove())
+      {
+        emit error_message(tr("Unable to remove output file: '%1'").arg(track.file->fileName()));
+      }
+    }
+  }
+
+  finish_replaced_outputs();
+
+  m_progress = 100;
+  emit progress(100);
+}
+
+//--------------------------------------------------------------------
+void Worker::transcode()
+{
+  const bool transcodeAudio   = m_audio_stream.encoder != nullptr;
+  const bool transcodeVideo   = m_video_stream.encoder != nullptr;
+  const bool extractSubtitles = has_subtitle_files();
+
+  QStringList processingStrings;
+  if(transcodeAudio)   processingStrings.push_back(tr("audio"));
+  if(transcodeVideo)   processingStrings.push_back(tr("video"));
+  if(extractSubtitles) processingStrings.push_back(tr("extracting subtitles"));
+
+  QString processingText;
+  switch(processingStrings.size())
+  {
+    case 1:
+      processingText = processingStrings.first();
+      break;
+    case 2:
+      processingText = processingStrings.join(" and ");
+      break;
+    case 3:
+      processingText = processingStrings.first() + ", " + processingStrings[1] + " and " + processingStrings.last();
+      break;
+    default:
+      processingText = "unknown";
+      break;
+  }
+
+  if(transcodeAudio || transcodeVideo) processingText = "transcoding " + processingText;
+
+  const auto filename = QString::fromStdString(m_source_info.stem().string());
+  if(m_chunk.type == Chunk::Type::NONE)
+  {
+    const auto message = tr("Processing '%1': %2").arg(filename).arg(processingText);
+    emit information_message(message);
+  }
+
+  start_pipeline();
+
+  // video chunks start at the keyframe of the chunk and end before the keyframe of the next one.
+  bool insideChunk = (m_chunk.type != Chunk::Type::VIDEO);
+
+  int value = 0;
+  int progressVal = 0;
+  long long demuxedBytes = 0;
+  while(!has_been_cancelled() && !m_fail && 0 == (value = av_read_frame(m_input_context, m_packet)))
+  {
+    demuxedBytes += m_packet->size;
+    throttle(0, m_packet->size);
+
+    int currentProgress = m_input_context->pb->pos * 100 / std::max(1LL, m_input_reader->size());
+
+    if(m_packet->stream_index == m_video_stream.id && m_video_stream.stream)
+    {
+      if(m_chunk.type == Chunk::Type::VIDEO)
+      {
+        const auto isKeyframe = (m_packet->flags & AV_PKT_FLAG_KEY) != 0;
+        const auto pts = (m_packet->pts != NO_PTS_VALUE) ? m_packet->pts : m_packet->dts;
+
+        if(isKeyframe && m_chunk.end != NO_PTS_VALUE && pts >= m_chunk.end)
         {
-          case 1:
-            processingText = processingStrings.first();
-            break;
-          case 2:
-            processingText = processingStrings.join(" and ");
-            break;
-          case 3:
-            processingText = processingStrings.first() + ", " + processingStrings[1] + " and " + processingStrings.last();
-            break;
-          default:
-            processingText = "unknown";
-            break;
+          value = AVERROR_EOF;
+          av_packet_unref(m_packet);
+          break;
         }
 
-        if(transcodeAudio || transcodeVideo) processingText = "transcoding " + processingText;
+        if(!insideChunk && isKeyframe && pts >= m_chunk.start) insideChunk = true;
 
-        const auto filename = QString::fromStdString(m_source_info.stem().string());
-        const auto message = tr("Processing '%1': %2").arg(filename).arg(processingText);
-        emit information_message(message);
+        if(m_chunk.length > 0 && pts != NO_PTS_VALUE)
+        {
+          currentProgress = std::min(100LL, std::max(0LL, (pts - m_chunk.start) * 100 / m_chunk.length));
+        }
+      }
+
+      if(insideChunk)
+      {
+        if(!dispatch_packet(transcodeVideo ? m_video_queue : m_muxer_queue)) break;
+        ++m_frames;
+        throttle(1, 0);
+      }
+    }
+    else if(m_packet->stream_index == m_audio_stream.id && m_audio_stream.stream)
+    {
+      if(!dispatch_packet(transcodeAudio ? m_audio_queue : m_muxer_queue)) break;
+    }
+    else if(extra_audio_stream(m_packet->stream_index))
+    {
+      if(!dispatch_packet(m_muxer_queue)) break;
+    }
+
+    if(progressVal != currentProgress)
+    {
+      m_progress = progressVal = currentProgress;
+      emit progress(progressVal);
+    }
+
+    if(extractSubtitles)
+    {
+      write_srt_packet(m_packet);
+    }
+
+    av_packet_unref(m_packet);
+  }
+
+  finish_pipeline(value == AVERROR_EOF && !has_been_cancelled() && !m_fail);
+
+  if(value == AVERROR_EOF)
+  {
+    close_subtitle_files();
+
+    if(m_chunk.type == Chunk::Type::NONE && !m_fail && (transcodeAudio || transcodeVideo))
+    {
+      emit information_message(tr("'%1': %2 bytes of frame data copied.").arg(filename).arg(m_bytes_copied.load()));
+    }
+
+    if(m_chunk.type == Chunk::Type::NONE && !m_fail && m_discarded_streams > 0)
+    {
+      const auto skippedBytes = std::max(0LL, m_input_reader->size() - demuxedBytes);
+      emit information_message(tr("'%1': %2 unused streams discarded, %3 input bytes skipped by the demuxer.").arg(filename).arg(m_discarded_streams).arg(skippedBytes));
+    }
+  }
+  else if(value < 0)
+  {
+    emit error_message(tr("Error while transcoding '%1'. Error is: %2.").arg(QString::fromStdWString(m_source_info.wstring())).arg(av_error_string(value)));
+    m_fail = true;
+  }
+}
+
+//--------------------------------------------------------------------
+void Worker::extract_subtitles()
+{
+  const auto filename = QString::fromStdString(m_source_info.stem().string());
+
+  compute_subtitle_start();
 
-        int value = 0;
-        int progressVal = 0;
-        while(0 == (value = av_read_frame(m_input_context, m_packet)) && !has_been_cancelled())
+  if(!create_output())
+  {
+    emit error_message(tr("Unable to create output or configure it for file: '%1'").arg(QString::fromStdWString(m_source_info.wstring())));
+    m_fail = true;
+    return;
+  }
+
+  // the subtitles can't be extracted, already reported.
+  if(!has_subtitle_files()) return;
+
+  emit information_message(tr("Processing '%1': extracting subtitles").arg(filename));
+
+  // no decoders and no pipeline, the audio and video packets are discarded by the demuxer.
+  int value = 0;
+  int progressVal = 0;
+  while(!has_been_cancelled() && !m_fail && 0 == (value = av_read_frame(m_input_context, m_packet)))
+  {
+    throttle(0, m_packet->size);
+    write_srt_packet(m_packet);
+
+    av_packet_unref(m_packet);
+
+    const int currentProgress = m_input_context->pb->pos * 100 / std::max(1LL, m_input_reader->size());
+    if(progressVal != currentProgress)
+    {
+      m_progress = progressVal = currentProgress;
+      emit progress(progressVal);
+    }
+  }
+
+  if(value == AVERROR_EOF)
+  {
+    close_subtitle_files();
+  }
+  else if(value < 0)
+  {
+    emit error_message(tr("Error while extracting subtitles of '%1'. Error is: %2.").arg(QString::fromStdWString(m_source_info.wstring())).arg(av_error_string(value)));
+    m_fail = true;
+  }
+}
+
+//--------------------------------------------------------------------
+bool Worker::compute_chunks(std::vector<Chunk> &chunks)
+{
+  const auto stream = m_input_context->streams[m_video_stream.id];
+  const long long start = (stream->start_time != NO_PTS_VALUE) ? stream->start_time : 0;
+
+  auto add_chunk = [this, &chunks](const long long chunkStart, const long long chunkEnd, const long long chunkLength)
+  {
+    Chunk chunk;
+    chunk.type   = Chunk::Type::VIDEO;
+    chunk.start  = chunkStart;
+    chunk.end    = chunkEnd;
+    chunk.length = chunkLength;
+    chunk.output = Utils::outputFile(m_source_info, L"chunk" + std::to_wstring(chunks.size()));
+
+    chunks.push_back(chunk);
+  };
+
+  if(m_configuration.checkpointInterval() > 0)
+  {
+    m_checkpoint = std::make_unique<Checkpoint>(m_source_info, checkpoint_signature());
+
+    // the chunks of an interrupted transcoding are reused as they are.
+    if(m_checkpoint->load())
+    {
+      for(const auto &segment: m_checkpoint->segments()) add_chunk(segment.start, segment.end, segment.length);
+      return true;
+    }
+  }
+
+  long long duration = stream->duration;
+  if(duration == NO_PTS_VALUE || duration <= 0)
+  {
+    if(m_input_context->duration == NO_PTS_VALUE || m_input_context->duration <= 0) return false;
+
+    duration = av_rescale_q(m_input_context->duration, AVRational{1, AV_TIME_BASE}, stream->time_base);
+  }
+
+  int number = m_configuration.chunkedEncoding() ? m_configuration.numberOfChunks() : 1;
+  if(m_checkpoint)
+  {
+    // one checkpoint at the end of every chunk.
+    const auto minutes = av_rescale_q(duration, stream->time_base, AVRational{60, 1});
+    number = std::max(number, static_cast<int>(minutes / m_configuration.checkpointInterval()) + 1);
+  }
+
+  std::vector<long long> keyframes{start};
+
+  // the keyframes are found seeking close to the evenly spaced split points instead of reading the whole video.
+  for(int i = 1; i < number; ++i)
+  {
+    const long long target = start + duration * i / number;
+
+    if(av_seek_frame(m_input_context, m_video_stream.id, target, AVSEEK_FLAG_BACKWARD) < 0) break;
+
+    long long keyframe = NO_PTS_VALUE;
+    while(keyframe == NO_PTS_VALUE && 0 == av_read_frame(m_input_context, m_packet))
+    {
+      if(m_packet->stream_index == m_video_stream.id && (m_packet->flags & AV_PKT_FLAG_KEY))
+      {
+        keyframe = (m_packet->pts != NO_PTS_VALUE) ? m_packet->pts : m_packet->dts;
+      }
+
+      av_packet_unref(m_packet);
+    }
+
+    if(keyframe != NO_PTS_VALUE && keyframe > keyframes.back())
+    {
+      keyframes.push_back(keyframe);
+    }
+  }
+
+  if(keyframes.size() < 2)
+  {
+    // the file is transcoded as a whole, from the beginning.
+    av_seek_frame(m_input_context, m_video_stream.id, start, AVSEEK_FLAG_BACKWARD);
+    m_checkpoint = nullptr;
+    return false;
+  }
+
+  for(size_t i = 0; i < keyframes.size(); ++i)
+  {
+    const auto isLast = (i == keyframes.size() - 1);
+
+    add_chunk(keyframes[i], isLast ? NO_PTS_VALUE : keyframes[i + 1], (isLast ? start + duration : keyframes[i + 1]) - keyframes[i]);
+  }
+
+  if(m_checkpoint)
+  {
+    auto &segments = m_checkpoint->segments();
+    segments.clear();
+
+    for(const auto &chunk: chunks)
+    {
+      Checkpoint::Segment segment;
+      segment.start  = chunk.start;
+      segment.end    = chunk.end;
+      segment.length = chunk.length;
+
+      segments.push_back(segment);
+    }
+
+    if(!m_checkpoint->save())
+    {
+      emit error_message(tr("Unable to write the checkpoint file '%1'.").arg(Checkpoint::checkpointFilename(m_source_info)));
+    }
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+quint32 Worker::checkpoint_signature() const
+{
+  const auto stream = m_input_context->streams[m_video_stream.id];
+
+  const QString values = QString("%1;%2;%3;%4;%5").arg(static_cast<int>(m_configuration.videoCodec()))
+                                                  .arg(m_configuration.videoBitrate())
+                                                  .arg(m_video_stream.id)
+                                                  .arg(stream->codecpar->width)
+                                                  .arg(stream->codecpar->height);
+
+  return qHash(values);
+}
+
+//--------------------------------------------------------------------
+void Worker::transcode_chunks(std::vector<Chunk> &chunks)
+{
+  const auto filename = QString::fromStdString(m_source_info.stem().string());
+
+  Chunk audio;
+  audio.type   = Chunk::Type::AUDIO;
+  audio.output = Utils::outputFile(m_source_info, L"audio");
+
+  // the finished chunks of an interrupted transcoding aren't transcoded again.
+  std::vector<size_t> pending;
+  for(size_t i = 0; i < chunks.size(); ++i)
+  {
+    if(!m_checkpoint || !m_checkpoint->isDone(i, chunks[i].output)) pending.push_back(i);
+  }
+
+  size_t finished = chunks.size() - pending.size();
+  if(finished > 0)
+  {
+    emit information_message(tr("Processing '%1': resuming from checkpoint, %2 of %3 chunks already transcoded").arg(filename).arg(finished).arg(chunks.size()));
+  }
+  else
+  {
+    emit information_message(tr("Processing '%1': transcoding video in %2 chunks").arg(filename).arg(chunks.size()));
+  }
+
+  // the chunks of a checkpoint are kept to resume the transcoding if interrupted.
+  QStringList files{QString::fromStdWString(audio.output.wstring())};
+  if(!m_checkpoint)
+  {
+    for(const auto &chunk: chunks) files << QString::fromStdWString(chunk.output.wstring());
+  }
+  emit output_files_created(QString::fromStdWString(m_source_info.wstring()), files);
+
+  auto launch = [this](Worker *worker)
+  {
+    connect(worker, SIGNAL(error_message(const QString)), this, SIGNAL(error_message(const QString)), Qt::DirectConnection);
+    worker->set_placement(m_placement, m_node);
+    worker->set_rate_limits(m_frame_limiter, m_byte_limiter);
+    worker->start();
+  };
+
+  auto audioWorker = new Worker(m_source_info, m_configuration, audio, m_budget);
+  launch(audioWorker);
+
+  // without chunked encoding the checkpoint chunks are transcoded one after another.
+  const size_t concurrent = m_configuration.chunkedEncoding() ? m_configuration.numberOfChunks() : 1;
+
+  std::vector<std::pair<size_t, Worker *>> running; // chunk index and worker.
+  size_t next = 0;
+  long long finishedFrames = 0;
+  bool failed = false;
+  bool stopped = false;
+  int progressVal = 0;
+
+  while(!audioWorker->isFinished() || !running.empty() || (next < pending.size() && !failed && !stopped))
+  {
+    while(next < pending.size() && running.size() < concurrent && !failed && !stopped && !has_been_cancelled())
+    {
+      const auto index = pending[next++];
+      auto worker = new Worker(m_source_info, m_configuration, chunks[index], m_budget);
+      launch(worker);
+
+      running.emplace_back(index, worker);
+    }
+
+    if(has_been_cancelled() && !stopped)
+    {
+      audioWorker->stop();
+      for(auto &chunk: running) chunk.second->stop();
+      stopped = true;
+    }
+
+    msleep(250);
+
+    for(auto it = running.begin(); it != running.end();)
+    {
+      auto worker = it->second;
+      if(!worker->isFinished())
+      {
+        ++it;
+        continue;
+      }
+
+      worker->wait();
+      failed |= worker->has_failed();
+      m_bytes_copied += worker->m_bytes_copied;
+      finishedFrames += worker->m_frames;
+
+      if(!worker->has_failed() && !worker->has_been_cancelled())
+      {
+        ++finished;
+
+        if(m_checkpoint)
         {
-          const int currentProgress = m_input_context->pb->pos * 100 / m_input_file.size();
-          if(progressVal != currentProgress)
+          m_checkpoint->setDone(it->first, chunks[it->first].output);
+          if(!m_checkpoint->save())
           {
-            progressVal = currentProgress;
-            emit progress(progressVal);
+            emit error_message(tr("Unable to write the checkpoint file '%1'.").arg(Checkpoint::checkpointFilename(m_source_info)));
           }
+        }
+      }
 
-          if(transcodeAudio || transcodeVideo)
-          {
-            if(m_packet->stream_index == m_audio_stream.id)
-            {
-              if(transcodeAudio)
-              {
-                if(!process_av_packet(m_audio_stream))
-                {
-                  emit error_message(tr("Error transcoding audio frame for file '%1'.").arg(filename));
-                  break;
-                }
-              }
-              else
-              {
-                if(!write_av_packet(m_audio_stream))
-                {
-                  emit error_message(tr("Error copying audio packet to output for file '%1'.").arg(filename));
-                  break;
-                }
-              }
-            }
-            else if(m_packet->stream_index == m_video_stream.id)
-            {
-              if(transcodeVideo)
-              {
-                if(!process_av_packet(m_video_stream))
-                {
-                  emit error_message(tr("Error transcoding video frame for file '%1'.").arg(filename));
-                  break;
-                }
-              }
-              else
-              {
-                if(!write_av_packet(m_video_stream))
-                {
-                  emit error_message(tr("Error copying video packet to output for file '%1'.").arg(filename));
-                  break;
-                }
-              }
-            }
-          }
+      delete worker;
+      it = running.erase(it);
+    }
+
+    // the last 5% is the merge of the chunks.
+    int currentProgress = finished * 100 + audioWorker->m_progress;
+    long long frames = finishedFrames;
+    for(auto &chunk: running)
+    {
+      currentProgress += chunk.second->m_progress;
+      frames += chunk.second->m_frames;
+    }
+    m_frames = frames;
+    currentProgress = (currentProgress * 95) / (100 * static_cast<int>(chunks.size() + 1));
+
+    if(progressVal != currentProgress)
+    {
+      m_progress = progressVal = currentProgress;
+      emit progress(progressVal);
+    }
+  }
+
+  audioWorker->wait();
+  failed |= audioWorker->has_failed() || (finished != chunks.size() && !has_been_cancelled());
+  m_bytes_copied += audioWorker->m_bytes_copied;
+  delete audioWorker;
+
+  if(failed)
+  {
+    emit error_message(tr("Unable to transcode the chunks of file '%1'.").arg(filename));
+    m_fail = true;
+  }
+  else if(!has_been_cancelled())
+  {
+    if(!merge_chunks(chunks, audio))
+    {
+      m_fail = true;
+    }
+    else
+    {
+      emit information_message(tr("'%1': %2 bytes of frame data copied.").arg(filename).arg(m_bytes_copied.load()));
+    }
+  }
+
+  const auto keepCheckpoint = m_checkpoint && has_been_cancelled() && !failed && finished > 0;
+
+  for(size_t i = 0; i < chunks.size(); ++i)
+  {
+    if(!keepCheckpoint || !m_checkpoint->isDone(i, chunks[i].output))
+    {
+      QFile::remove(QString::fromStdWString(chunks[i].output.wstring()));
+    }
+  }
+  QFile::remove(QString::fromStdWString(audio.output.wstring()));
+
+  if(keepCheckpoint)
+  {
+    emit information_message(tr("'%1': %2 of %3 chunks kept to resume the transcoding.").arg(filename).arg(finished).arg(chunks.size()));
+  }
+  else if(m_checkpoint)
+  {
+    m_checkpoint->remove();
+  }
+}
+
+//--------------------------------------------------------------------
+bool Worker::merge_chunks(const std::vector<Chunk> &chunks, const Chunk &audio)
+{
+  const auto filename = output_video_filename();
+
+  // video chunks have a single stream, the audio chunk also has the copied audio streams.
+  auto open_chunk = [this](const Chunk &chunk, AVFormatContext **context)
+  {
+    const auto name = QString::fromStdWString(chunk.output.wstring());
+    const unsigned int streams = (chunk.type == Chunk::Type::AUDIO) ? 1 + m_extra_audio_streams.size() : 1;
+
+    auto value = avformat_open_input(context, name.toStdString().c_str(), nullptr, nullptr);
+    if(value >= 0) value = avformat_find_stream_info(*context, nullptr);
+    if(value >= 0 && (*context)->nb_streams != streams) value = AVERROR_STREAM_NOT_FOUND;
+
+    if(value < 0)
+    {
+      emit error_message(tr("Unable to open chunk file '%1'. Error: %2.").arg(name).arg(av_error_string(value)));
+      if(*context) avformat_close_input(context);
+      return false;
+    }
+
+    return true;
+  };
+
+  AVFormatContext *audioInput  = nullptr;
+  AVFormatContext *videoInput  = nullptr;
+  AVFormatContext *output      = nullptr;
+  AVPacket        *audioPacket = av_packet_alloc();
+  AVPacket        *videoPacket = av_packet_alloc();
+  std::unique_ptr<OutputWriter> writer;
+
+  auto release = [&]()
+  {
+    if(audioInput) avformat_close_input(&audioInput);
+    if(videoInput) avformat_close_input(&videoInput);
+    if(writer) writer->close();
+    if(output) avformat_free_context(output);
+    av_packet_free(&audioPacket);
+    av_packet_free(&videoPacket);
+  };
+
+  if(!audioPacket || !videoPacket || !open_chunk(audio, &audioInput) || !open_chunk(chunks.front(), &videoInput))
+  {
+    release();
+    return false;
+  }
+
+  output = avformat_alloc_context();
+  if(!output || !(output->oformat = av_guess_format(nullptr, filename.toStdString().c_str(), nullptr)))
+  {
+    emit error_message(tr("Unable to allocate output context for file: '%1'.").arg(filename));
+    release();
+    return false;
+  }
+  strcpy(output->filename, filename.toStdString().c_str());
+
+  auto videoOut = avformat_new_stream(output, nullptr);
+  bool created  = videoOut && avcodec_parameters_copy(videoOut->codecpar, videoInput->streams[0]->codecpar) >= 0;
+
+  std::vector<AVStream *> audioOut;
+  for(unsigned int i = 0; created && i < audioInput->nb_streams; ++i)
+  {
+    auto stream = avformat_new_stream(output, nullptr);
+    created = stream && avcodec_parameters_copy(stream->codecpar, audioInput->streams[i]->codecpar) >= 0;
+
+    if(created)
+    {
+      const auto language = stream_language(audioInput->streams[i]);
+      if(!language.isEmpty()) av_dict_set(&stream->metadata, "language", language.toLatin1().constData(), 0);
+
+      stream->time_base = audioInput->streams[i]->time_base;
+      audioOut.push_back(stream);
+    }
+  }
+
+  if(!created)
+  {
+    emit error_message(tr("Unable to create the output streams for file '%1'.").arg(filename));
+    release();
+    return false;
+  }
+
+  videoOut->time_base = videoInput->streams[0]->time_base;
+
+  writer = create_output_writer(filename);
+  if(!writer)
+  {
+    release();
+    return false;
+  }
+  output->pb = writer->context();
+
+  auto value = avformat_write_header(output, nullptr);
+  if(value < 0)
+  {
+    emit error_message(tr("Error opening output file '%1'. Error: %2.").arg(filename).arg(av_error_string(value)));
+    release();
+    return false;
+  }
+
+  size_t current     = 0;            // current video chunk.
+  long long offset   = 0;            // timestamp offset of the current video chunk.
+  long long base     = NO_PTS_VALUE; // first timestamp of the current video chunk.
+  long long next     = 0;            // end timestamp of the video chunks read so far.
+  bool videoPending  = false;        // true if videoPacket contains a packet to write.
+  bool audioPending  = false;        // true if audioPacket contains a packet to write.
+
+  // reads the next video packet, moving to the next chunk when one ends. The timestamps of each chunk are
+  // rebased to start at the end of the previous ones, whatever their first value.
+  auto read_video = [&]()
+  {
+    videoPending = false;
 
-          if(extractSubtitles && m_packet->stream_index == m_subtitle_stream.id)
-          {
-            write_srt_packet();
-          }
+    while(videoInput)
+    {
+      value = av_read_frame(videoInput, videoPacket);
+      if(value == 0)
+      {
+        if(base == NO_PTS_VALUE) base = (videoPacket->dts != NO_PTS_VALUE) ? videoPacket->dts : videoPacket->pts;
+        if(base == NO_PTS_VALUE) base = 0;
 
-          av_packet_unref(m_packet);
-        }
+        if(videoPacket->pts != NO_PTS_VALUE) videoPacket->pts += offset - base;
+        if(videoPacket->dts != NO_PTS_VALUE) videoPacket->dts += offset - base;
 
-        if(value == AVERROR_EOF)
-        {
-          flush_streams();
-        }
-        else if(value < 0)
-        {
-          emit error_message(tr("Error while transcoding '%1'. Error is: %2.").arg(m_input_file.fileName()).arg(av_error_string(value)));
-          m_fail = true;
-        }
+        next = std::max(next, static_cast<long long>(std::max(videoPacket->pts, videoPacket->dts) + videoPacket->duration));
+        videoPending = true;
+        return true;
       }
-      else
+
+      if(value != AVERROR_EOF) return false;
+
+      avformat_close_input(&videoInput);
+      if(++current < chunks.size())
       {
-        emit error_message(tr("Unable to create output or configure it for file: '%1'").arg(m_input_file.fileName()));
-        m_fail = true;
+        if(!open_chunk(chunks.at(current), &videoInput)) return false;
+        offset = next;
+        base   = NO_PTS_VALUE;
       }
     }
-    else
+
+    return true;
+  };
+
+  auto read_audio = [&]()
+  {
+    value = av_read_frame(audioInput, audioPacket);
+    audioPending = (value == 0);
+
+    return (value == 0 || value == AVERROR_EOF);
+  };
+
+  bool result = read_video() && read_audio();
+  while(result && (videoPending || audioPending) && !has_been_cancelled())
+  {
+    // write the packet with the lowest timestamp first to keep the interleaving queue small.
+    auto writeVideo = videoPending;
+    if(videoPending && audioPending)
     {
-      emit information_message(tr("Not processed: '%1' is already in the correct format for Chromecast").arg(m_input_file.fileName()));
+      writeVideo = av_compare_ts(videoPacket->dts, videoInput->streams[0]->time_base, audioPacket->dts, audioInput->streams[audioPacket->stream_index]->time_base) <= 0;
     }
 
-    deinit_libav();
+    auto packet = writeVideo ? videoPacket : audioPacket;
+    auto input  = writeVideo ? videoInput->streams[0] : audioInput->streams[audioPacket->stream_index];
+    auto stream = writeVideo ? videoOut : audioOut.at(audioPacket->stream_index);
+
+    av_packet_rescale_ts(packet, input->time_base, stream->time_base);
+    packet->stream_index = stream->index;
+
+    value = av_interleaved_write_frame(output, packet);
+    if(value < 0) break;
+
+    result = writeVideo ? read_video() : read_audio();
   }
-  else
+
+  if(value >= 0 || value == AVERROR_EOF) value = av_write_trailer(output);
+
+  if(!result || value < 0)
   {
-    m_fail = true;
+    emit error_message(tr("Error merging the chunks of file '%1'. Error: %2.").arg(filename).arg(av_error_string(value)));
+    release();
+    return false;
   }
 
-  if(m_stop)
+  if(!writer->close())
   {
-    // If cancelled remove output files.
-    QStringList files;
-
-    const auto output_video = QString::fromStdWString(m_source_info.wstring() + VIDEO_EXTENSION);
+    emit error_message(tr("Error writing file '%1'. Error: %2.").arg(filename).arg(writer->errorString()));
+    release();
+    return false;
+  }
 
-    if(QFile::exists(output_video))
-    {
-      if(!QFile::remove(output_video))
-      {
-        emit error_message(tr("Unable to remove output file: '%1'").arg(output_video));
-      }
-    }
+  release();
+  return true;
+}
 
-    if(m_subtitle_file.isOpen())
-    {
-      m_subtitle_file.close();
-      if(!m_subtitle_file.remove())
-      {
-        emit error_message(tr("Unable to remove output file: '%1'").arg(m_subtitle_file.fileName()));
-      }
-    }
+//--------------------------------------------------------------------
+QString Worker::output_video_filename() const
+{
+  if(m_chunk.type != Chunk::Type::NONE)
+  {
+    return QString::fromStdWString(m_chunk.output.wstring());
   }
 
-  emit progress(100);
+  return QString::fromStdWString(Utils::outputFile(m_source_info).wstring());
 }
 
 //--------------------------------------------------------------------
@@ -259,16 +1014,19 @@ bool Worker::check_input_file_permissions()
 //--------------------------------------------------------------------
 bool Worker::check_output_file_permissions()
 {
+  // the parent worker has already checked the final output files.
+  if(m_chunk.type != Chunk::Type::NONE) return true;
+
   QStringList files;
 
   if(needsAudioProcessing() || needsVideoProcessing())
   {
-    files << QString::fromStdWString(m_source_info.wstring() + VIDEO_EXTENSION);
+    files << QString::fromStdWString(Utils::outputFile(m_source_info).wstring());
   }
 
   if(needsSubtitleProcessing())
   {
-    files << QString::fromStdWString(m_source_info.wstring() + SUBTITLE_EXTENSION);
+    for(const auto &track: m_subtitle_tracks) files << track.filename;
   }
 
   for(const auto filename: files)
@@ -278,9 +1036,25 @@ bool Worker::check_output_file_permissions()
     if(outputFile.exists())
     {
       const auto fn = std::filesystem::path{filename.toStdWString()};
-      emit error_message(QString("Output file '%1' exists.").arg(QString::fromStdWString(fn.filename())));
-      m_fail = true;
-      return false;
+
+      if(!m_replace_outputs)
+      {
+        emit error_message(QString("Output file '%1' exists.").arg(QString::fromStdWString(fn.filename())));
+        m_fail = true;
+        return false;
+      }
+
+      // set aside until the new one is complete.
+      QFile::remove(filename + PREVIOUS_SUFFIX);
+      if(!outputFile.rename(filename + PREVIOUS_SUFFIX))
+      {
+        emit error_message(QString("Unable to replace output file '%1'.").arg(QString::fromStdWString(fn.filename())));
+        m_fail = true;
+        return false;
+      }
+
+      outputFile.setFileName(filename);
+      m_replaced << filename;
     }
 
     if(!outputFile.open(QFile::WriteOnly|QFile::Truncate))
@@ -294,9 +1068,37 @@ bool Worker::check_output_file_permissions()
     outputFile.remove();
   }
 
+  if(!files.isEmpty()) emit output_files_created(QString::fromStdWString(m_source_info.wstring()), files);
+
   return true;
 }
 
+//--------------------------------------------------------------------
+void Worker::finish_replaced_outputs()
+{
+  const bool completed = !m_fail && !m_stop;
+
+  for(const auto &filename: m_replaced)
+  {
+    const auto previous = filename + PREVIOUS_SUFFIX;
+
+    if(completed)
+    {
+      QFile::remove(previous);
+    }
+    else
+    {
+      QFile::remove(filename);
+      if(!QFile::rename(previous, filename))
+      {
+        emit error_message(tr("Unable to restore the previous output file: '%1'").arg(filename));
+      }
+    }
+  }
+
+  m_replaced.clear();
+}
+
 //--------------------------------------------------------------------
 bool Worker::init_libav()
 {
@@ -310,10 +1112,19 @@ bool Worker::init_libav()
   //av_log_set_callback(log_callback);
 
   const auto source_name = QString::fromStdWString(m_source_info.wstring());
-  m_input_file.setFileName(source_name);
-  if(!m_input_file.open(QIODevice::ReadOnly))
+  if(m_configuration.prefetchInput())
+  {
+    const auto blockSize = m_configuration.inputBlockSize() * 1024 * 1024;
+    m_input_reader = std::make_unique<PrefetchInputReader>(source_name, blockSize, m_configuration.prefetchDepth());
+  }
+  else
+  {
+    m_input_reader = std::make_unique<MappedInputReader>(source_name);
+  }
+
+  if(!m_input_reader->open())
   {
-    emit error_message(QString("Couldn't open input file '%1'.").arg(source_name));
+    emit error_message(QString("Couldn't open input file '%1'. Error is \"%2\".").arg(source_name).arg(m_input_reader->errorString()));
     return false;
   }
 
@@ -324,14 +1135,14 @@ bool Worker::init_libav()
     return false;
   }
 
-  auto avioContext = avio_alloc_context(ioBuffer, s_io_buffer_size - AV_INPUT_BUFFER_PADDING_SIZE, 0, reinterpret_cast<void*>(&m_input_file), &custom_IO_read, nullptr, &custom_IO_seek);
+  auto avioContext = avio_alloc_context(ioBuffer, s_io_buffer_size - AV_INPUT_BUFFER_PADDING_SIZE, 0, reinterpret_cast<void*>(m_input_reader.get()), &InputReader::read_callback, nullptr, &InputReader::seek_callback);
   if(!avioContext)
   {
     emit error_message(QString("Couldn't allocate context for custom libav IO for file: '%1'.").arg(source_name));
     return false;
   }
 
-  avioContext->seekable = 0;
+  avioContext->seekable = AVIO_SEEKABLE_NORMAL;
   avioContext->write_flag = 0;
 
   m_input_context = avformat_alloc_context();
@@ -351,199 +1162,471 @@ bool Worker::init_libav()
     return false;
   }
 
-  // avoids a warning message from libav when the duration can't be calculated accurately. this increases the lookup frames.
-  m_input_context->max_analyze_duration *= 1000;
+  // the decision about what has to be processed is taken from the container headers, the streams are
+  // analyzed only if those are incomplete or if the audio or video have to be decoded. Extracting the
+  // subtitles only needs the headers.
+  auto deepAnalysis = headers_are_ambiguous();
+  if(deepAnalysis && !analyze_streams()) return false;
+
+  select_streams();
+
+  if(!deepAnalysis && (needsAudioProcessing() || needsVideoProcessing()))
+  {
+    if(!analyze_streams()) return false;
+    select_streams();
+  }
+
+  if (m_audio_stream.id < 0)
+  {
+    emit error_message(QString("Couldn't find any suitable audio stream in '%1'.").arg(source_name));
+    return false;
+  }
+
+  if (m_video_stream.id < 0)
+  {
+    emit error_message(QString("Couldn't find any video stream in '%1'. Error is \"%2\".").arg(source_name).arg(av_error_string(m_video_stream.id)));
+    return false;
+  }
+
+  m_packet = av_packet_alloc();
+  if(!m_packet)
+  {
+    emit error_message(QString("Couldn't allocate packet for '%1'.").arg(source_name));
+    return false;
+  }
+
+  m_probe.audioCodec    = m_input_context->streams[m_audio_stream.id]->codecpar->codec_id;
+  m_probe.audioChannels = m_input_context->streams[m_audio_stream.id]->codecpar->channels;
+  m_probe.videoCodec    = m_input_context->streams[m_video_stream.id]->codecpar->codec_id;
+  m_probe.audio         = needsAudioProcessing();
+  m_probe.video         = needsVideoProcessing();
+  m_probe.subtitle      = needsSubtitleProcessing();
+  m_probe.valid         = true;
 
-  value = avformat_find_stream_info(m_input_context, nullptr);
+  discard_unused_streams();
+
+  return true;
+}
+
+//--------------------------------------------------------------------
+void Worker::discard_unused_streams()
+{
+  // the demuxer skips the packets of discarded streams instead of returning them.
+  m_discarded_streams = 0;
+
+  // audio and video are only read if there is an output video file.
+  const bool muxing = needsAudioProcessing() || needsVideoProcessing();
+
+  for(unsigned int id = 0; id < m_input_context->nb_streams; ++id)
+  {
+    const auto index = static_cast<int>(id);
+
+    bool used = false;
+    if(index == m_video_stream.id)    used = muxing && (m_chunk.type != Chunk::Type::AUDIO);
+    if(index == m_audio_stream.id)    used = muxing && (m_chunk.type != Chunk::Type::VIDEO);
+    if(extra_audio_index(index) >= 0) used = muxing && (m_chunk.type != Chunk::Type::VIDEO);
+    if(subtitle_track_index(index) >= 0) used = (m_chunk.type != Chunk::Type::VIDEO) && needsSubtitleProcessing();
+
+    m_input_context->streams[id]->discard = used ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    if(!used) ++m_discarded_streams;
+  }
+}
+
+//--------------------------------------------------------------------
+bool Worker::analyze_streams()
+{
+  // the default analysis duration is enough to get the codec parameters of the streams.
+  const auto value = avformat_find_stream_info(m_input_context, nullptr);
   if(value < 0)
   {
+    const auto source_name = QString::fromStdWString(m_source_info.wstring());
     emit error_message(QString("Couldn't get the information of '%1'. Error is \"%2\".").arg(source_name).arg(av_error_string(value)));
     return false;
   }
 
-  for(unsigned int id = 0; id < m_input_context->nb_streams; id++)
+  return true;
+}
+
+//--------------------------------------------------------------------
+bool Worker::headers_are_ambiguous() const
+{
+  // containers without a global header only declare their streams when their packets are read.
+  if((m_input_context->ctx_flags & AVFMTCTX_NOHEADER) || m_input_context->nb_streams == 0) return true;
+
+  bool hasAudio = false;
+  bool hasVideo = false;
+
+  for(unsigned int id = 0; id < m_input_context->nb_streams; ++id)
   {
-    if(m_input_context->streams[id]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+    const auto parameters = m_input_context->streams[id]->codecpar;
+    if(parameters->codec_id == AV_CODEC_ID_NONE) return true;
+
+    switch(parameters->codec_type)
     {
-      if(m_audio_stream.id == AVERROR_STREAM_NOT_FOUND)
-      {
-        m_audio_stream.id = id;
-      }
+      case AVMEDIA_TYPE_AUDIO:
+        if(parameters->channels <= 0 || parameters->sample_rate <= 0) return true;
+        hasAudio = true;
+        break;
+      case AVMEDIA_TYPE_VIDEO:
+        if(parameters->width <= 0 || parameters->height <= 0) return true;
+        hasVideo = true;
+        break;
+      default:
+        break;
+    }
+  }
 
-      const auto lang = av_dict_get(m_input_context->streams[id]->metadata, "language", nullptr, 0);
+  return !hasAudio || !hasVideo;
+}
 
-      if(lang)
-      {
-        if((strcmp(lang->value, "spa") == 0) && (m_configuration.preferredAudioLanguage() == Utils::TranscoderConfiguration::Language::SPANISH))
-        {
-          m_audio_stream.id = id;
-          break;
-        }
+//--------------------------------------------------------------------
+void Worker::select_streams()
+{
+  m_audio_stream.id    = AVERROR_STREAM_NOT_FOUND;
+  m_subtitle_stream.id = AVERROR_STREAM_NOT_FOUND;
+  m_extra_audio_streams.clear();
+  m_subtitle_tracks.clear();
 
-        if((strcmp(lang->value, "eng") == 0) && (m_configuration.preferredAudioLanguage() == Utils::TranscoderConfiguration::Language::ENGLISH))
-        {
-          m_audio_stream.id = id;
-          break;
-        }
-      }
+  const auto audioLanguages    = preferred_languages(m_configuration.preferredAudioLanguage());
+  const auto subtitleLanguages = preferred_languages(m_configuration.preferredSubtitleLanguage());
+  const bool allLanguages      = m_configuration.allLanguages() && !m_configuration.languages().isEmpty();
+
+  std::vector<int> audioIds, subtitleIds;
+  for(unsigned int id = 0; id < m_input_context->nb_streams; id++)
+  {
+    switch(m_input_context->streams[id]->codecpar->codec_type)
+    {
+      case AVMEDIA_TYPE_AUDIO:
+        audioIds.push_back(id);
+        break;
+      case AVMEDIA_TYPE_SUBTITLE:
+        if(m_configuration.extractSubtitles()) subtitleIds.push_back(id);
+        break;
+      default:
+        break;
     }
   }
 
-  if (m_audio_stream.id < 0)
+  // position of the language of the stream in the preferences, the size of the list if not preferred.
+  auto rank = [this](const int id, const QStringList &languages)
   {
-    emit error_message(QString("Couldn't find any suitable audio stream in '%1'.").arg(source_name));
-    return false;
+    const auto index = languages.indexOf(stream_language(m_input_context->streams[id]));
+    return index < 0 ? languages.size() : index;
+  };
+
+  // first stream of the most preferred language or the first stream if none is preferred.
+  auto best = [&rank](const std::vector<int> &ids, const QStringList &languages)
+  {
+    int selected = AVERROR_STREAM_NOT_FOUND;
+    for(const auto id: ids)
+    {
+      if(selected == AVERROR_STREAM_NOT_FOUND || rank(id, languages) < rank(selected, languages)) selected = id;
+    }
+
+    return selected;
+  };
+
+  m_audio_stream.id    = best(audioIds, audioLanguages);
+  m_video_stream.id    = av_find_best_stream(m_input_context, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+  m_subtitle_stream.id = best(subtitleIds, subtitleLanguages);
+
+  if(allLanguages)
+  {
+    for(const auto id: audioIds)
+    {
+      if(id == m_audio_stream.id || rank(id, audioLanguages) == audioLanguages.size()) continue;
+
+      Stream stream;
+      stream.id   = id;
+      stream.name = "audio";
+      m_extra_audio_streams.push_back(stream);
+    }
   }
 
+  for(const auto id: subtitleIds)
+  {
+    if(id != m_subtitle_stream.id && (!allLanguages || rank(id, subtitleLanguages) == subtitleLanguages.size())) continue;
+
+    SubtitleTrack track;
+    track.id        = id;
+    track.language  = stream_language(m_input_context->streams[id]);
+    track.time_base = m_input_context->streams[id]->time_base;
+    track.count     = 0;
+    m_subtitle_tracks.push_back(track);
+  }
 
-  av_find_best_stream(m_input_context, AVMEDIA_TYPE_AUDIO, m_audio_stream.id, -1, &m_audio_stream.decoder, 0);
-  if(!m_audio_stream.decoder)
+  // <name>.srt for a single subtitle, <name>.<lang>.srt (plus the stream index if repeated) for several.
+  for(auto &track: m_subtitle_tracks)
   {
-    emit error_message(QString("Couldn't find audio decoder for '%1'.").arg(source_name));
-    return false;
+    auto name = m_source_info.wstring();
+    if(allLanguages)
+    {
+      const auto language = track.language.isEmpty() ? QString("und") : track.language;
+      auto sameLanguage = [&track](const SubtitleTrack &other) { return other.language == track.language; };
+
+      name += L"." + language.toStdWString();
+      if(std::count_if(m_subtitle_tracks.cbegin(), m_subtitle_tracks.cend(), sameLanguage) > 1)
+      {
+        name += L"." + std::to_wstring(track.id);
+      }
+    }
+
+    track.filename = QString::fromStdWString(name + SUBTITLE_EXTENSION);
   }
+}
 
-  m_audio_stream.decoderContext = m_input_context->streams[m_audio_stream.id]->codec;
-  value = avcodec_parameters_to_context(m_audio_stream.decoderContext, m_input_context->streams[m_audio_stream.id]->codecpar);
-  if(value < 0)
+//--------------------------------------------------------------------
+QStringList Worker::preferred_languages(const Utils::TranscoderConfiguration::Language language) const
+{
+  const auto languages = m_configuration.languages();
+  if(!languages.isEmpty()) return languages;
+
+  switch(language)
   {
-    emit error_message(tr("Unable to copy parameters to audio decoder context for '%1'. Error is \"%2\"").arg(source_name).arg(av_error_string(value)));
-    return false;
+    case Utils::TranscoderConfiguration::Language::SPANISH:
+      return QStringList{"spa"};
+    case Utils::TranscoderConfiguration::Language::ENGLISH:
+      return QStringList{"eng"};
+    default:
+      break;
   }
 
-  value = avcodec_open2(m_audio_stream.decoderContext, m_audio_stream.decoder, nullptr);
-  if (value < 0)
+  return QStringList();
+}
+
+//--------------------------------------------------------------------
+QString Worker::stream_language(const AVStream *stream)
+{
+  const auto lang = av_dict_get(stream->metadata, "language", nullptr, 0);
+
+  return lang ? QString::fromLatin1(lang->value).toLower() : QString();
+}
+
+//--------------------------------------------------------------------
+int Worker::extra_audio_index(const int id) const
+{
+  for(size_t i = 0; i < m_extra_audio_streams.size(); ++i)
   {
-    emit error_message(QString("Couldn't open audio decoder for '%1'. Error is \"%2\"").arg(source_name).arg(av_error_string(value)));
-    return false;
+    if(m_extra_audio_streams[i].id == id) return static_cast<int>(i);
   }
 
-  if(!avcodec_is_open(m_audio_stream.decoderContext))
+  return -1;
+}
+
+//--------------------------------------------------------------------
+Worker::Stream *Worker::extra_audio_stream(const int id)
+{
+  const auto index = extra_audio_index(id);
+  if(index < 0 || !m_extra_audio_streams[index].stream) return nullptr;
+
+  return &m_extra_audio_streams[index];
+}
+
+//--------------------------------------------------------------------
+int Worker::subtitle_track_index(const int id) const
+{
+  for(size_t i = 0; i < m_subtitle_tracks.size(); ++i)
   {
-    emit error_message(QString("Couldn't open audio decoder for '%1'.").arg(source_name));
-    return false;
+    if(m_subtitle_tracks[i].id == id) return static_cast<int>(i);
   }
 
-  m_video_stream.id = av_find_best_stream(m_input_context, AVMEDIA_TYPE_VIDEO, -1, -1, &m_video_stream.decoder, 0);
-  if (m_video_stream.id < 0)
+  return -1;
+}
+
+//--------------------------------------------------------------------
+bool Worker::has_subtitle_files() const
+{
+  auto isOpen = [](const SubtitleTrack &track) { return track.file && track.file->isOpen(); };
+
+  return std::any_of(m_subtitle_tracks.cbegin(), m_subtitle_tracks.cend(), isOpen);
+}
+
+//--------------------------------------------------------------------
+bool Worker::init_decoders()
+{
+  QMutexLocker lock(&Utils::s_mutex);
+
+  const auto source_name = QString::fromStdWString(m_source_info.wstring());
+  int value = 0;
+
+  // decoders are only opened for the streams that are transcoded.
+  const bool decodeAudio = needsAudioProcessing() && m_chunk.type != Chunk::Type::VIDEO;
+  const bool decodeVideo = needsVideoProcessing() && m_chunk.type != Chunk::Type::AUDIO;
+
+  if(m_budget)
   {
-    emit error_message(QString("Couldn't find any video stream in '%1'. Error is \"%2\".").arg(source_name).arg(av_error_string(m_video_stream.id)));
-    return false;
+    const auto parameters = m_input_context->streams[m_video_stream.id]->codecpar;
+    const auto complex    = (videoCodecId() == AV_CODEC_ID_VP9 || videoCodecId() == AV_CODEC_ID_HEVC);
+
+    m_threads = m_budget->acquire(decodeVideo ? ThreadBudget::wantedThreads(parameters->width, parameters->height, complex) : 1);
   }
 
-  if(!m_video_stream.decoder)
+  if(decodeAudio)
   {
-    emit error_message(QString("Couldn't find video decoder for '%1'.").arg(source_name));
-    return false;
+    av_find_best_stream(m_input_context, AVMEDIA_TYPE_AUDIO, m_audio_stream.id, -1, &m_audio_stream.decoder, 0);
+    if(!m_audio_stream.decoder)
+    {
+      emit error_message(QString("Couldn't find audio decoder for '%1'.").arg(source_name));
+      return false;
+    }
+
+    m_audio_stream.decoderContext = m_input_context->streams[m_audio_stream.id]->codec;
+    value = avcodec_parameters_to_context(m_audio_stream.decoderContext, m_input_context->streams[m_audio_stream.id]->codecpar);
+    if(value < 0)
+    {
+      emit error_message(tr("Unable to copy parameters to audio decoder context for '%1'. Error is \"%2\"").arg(source_name).arg(av_error_string(value)));
+      return false;
+    }
+
+    // decoded frames are reference counted, they're moved through the filters to the encoder without copies.
+    m_audio_stream.decoderContext->refcounted_frames = 1;
+
+    value = avcodec_open2(m_audio_stream.decoderContext, m_audio_stream.decoder, nullptr);
+    if (value < 0)
+    {
+      emit error_message(QString("Couldn't open audio decoder for '%1'. Error is \"%2\"").arg(source_name).arg(av_error_string(value)));
+      return false;
+    }
+
+    if(!avcodec_is_open(m_audio_stream.decoderContext))
+    {
+      emit error_message(QString("Couldn't open audio decoder for '%1'.").arg(source_name));
+      return false;
+    }
   }
 
-  m_video_stream.decoderContext = m_input_context->streams[m_video_stream.id]->codec;
-  value = avcodec_parameters_to_context(m_video_stream.decoderContext, m_input_context->streams[m_video_stream.id]->codecpar);
-  if(value < 0)
-  {
-    emit error_message(tr("Unable to copy parameters to video decoder context for '%1'. Error is \"%2\"").arg(source_name).arg(av_error_string(value)));
-    return false;
-  }
+  if(decodeVideo)
+  {
+    m_video_stream.decoder = avcodec_find_decoder(m_input_context->streams[m_video_stream.id]->codecpar->codec_id);
+    if(!m_video_stream.decoder)
+    {
+      emit error_message(QString("Couldn't find video decoder for '%1'.").arg(source_name));
+      return false;
+    }
+
+    m_video_stream.decoderContext = m_input_context->streams[m_video_stream.id]->codec;
+    value = avcodec_parameters_to_context(m_video_stream.decoderContext, m_input_context->streams[m_video_stream.id]->codecpar);
+    if(value < 0)
+    {
+      emit error_message(tr("Unable to copy parameters to video decoder context for '%1'. Error is \"%2\"").arg(source_name).arg(av_error_string(value)));
+      return false;
+    }
+
+    m_video_stream.decoderContext->framerate = m_input_context->streams[m_video_stream.id]->avg_frame_rate;
+    m_video_stream.decoderContext->refcounted_frames = 1;
 
-  m_video_stream.decoderContext->framerate = m_input_context->streams[m_video_stream.id]->avg_frame_rate;
+    // a third of the granted threads decode, the rest encode.
+    if(m_threads > 0) m_video_stream.decoderContext->thread_count = std::max(1, m_threads / 3);
 
-  value = avcodec_open2(m_video_stream.decoderContext, m_video_stream.decoder, nullptr);
-  if (value < 0 || !avcodec_is_open(m_video_stream.decoderContext))
-  {
-    emit error_message(QString("Couldn't open video decoder for '%1'. Error is \"%2\"").arg(source_name).arg(av_error_string(value)));
-    return false;
+    value = avcodec_open2(m_video_stream.decoderContext, m_video_stream.decoder, nullptr);
+    if (value < 0 || !avcodec_is_open(m_video_stream.decoderContext))
+    {
+      emit error_message(QString("Couldn't open video decoder for '%1'. Error is \"%2\"").arg(source_name).arg(av_error_string(value)));
+      return false;
+    }
   }
 
-  if(m_configuration.extractSubtitles())
+  if(m_subtitle_stream.id != AVERROR_STREAM_NOT_FOUND)
   {
-    for(unsigned int id = 0; id < m_input_context->nb_streams; id++)
-    {
-      if(m_input_context->streams[id]->codecpar->codec_type == AVMEDIA_TYPE_SUBTITLE)
-      {
-        if(m_subtitle_stream.id == AVERROR_STREAM_NOT_FOUND)
-        {
-          m_subtitle_stream.id = id;
-        }
-
-        const auto lang = av_dict_get(m_input_context->streams[id]->metadata, "language", nullptr, 0);
-
-        if(lang)
-        {
-          if((strcmp(lang->value, "spa") == 0) && (m_configuration.preferredSubtitleLanguage() == Utils::TranscoderConfiguration::Language::SPANISH))
-          {
-            m_subtitle_stream.id = id;
-            break;
-          }
+    av_find_best_stream(m_input_context, AVMEDIA_TYPE_SUBTITLE, m_subtitle_stream.id, -1, &m_subtitle_stream.decoder, 0);
 
-          if((strcmp(lang->value, "eng") == 0) && (m_configuration.preferredSubtitleLanguage() == Utils::TranscoderConfiguration::Language::ENGLISH))
-          {
-            m_subtitle_stream.id = id;
-            break;
-          }
-        }
-      }
+    if(!m_subtitle_stream.decoder)
+    {
+      emit error_message(QString("Couldn't find a suitable subtitle decoder for '%1'.").arg(source_name));
+      return false;
     }
 
-    if(m_subtitle_stream.id != AVERROR_STREAM_NOT_FOUND)
+    m_subtitle_stream.decoderContext = m_input_context->streams[m_subtitle_stream.id]->codec;
+    value = avcodec_parameters_to_context(m_subtitle_stream.decoderContext, m_input_context->streams[m_subtitle_stream.id]->codecpar);
+    if(value < 0)
     {
-      av_find_best_stream(m_input_context, AVMEDIA_TYPE_SUBTITLE, m_subtitle_stream.id, -1, &m_subtitle_stream.decoder, 0);
+      emit error_message(tr("Unable to copy parameters to subtitle decoder context for '%1'. Error is \"%2\"").arg(source_name).arg(av_error_string(value)));
+      return false;
+    }
 
-      if(!m_subtitle_stream.decoder)
-      {
-        emit error_message(QString("Couldn't find a suitable subtitle decoder for '%1'.").arg(source_name));
-        return false;
-      }
+    compute_subtitle_start();
+  }
 
-      m_subtitle_stream.decoderContext = m_input_context->streams[m_subtitle_stream.id]->codec;
-      value = avcodec_parameters_to_context(m_subtitle_stream.decoderContext, m_input_context->streams[m_subtitle_stream.id]->codecpar);
+  if(m_chunk.type != Chunk::Type::NONE)
+  {
+    const auto start_time = m_input_context->streams[m_video_stream.id]->start_time;
+    if(m_chunk.type == Chunk::Type::VIDEO && (start_time == NO_PTS_VALUE || m_chunk.start > start_time))
+    {
+      value = av_seek_frame(m_input_context, m_video_stream.id, m_chunk.start, AVSEEK_FLAG_BACKWARD);
       if(value < 0)
       {
-        emit error_message(tr("Unable to copy parameters to subtitle decoder context for '%1'. Error is \"%2\"").arg(source_name).arg(av_error_string(value)));
+        emit error_message(QString("Couldn't seek to the start of the video chunk in '%1'. Error is \"%2\".").arg(source_name).arg(av_error_string(value)));
         return false;
       }
+    }
+  }
 
-      long long int min_pts = std::numeric_limits<long long int>::max();
-      for(unsigned int i = 0; i < m_input_context->nb_streams; ++i)
-      {
-        const auto stream_start_pts = m_input_context->streams[i]->first_dts;
-        if(stream_start_pts == NO_PTS_VALUE) continue;
-
-        min_pts = std::min(min_pts, stream_start_pts);
-      }
+  for(auto stream: {&m_audio_stream, &m_video_stream})
+  {
+    stream->frame  = av_frame_alloc();
+    stream->packet = av_packet_alloc();
 
-      if(min_pts != std::numeric_limits<long long int>::max())
-      {
-        m_subtitle_stream.start_dts = min_pts;
-      }
+    if(!stream->frame || !stream->packet)
+    {
+      emit error_message(QString("Couldn't allocate frame and packet buffers for '%1'.").arg(source_name));
+      return false;
     }
   }
 
-  m_packet = av_packet_alloc();
-  av_init_packet(m_packet);
-  m_frame  = av_frame_alloc();
+  return true;
+}
+
+//--------------------------------------------------------------------
+void Worker::compute_subtitle_start()
+{
+  long long int min_pts = std::numeric_limits<long long int>::max();
+  for(unsigned int i = 0; i < m_input_context->nb_streams; ++i)
+  {
+    // the first timestamp is only known if the streams have been analyzed, the headers can declare the start.
+    auto stream_start_pts = m_input_context->streams[i]->first_dts;
+    if(stream_start_pts == NO_PTS_VALUE) stream_start_pts = m_input_context->streams[i]->start_time;
+    if(stream_start_pts == NO_PTS_VALUE) continue;
 
-  m_packet->data = nullptr;
-  m_packet->size = 0;
+    min_pts = std::min(min_pts, stream_start_pts);
+  }
 
-  return true;
+  if(min_pts != std::numeric_limits<long long int>::max())
+  {
+    m_subtitle_stream.start_dts = min_pts;
+  }
 }
 
 //--------------------------------------------------------------------
 void Worker::deinit_libav()
 {
-  if(m_input_file.isOpen())
+  if(m_budget && m_threads > 0)
   {
-    m_input_file.close();
+    m_budget->release(m_threads);
+    m_threads = 0;
   }
 
   if(m_input_context)
   {
-    if(m_input_context->pb && m_input_context->pb->buffer)
+    auto ioContext = m_input_context->pb;
+    avformat_close_input(&m_input_context);
+
+    if(ioContext)
+    {
+      av_freep(&ioContext->buffer);
+      av_freep(&ioContext);
+    }
+  }
+
+  if(m_input_reader)
+  {
+    const auto statistics = m_input_reader->statistics();
+    if(!statistics.isEmpty() && m_chunk.type == Chunk::Type::NONE)
     {
-      av_free(m_input_context->pb->buffer);
-      m_input_context->pb->buffer = nullptr;
+      emit information_message(tr("'%1': %2").arg(QString::fromStdWString(m_source_info.wstring())).arg(statistics));
     }
-    avformat_close_input(&m_input_context);
+
+    m_input_reader->close();
+    m_input_reader.reset();
   }
 
   if(m_output_context && !m_fail)
@@ -554,15 +1637,19 @@ void Worker::deinit_libav()
       const auto filename = QString::fromStdWString(m_source_info.wstring());
       emit error_message(tr("Unable to write trailer for video file for '%1' Error: %2.").arg(filename).arg(av_error_string(value)));
     }
+  }
 
-    if (!(m_output_context->oformat->flags & AVFMT_NOFILE))
+  if(m_output_writer)
+  {
+    if(!m_output_writer->close() && !m_fail)
     {
-      if((value = avio_close(m_output_context->pb)) < 0)
-      {
-        const auto filename = QString::fromStdWString(m_source_info.wstring());
-        emit error_message(tr("Unable to close video file for '%1' Error: %2.").arg(filename).arg(av_error_string(value)));
-      }
+      const auto filename = QString::fromStdWString(m_source_info.wstring());
+      emit error_message(tr("Unable to write video file for '%1' Error: %2.").arg(filename).arg(m_output_writer->errorString()));
+      m_fail = true;
     }
+
+    m_output_writer.reset();
+    if(m_output_context) m_output_context->pb = nullptr;
   }
 
   for(auto graph: {m_audio_stream.filter_graph, m_video_stream.filter_graph})
@@ -577,36 +1664,13 @@ void Worker::deinit_libav()
     if(context) avformat_free_context(context);
   }
 
-  if(m_frame)  av_frame_free(&m_frame);
-  if(m_packet) av_packet_free(&m_packet);
-}
-
-//-----------------------------------------------------------------
-int Worker::custom_IO_read(void* opaque, unsigned char* buffer, int buffer_size)
-{
-  auto reader = reinterpret_cast<QFile *>(opaque);
-  return reader->read(reinterpret_cast<char *>(buffer), buffer_size);
-}
-
-//-----------------------------------------------------------------
-long long int Worker::custom_IO_seek(void* opaque, long long int offset, int whence)
-{
-  auto reader = reinterpret_cast<QFile *>(opaque);
-  switch(whence)
-  {
-    case AVSEEK_SIZE:
-      return reader->size();
-    case SEEK_SET:
-      return reader->seek(offset);
-    case SEEK_END:
-      return reader->seek(reader->size());
-    case SEEK_CUR:
-      return reader->pos();
-      break;
-    default:
-      Q_ASSERT(false);
+  for(auto stream: {&m_audio_stream, &m_video_stream})
+  {
+    if(stream->frame)  av_frame_free(&stream->frame);
+    if(stream->packet) av_packet_free(&stream->packet);
   }
-  return 0;
+
+  if(m_packet) av_packet_free(&m_packet);
 }
 
 //-----------------------------------------------------------------
@@ -656,7 +1720,7 @@ bool Worker::create_output()
 
   if(needsAudioProcessing() || needsVideoProcessing())
   {
-    const auto filename = QString::fromStdWString(m_source_info.wstring() + VIDEO_EXTENSION);
+    const auto filename = output_video_filename();
     auto format = av_guess_format(nullptr, filename.toStdString().c_str(), nullptr);
     if(!format)
     {
@@ -683,234 +1747,325 @@ bool Worker::create_output()
     m_audio_stream.output_file = m_output_context;
     m_audio_stream.time_base   = m_input_context->streams[m_audio_stream.id]->time_base;
 
-    if(needsVideoProcessing())
+    if(m_chunk.type != Chunk::Type::AUDIO)
     {
-      m_output_context->video_codec_id = format->video_codec = videoCodecId();
+      if(!create_video_stream(filename)) return false;
+    }
 
-      m_video_stream.encoder = avcodec_find_encoder(videoCodecId());
-      if(!m_video_stream.encoder)
-      {
-        emit error_message(tr("Unable to find video encoder for file '%1'.").arg(filename));
-        return false;
-      }
+    if(m_chunk.type != Chunk::Type::VIDEO)
+    {
+      if(!create_audio_stream(filename) || !create_extra_audio_streams(filename)) return false;
+    }
+
+    // open the output file, if needed.
+    if (!(format->flags & AVFMT_NOFILE))
+    {
+      m_output_writer = create_output_writer(filename);
+      if(!m_output_writer) return false;
+
+      m_output_context->pb = m_output_writer->context();
+    }
+
+    const auto value = avformat_write_header(m_output_context, nullptr);
+    if(value < 0)
+    {
+      emit error_message(tr("Unable to write header of file '%1'.").arg(filename));
+      return false;
+    }
+  }
 
-      m_video_stream.stream = avformat_new_stream(m_output_context, m_video_stream.encoder);
-      if(!m_video_stream.stream)
+  if(needsSubtitleProcessing() && m_chunk.type != Chunk::Type::VIDEO)
+  {
+    for(auto &track: m_subtitle_tracks)
+    {
+      if(m_input_context->streams[track.id]->codecpar->codec_id != AV_CODEC_ID_SRT)
       {
-        emit error_message(tr("Error creating video stream for file '%1'.").arg(filename));
-        return false;
+        emit information_message(tr("Subtitle exists for file '%1' but it's not in SRT format.").arg(QString::fromStdWString(m_source_info.wstring())));
+        continue;
       }
 
-      m_video_stream.stream->codec = avcodec_alloc_context3(m_video_stream.encoder);
-      if(!m_video_stream.stream->codec)
+      track.file = std::make_shared<QFile>(track.filename);
+      if(!track.file->open(QIODevice::WriteOnly|QIODevice::Unbuffered))
       {
-        emit error_message(tr("Unable to allocate video encoder context for file '%1'.").arg(filename));
+        emit error_message(tr("Unable to create/open subtitle file: '%1'.").arg(track.filename));
         return false;
       }
+    }
+  }
 
-      m_video_stream.encoderContext = m_video_stream.stream->codec;
-
-      m_video_stream.encoderContext->time_base           = m_video_stream.decoderContext->time_base;
-      m_video_stream.encoderContext->width               = m_video_stream.decoderContext->width;
-      m_video_stream.encoderContext->height              = m_video_stream.decoderContext->height;
-      m_video_stream.encoderContext->sample_aspect_ratio = m_video_stream.decoderContext->sample_aspect_ratio;
-      m_video_stream.encoderContext->framerate           = m_video_stream.decoderContext->framerate;
-      m_video_stream.encoderContext->pix_fmt             = m_video_stream.encoder->pix_fmts[0];
-      m_video_stream.encoderContext->bit_rate            = m_video_stream.decoderContext->bit_rate * 0.9;
-      m_video_stream.encoderContext->refcounted_frames   = 0;
-
-      const auto inputStream = m_input_context->streams[m_video_stream.id];
-      m_video_stream.stream->duration       = inputStream->duration;
-      m_video_stream.stream->avg_frame_rate = inputStream->avg_frame_rate;
-      m_video_stream.stream->first_dts      = inputStream->first_dts;
-      m_video_stream.stream->duration       = inputStream->duration;
-      m_video_stream.stream->time_base      = inputStream->time_base;
-      m_video_stream.time_base              = inputStream->time_base;
-
-      if(m_video_stream.encoderContext->bit_rate == 0)
-      {
-        m_video_stream.encoderContext->bit_rate = 1500000;
-      }
+  return true;
+}
 
-      if(inputStream->duration != NO_PTS_VALUE)
-      {
-        m_video_stream.stream->duration = av_rescale_q(inputStream->duration, inputStream->time_base, m_video_stream.time_base);
-      }
+//-----------------------------------------------------------------
+std::unique_ptr<OutputWriter> Worker::create_output_writer(const QString &filename)
+{
+  const auto bufferSize = m_configuration.outputBufferSize() * 1024 * 1024;
 
-      // some formats want stream headers to be separate
-      if (format->flags & AVFMT_GLOBALHEADER) m_video_stream.encoderContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+  auto writer = std::make_unique<OutputWriter>(filename, bufferSize, m_configuration.outputBuffers(), m_configuration.syncOutput());
+  if(!writer->open())
+  {
+    emit error_message(tr("Error opening output file '%1'. Error: %2.").arg(filename).arg(writer->errorString()));
+    return nullptr;
+  }
 
-      AVDictionary *dictionary = nullptr;
-      av_dict_set(&dictionary, "threads", "auto", 0);
+  return writer;
+}
 
-      auto value = avcodec_open2(m_video_stream.stream->codec, m_video_stream.encoder, &dictionary);
-      if(value < 0)
-      {
-        emit error_message(tr("Error opening video context for file '%1'. Error: %2.").arg(filename).arg(av_error_string(value)));
-        return false;
-      }
+//-----------------------------------------------------------------
+bool Worker::create_video_stream(const QString &filename)
+{
+  if(needsVideoProcessing())
+  {
+    m_output_context->video_codec_id = m_output_context->oformat->video_codec = videoCodecId();
 
-      value = avcodec_parameters_from_context(m_video_stream.stream->codecpar, m_video_stream.encoderContext);
-      if(value < 0)
-      {
-        emit error_message(tr("Error copying parameters from video context. Error: %1.").arg(av_error_string(value)));
-        return false;
-      }
+    m_video_stream.encoder = avcodec_find_encoder(videoCodecId());
+    if(!m_video_stream.encoder)
+    {
+      emit error_message(tr("Unable to find video encoder for file '%1'.").arg(filename));
+      return false;
+    }
 
-      if(!init_video_filters()) return false;
+    m_video_stream.stream = avformat_new_stream(m_output_context, m_video_stream.encoder);
+    if(!m_video_stream.stream)
+    {
+      emit error_message(tr("Error creating video stream for file '%1'.").arg(filename));
+      return false;
     }
-    else
+
+    m_video_stream.stream->codec = avcodec_alloc_context3(m_video_stream.encoder);
+    if(!m_video_stream.stream->codec)
     {
-      m_output_context->video_codec_id = m_input_context->streams[m_video_stream.id]->codecpar->codec_id;
-      m_output_context->oformat->video_codec = m_output_context->video_codec_id;
+      emit error_message(tr("Unable to allocate video encoder context for file '%1'.").arg(filename));
+      return false;
+    }
 
-      m_video_stream.stream = avformat_new_stream(m_output_context, nullptr);
-      if(!m_video_stream.stream)
-      {
-        emit information_message(tr("Unable to create video stream to copy for file '%1'.").arg(filename));
-        return false;
-      }
+    m_video_stream.encoderContext = m_video_stream.stream->codec;
+
+    m_video_stream.encoderContext->time_base           = m_video_stream.decoderContext->time_base;
+    m_video_stream.encoderContext->width               = m_video_stream.decoderContext->width;
+    m_video_stream.encoderContext->height              = m_video_stream.decoderContext->height;
+    m_video_stream.encoderContext->sample_aspect_ratio = m_video_stream.decoderContext->sample_aspect_ratio;
+    m_video_stream.encoderContext->framerate           = m_video_stream.decoderContext->framerate;
+    m_video_stream.encoderContext->pix_fmt             = negotiate_pixel_format(m_video_stream.encoder, m_video_stream.decoderContext->pix_fmt);
+    m_video_stream.encoderContext->bit_rate            = m_video_stream.decoderContext->bit_rate * 0.9;
+
+    const auto inputStream = m_input_context->streams[m_video_stream.id];
+    m_video_stream.stream->duration       = inputStream->duration;
+    m_video_stream.stream->avg_frame_rate = inputStream->avg_frame_rate;
+    m_video_stream.stream->first_dts      = inputStream->first_dts;
+    m_video_stream.stream->duration       = inputStream->duration;
+    m_video_stream.stream->time_base      = inputStream->time_base;
+    m_video_stream.time_base              = inputStream->time_base;
+
+    if(m_video_stream.encoderContext->bit_rate == 0)
+    {
+      m_video_stream.encoderContext->bit_rate = 1500000;
+    }
 
-      auto value = avcodec_parameters_copy(m_video_stream.stream->codecpar, m_input_context->streams[m_video_stream.id]->codecpar);
-      if(value < 0)
-      {
-        emit information_message(tr("Unable to copy the input parameters for output video stream for file '%1'.").arg(filename));
-        return false;
-      }
+    if(inputStream->duration != NO_PTS_VALUE)
+    {
+      m_video_stream.stream->duration = av_rescale_q(inputStream->duration, inputStream->time_base, m_video_stream.time_base);
+    }
+
+    // some formats want stream headers to be separate
+    if (m_output_context->oformat->flags & AVFMT_GLOBALHEADER) m_video_stream.encoderContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+    const auto threads = (m_threads > 0) ? std::to_string(std::max(1, m_threads - m_threads / 3)) : std::string("auto");
+
+    AVDictionary *dictionary = nullptr;
+    av_dict_set(&dictionary, "threads", threads.c_str(), 0);
+
+    auto value = avcodec_open2(m_video_stream.stream->codec, m_video_stream.encoder, &dictionary);
+    if(value < 0)
+    {
+      emit error_message(tr("Error opening video context for file '%1'. Error: %2.").arg(filename).arg(av_error_string(value)));
+      return false;
+    }
+
+    value = avcodec_parameters_from_context(m_video_stream.stream->codecpar, m_video_stream.encoderContext);
+    if(value < 0)
+    {
+      emit error_message(tr("Error copying parameters from video context. Error: %1.").arg(av_error_string(value)));
+      return false;
+    }
 
-      m_video_stream.stream->time_base = m_video_stream.time_base;
-      m_video_stream.stream->duration  = m_input_context->streams[m_video_stream.id]->duration;
+    // frames go straight to the encoder when the decoder already produces its format.
+    if(m_video_stream.encoderContext->pix_fmt != m_video_stream.decoderContext->pix_fmt)
+    {
+      if(!init_video_filters()) return false;
     }
+  }
+  else
+  {
+    m_output_context->video_codec_id = m_input_context->streams[m_video_stream.id]->codecpar->codec_id;
+    m_output_context->oformat->video_codec = m_output_context->video_codec_id;
 
-    if(needsAudioProcessing())
+    m_video_stream.stream = avformat_new_stream(m_output_context, nullptr);
+    if(!m_video_stream.stream)
     {
-      m_output_context->audio_codec_id = m_output_context->oformat->audio_codec = audioCodecId();
+      emit information_message(tr("Unable to create video stream to copy for file '%1'.").arg(filename));
+      return false;
+    }
 
-      m_audio_stream.encoder = avcodec_find_encoder(audioCodecId());
-      if(!m_audio_stream.encoder)
-      {
-        emit error_message(tr("Unable to find audio encoder for file '%1'.").arg(filename));
-        return false;
-      }
+    auto value = avcodec_parameters_copy(m_video_stream.stream->codecpar, m_input_context->streams[m_video_stream.id]->codecpar);
+    if(value < 0)
+    {
+      emit information_message(tr("Unable to copy the input parameters for output video stream for file '%1'.").arg(filename));
+      return false;
+    }
 
-      m_audio_stream.stream = avformat_new_stream(m_output_context, m_audio_stream.encoder);
-      if(!m_audio_stream.stream)
-      {
-        emit error_message(tr("Error creating audio stream for file '%1'.").arg(filename));
-        return false;
-      }
+    m_video_stream.stream->time_base = m_video_stream.time_base;
+    m_video_stream.stream->duration  = m_input_context->streams[m_video_stream.id]->duration;
+  }
 
-      m_audio_stream.stream->codec = avcodec_alloc_context3(m_audio_stream.encoder);
-      if(!m_audio_stream.stream->codec)
-      {
-        emit error_message(tr("Unable to allocate audio encoder context for file '%1'.").arg(filename));
-        return false;
-      }
+  return true;
+}
+
+//-----------------------------------------------------------------
+bool Worker::create_audio_stream(const QString &filename)
+{
+  if(needsAudioProcessing())
+  {
+    m_output_context->audio_codec_id = m_output_context->oformat->audio_codec = audioCodecId();
+
+    m_audio_stream.encoder = avcodec_find_encoder(audioCodecId());
+    if(!m_audio_stream.encoder)
+    {
+      emit error_message(tr("Unable to find audio encoder for file '%1'.").arg(filename));
+      return false;
+    }
 
-      m_audio_stream.encoderContext = m_audio_stream.stream->codec;
+    m_audio_stream.stream = avformat_new_stream(m_output_context, m_audio_stream.encoder);
+    if(!m_audio_stream.stream)
+    {
+      emit error_message(tr("Error creating audio stream for file '%1'.").arg(filename));
+      return false;
+    }
 
-      // some formats want stream headers to be separate
-      if (format->flags & AVFMT_GLOBALHEADER) m_audio_stream.encoderContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    m_audio_stream.stream->codec = avcodec_alloc_context3(m_audio_stream.encoder);
+    if(!m_audio_stream.stream->codec)
+    {
+      emit error_message(tr("Unable to allocate audio encoder context for file '%1'.").arg(filename));
+      return false;
+    }
 
-      m_audio_stream.encoderContext->sample_fmt         = m_audio_stream.encoder->sample_fmts[0];
-      m_audio_stream.encoderContext->sample_rate        = m_audio_stream.decoderContext->sample_rate;
-      m_audio_stream.encoderContext->channels           = std::min(m_configuration.audioChannelsNum(), m_audio_stream.decoderContext->channels);
-      m_audio_stream.encoderContext->channel_layout     = av_get_default_channel_layout(m_audio_stream.encoderContext->channels);
-      m_audio_stream.encoderContext->bit_rate           = m_audio_stream.decoderContext->bit_rate;
-      m_audio_stream.encoderContext->time_base          = AVRational{1,m_audio_stream.encoderContext->sample_rate};
+    m_audio_stream.encoderContext = m_audio_stream.stream->codec;
 
-      m_audio_stream.time_base = m_audio_stream.stream->time_base = m_audio_stream.encoderContext->time_base;
+    // some formats want stream headers to be separate
+    if (m_output_context->oformat->flags & AVFMT_GLOBALHEADER) m_audio_stream.encoderContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
-      const auto inputStream = m_input_context->streams[m_audio_stream.id];
-      m_audio_stream.stream->duration = inputStream->duration;
+    m_audio_stream.encoderContext->sample_fmt         = negotiate_sample_format(m_audio_stream.encoder, m_audio_stream.decoderContext->sample_fmt);
+    m_audio_stream.encoderContext->sample_rate        = m_audio_stream.decoderContext->sample_rate;
+    m_audio_stream.encoderContext->channels           = std::min(m_configuration.audioChannelsNum(), m_audio_stream.decoderContext->channels);
+    m_audio_stream.encoderContext->channel_layout     = av_get_default_channel_layout(m_audio_stream.encoderContext->channels);
+    m_audio_stream.encoderContext->bit_rate           = m_audio_stream.decoderContext->bit_rate;
+    m_audio_stream.encoderContext->time_base          = AVRational{1,m_audio_stream.encoderContext->sample_rate};
 
-      if(inputStream->duration != NO_PTS_VALUE)
-      {
-        m_audio_stream.stream->duration = av_rescale_q(inputStream->duration, inputStream->time_base, m_audio_stream.time_base);
-      }
+    m_audio_stream.time_base = m_audio_stream.stream->time_base = m_audio_stream.encoderContext->time_base;
 
-      AVDictionary *dictionary = nullptr;
-      av_dict_set(&dictionary, "threads", "auto", 0);
-      av_dict_set(&dictionary, "strict", "experimental", 0);
+    const auto inputStream = m_input_context->streams[m_audio_stream.id];
+    m_audio_stream.stream->duration = inputStream->duration;
 
-      auto value = avcodec_open2(m_audio_stream.encoderContext, m_audio_stream.encoder, &dictionary);
-      if(value < 0)
-      {
-        emit error_message(tr("Error opening audio context for file '%1'. Error: %2.").arg(filename).arg(av_error_string(value)));
-        return false;
-      }
+    if(inputStream->duration != NO_PTS_VALUE)
+    {
+      m_audio_stream.stream->duration = av_rescale_q(inputStream->duration, inputStream->time_base, m_audio_stream.time_base);
+    }
 
-      value = avcodec_parameters_from_context(m_audio_stream.stream->codecpar, m_audio_stream.encoderContext);
-      if(value < 0)
-      {
-        emit error_message(tr("Error copying parameters from audio context. Error: %1.").arg(av_error_string(value)));
-        return false;
-      }
+    AVDictionary *dictionary = nullptr;
+    av_dict_set(&dictionary, "threads", (m_threads > 0) ? "1" : "auto", 0);
+    av_dict_set(&dictionary, "strict", "experimental", 0);
 
-      if(!init_audio_filters()) return false;
+    auto value = avcodec_open2(m_audio_stream.encoderContext, m_audio_stream.encoder, &dictionary);
+    if(value < 0)
+    {
+      emit error_message(tr("Error opening audio context for file '%1'. Error: %2.").arg(filename).arg(av_error_string(value)));
+      return false;
     }
-    else
+
+    value = avcodec_parameters_from_context(m_audio_stream.stream->codecpar, m_audio_stream.encoderContext);
+    if(value < 0)
     {
-      m_output_context->audio_codec_id = m_input_context->streams[m_audio_stream.id]->codecpar->codec_id;
-      m_output_context->oformat->audio_codec = m_output_context->audio_codec_id;
+      emit error_message(tr("Error copying parameters from audio context. Error: %1.").arg(av_error_string(value)));
+      return false;
+    }
 
-      m_audio_stream.stream = avformat_new_stream(m_output_context, nullptr);
-      if(!m_audio_stream.stream)
-      {
-        emit information_message(tr("Unable to create audio stream to copy for file '%1'.").arg(filename));
-        return false;
-      }
+    const auto decoderLayout = m_audio_stream.decoderContext->channel_layout ? m_audio_stream.decoderContext->channel_layout :
+                               av_get_default_channel_layout(m_audio_stream.decoderContext->channels);
 
-      auto value = avcodec_parameters_copy(m_audio_stream.stream->codecpar, m_input_context->streams[m_audio_stream.id]->codecpar);
-      if(value < 0)
-      {
-        emit information_message(tr("Unable to copy the input parameters for output audio stream for file '%1'.").arg(filename));
-        return false;
-      }
+    const bool convert = (m_audio_stream.encoderContext->sample_fmt     != m_audio_stream.decoderContext->sample_fmt) ||
+                         (m_audio_stream.encoderContext->channels       != m_audio_stream.decoderContext->channels)   ||
+                         (m_audio_stream.encoderContext->channel_layout != decoderLayout);
 
-      m_audio_stream.stream->time_base = m_audio_stream.time_base;
-      m_audio_stream.stream->duration = m_input_context->streams[m_audio_stream.id]->duration;
+    // without conversion the filters are only needed to assemble frames of the encoder frame size.
+    if(convert || m_audio_stream.encoderContext->frame_size != 0)
+    {
+      if(!init_audio_filters(convert)) return false;
     }
+  }
+  else
+  {
+    m_output_context->audio_codec_id = m_input_context->streams[m_audio_stream.id]->codecpar->codec_id;
+    m_output_context->oformat->audio_codec = m_output_context->audio_codec_id;
 
-    // open the output file, if needed.
-    if (!(format->flags & AVFMT_NOFILE))
+    m_audio_stream.stream = avformat_new_stream(m_output_context, nullptr);
+    if(!m_audio_stream.stream)
     {
-      const auto value = avio_open(&m_output_context->pb, filename.toStdString().c_str(), AVIO_FLAG_WRITE);
-      if (value < 0)
-      {
-        emit error_message(tr("Error opening output file '%1'. Error: %2.").arg(filename).arg(av_error_string(value)));
-        return false;
-      }
+      emit information_message(tr("Unable to create audio stream to copy for file '%1'.").arg(filename));
+      return false;
     }
 
-    const auto value = avformat_write_header(m_output_context, nullptr);
+    auto value = avcodec_parameters_copy(m_audio_stream.stream->codecpar, m_input_context->streams[m_audio_stream.id]->codecpar);
     if(value < 0)
     {
-      emit error_message(tr("Unable to write header of file '%1'.").arg(filename));
+      emit information_message(tr("Unable to copy the input parameters for output audio stream for file '%1'.").arg(filename));
       return false;
     }
+
+    m_audio_stream.stream->time_base = m_audio_stream.time_base;
+    m_audio_stream.stream->duration = m_input_context->streams[m_audio_stream.id]->duration;
   }
 
-  if(needsSubtitleProcessing())
+  return true;
+}
+
+//-----------------------------------------------------------------
+bool Worker::create_extra_audio_streams(const QString &filename)
+{
+  if(m_extra_audio_streams.empty()) return true;
+
+  // tag the languages so the audio tracks can be told apart.
+  const auto primaryLanguage = stream_language(m_input_context->streams[m_audio_stream.id]);
+  if(m_audio_stream.stream && !primaryLanguage.isEmpty())
   {
-    m_subtitle_stream.name = "subtitle";
-    m_subtitle_stream.time_base = m_input_context->streams[m_subtitle_stream.id]->time_base;
+    av_dict_set(&m_audio_stream.stream->metadata, "language", primaryLanguage.toLatin1().constData(), 0);
+  }
+
+  // the audio tracks in other preferred languages are copied as they are.
+  for(auto &extra: m_extra_audio_streams)
+  {
+    const auto inputStream = m_input_context->streams[extra.id];
+
+    extra.output_file = m_output_context;
+    extra.time_base   = inputStream->time_base;
+    extra.stream      = avformat_new_stream(m_output_context, nullptr);
+    if(!extra.stream)
+    {
+      emit error_message(tr("Unable to create audio stream to copy for file '%1'.").arg(filename));
+      return false;
+    }
 
-    if(m_input_context->streams[m_subtitle_stream.id]->codecpar->codec_id != AV_CODEC_ID_SRT)
+    const auto value = avcodec_parameters_copy(extra.stream->codecpar, inputStream->codecpar);
+    if(value < 0)
     {
-      emit information_message(tr("Subtitle exists for file '%1' but it's not in SRT format.").arg(QString::fromStdWString(m_source_info.wstring())));
+      emit error_message(tr("Unable to copy the input parameters for output audio stream for file '%1'. Error: %2.").arg(filename).arg(av_error_string(value)));
+      return false;
     }
-    else
-    {
-      const auto filename = QString::fromStdWString(m_source_info.wstring() + SUBTITLE_EXTENSION);
 
-      m_subtitle_file.setFileName(filename);
-      if(!m_subtitle_file.open(QIODevice::WriteOnly|QIODevice::Unbuffered))
-      {
-        emit error_message(tr("Unable to create/open subtitle file: '%1'.").arg(filename));
-        return false;
-      }
-    }
+    extra.stream->time_base = extra.time_base;
+    extra.stream->duration  = inputStream->duration;
+
+    const auto language = stream_language(inputStream);
+    if(!language.isEmpty()) av_dict_set(&extra.stream->metadata, "language", language.toLatin1().constData(), 0);
   }
 
   return true;
@@ -971,10 +2126,174 @@ AVCodecID Worker::videoCodecId() const
 }
 
 //-----------------------------------------------------------------------------
-bool Worker::process_av_packet(Stream &stream)
+void Worker::start_pipeline()
+{
+  if(!m_output_context) return;
+
+  int producers = 1; // the demuxer copies the packets of the streams that don't need transcoding.
+
+  if(m_audio_stream.encoder)
+  {
+    m_audio_thread = std::thread(&Worker::transcode_stage, this, std::ref(m_audio_stream), std::ref(m_audio_queue));
+    ++producers;
+  }
+
+  if(m_video_stream.encoder)
+  {
+    m_video_thread = std::thread(&Worker::transcode_stage, this, std::ref(m_video_stream), std::ref(m_video_queue));
+    ++producers;
+  }
+
+  m_muxer_thread = std::thread(&Worker::muxer_stage, this, producers);
+}
+
+//-----------------------------------------------------------------------------
+void Worker::finish_pipeline(const bool finished)
+{
+  if(!m_output_context) return;
+
+  if(finished)
+  {
+    // nullptr packets signal the end of the input to the stages.
+    if(m_audio_stream.encoder) m_audio_queue.push(nullptr);
+    if(m_video_stream.encoder) m_video_queue.push(nullptr);
+    m_muxer_queue.push(nullptr);
+  }
+  else
+  {
+    abort_pipeline();
+  }
+
+  for(auto thread: {&m_audio_thread, &m_video_thread, &m_muxer_thread})
+  {
+    if(thread->joinable()) thread->join();
+  }
+
+  // release the packets left in the queues if the pipeline was aborted.
+  for(auto queue: {&m_audio_queue, &m_video_queue, &m_muxer_queue})
+  {
+    for(auto packet: queue->drain())
+    {
+      if(packet) av_packet_free(&packet);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void Worker::abort_pipeline()
+{
+  for(auto queue: {&m_audio_queue, &m_video_queue, &m_muxer_queue})
+  {
+    queue->abort();
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool Worker::dispatch_packet(PacketQueue &queue)
+{
+  auto packet = av_packet_alloc();
+  if(!packet)
+  {
+    emit error_message(tr("Unable to allocate packet for file '%1'.").arg(QString::fromStdWString(m_source_info.wstring())));
+    m_fail = true;
+    return false;
+  }
+
+  av_packet_move_ref(packet, m_packet);
+
+  if(!queue.push(packet))
+  {
+    av_packet_free(&packet);
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void Worker::transcode_stage(Stream &stream, PacketQueue &queue)
+{
+  const auto filename = QString::fromStdString(m_source_info.stem().string());
+
+  AVPacket *packet = nullptr;
+  while(queue.pop(packet))
+  {
+    if(!packet)
+    {
+      if(!flush_stream(stream))
+      {
+        emit error_message(tr("Error flushing %1 stream for file '%2'.").arg(stream.name).arg(filename));
+        m_fail = true;
+        abort_pipeline();
+        return;
+      }
+
+      m_muxer_queue.push(nullptr);
+      return;
+    }
+
+    const auto result = process_av_packet(stream, packet);
+    av_packet_free(&packet);
+
+    if(!result)
+    {
+      emit error_message(tr("Error transcoding %1 frame for file '%2'.").arg(stream.name).arg(filename));
+      m_fail = true;
+      abort_pipeline();
+      return;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void Worker::muxer_stage(int producers)
+{
+  const auto filename = QString::fromStdString(m_source_info.stem().string());
+
+  AVPacket *packet = nullptr;
+  while(producers > 0 && m_muxer_queue.pop(packet))
+  {
+    if(!packet)
+    {
+      --producers;
+      continue;
+    }
+
+    auto extra   = extra_audio_stream(packet->stream_index);
+    auto &stream = extra ? *extra : (packet->stream_index == m_audio_stream.id) ? m_audio_stream : m_video_stream;
+
+    const auto result = write_av_packet(stream, packet);
+    av_packet_free(&packet);
+
+    if(!result)
+    {
+      emit error_message(tr("Error writing %1 packet to output for file '%2'.").arg(stream.name).arg(filename));
+      m_fail = true;
+      abort_pipeline();
+      return;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+long long Worker::frame_data_size(const AVFrame *frame)
+{
+  if(frame->nb_samples > 0)
+  {
+    const auto channels = av_get_channel_layout_nb_channels(frame->channel_layout);
+    const auto format   = static_cast<AVSampleFormat>(frame->format);
+
+    return std::max(0, av_samples_get_buffer_size(nullptr, channels, frame->nb_samples, format, 1));
+  }
+
+  return std::max(0, av_image_get_buffer_size(static_cast<AVPixelFormat>(frame->format), frame->width, frame->height, 1));
+}
+
+//-----------------------------------------------------------------------------
+bool Worker::process_av_packet(Stream &stream, AVPacket *packet)
 {
   // Try to decode the packet into a frame/multiple frames.
-  auto result = avcodec_send_packet(stream.decoderContext, m_packet);
+  auto result = avcodec_send_packet(stream.decoderContext, packet);
 
   if(result == AVERROR(EAGAIN))
   {
@@ -987,100 +2306,150 @@ bool Worker::process_av_packet(Stream &stream)
     return false;
   }
 
-  while(0 == (result = avcodec_receive_frame(stream.decoderContext, m_frame)))
+  while(0 == (result = avcodec_receive_frame(stream.decoderContext, stream.frame)))
   {
-    int value;
-    if(stream.infilter == nullptr)
-    {
-      value = avcodec_send_frame(stream.encoderContext, m_frame);
-      if(value < 0)
-      {
-        const auto filename = QString::fromStdWString(m_source_info.wstring());
-        emit error_message(tr("Error sending frame to %1 encoder. Input file '%2'. Error: %3 (%4)").arg(stream.name).arg(filename).arg(av_error_string(value)).arg(value));
-        return false;
-      }
+    if(!encode_av_frame(stream, stream.frame)) return false;
+  }
 
-      continue;
+  if(result < 0 && result != AVERROR_EOF && result != AVERROR(EAGAIN))
+  {
+    const auto filename = QString::fromStdWString(m_source_info.wstring());
+    emit error_message(QString("Error reading frame from %1 stream. input file '%2. Error: %3").arg(stream.name).arg(filename).arg(av_error_string(result)));
+    return false;
+  }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool Worker::encode_av_frame(Stream &stream, AVFrame *frame)
+{
+  if(stream.infilter == nullptr)
+  {
+    if(!frame || matches_encoder(stream, frame)) return send_av_frame(stream, frame);
+
+    // the decoder output has changed, the conversion filters are needed from now on.
+    const auto initialized = (&stream == &m_video_stream) ? init_video_filters() : init_audio_filters(true);
+    if(!initialized) return false;
+  }
+
+  // the buffer source takes the references of refcounted frames and copies the data of the rest.
+  if(frame && !frame->buf[0]) m_bytes_copied += frame_data_size(frame);
+
+  // a nullptr frame marks the end of the stream to the filter graph.
+  auto value = av_buffersrc_add_frame(stream.infilter, frame);
+  if(value < 0)
+  {
+    const auto filename = QString::fromStdWString(m_source_info.wstring());
+    emit error_message(tr("Error sending frame to %1 buffer. Input file '%2'. Error: %3 (%4)").arg(stream.name).arg(filename).arg(av_error_string(value)).arg(value));
+    return false;
+  }
+
+  while(true)
+  {
+    if(stream.encoderContext->frame_size != 0)
+    {
+      value = av_buffersink_get_samples(stream.outfilter, stream.frame, stream.encoderContext->frame_size);
     }
     else
     {
-      value = av_buffersrc_add_frame(stream.infilter, m_frame);
-      if(value < 0)
-      {
-        const auto filename = QString::fromStdWString(m_source_info.wstring());
-        emit error_message(tr("Error sending frame to %1 buffer. Input file '%2'. Error: %3 (%4)").arg(stream.name).arg(filename).arg(av_error_string(value)).arg(value));
-        return false;
-      }
+      value = av_buffersink_get_frame(stream.outfilter, stream.frame);
     }
 
-    while(true)
+    if(value < 0)
     {
-      if(stream.encoderContext->frame_size != 0 && m_packet)
-      {
-        value = av_buffersink_get_samples(stream.outfilter, m_frame, stream.encoderContext->frame_size);
-      }
-      else
-      {
-        value = av_buffersink_get_frame(stream.outfilter, m_frame);
-      }
-
-      if(value < 0)
-      {
-        if ((value == AVERROR(EAGAIN)) || (value == AVERROR_EOF)) break;
+      if ((value == AVERROR(EAGAIN)) || (value == AVERROR_EOF)) break;
 
-        const auto filename = QString::fromStdWString(m_source_info.wstring());
-        emit error_message(tr("Error receiving frame from %1 buffer sink. Input file '%2'. Error: %3").arg(stream.name).arg(filename).arg(av_error_string(result)));
-        return false;
-      }
+      const auto filename = QString::fromStdWString(m_source_info.wstring());
+      emit error_message(tr("Error receiving frame from %1 buffer sink. Input file '%2'. Error: %3").arg(stream.name).arg(filename).arg(av_error_string(value)));
+      return false;
+    }
 
-      value = avcodec_send_frame(stream.encoderContext, m_frame);
-      if(value < 0 && value != AVERROR(EAGAIN))
-      {
-        const auto filename = QString::fromStdWString(m_source_info.wstring());
-        emit error_message(tr("Error sending frame to %1 encoder. Input file '%2'. Error: %3").arg(stream.name).arg(filename).arg(av_error_string(result)));
-        return false;
-      }
+    // the sink assembles the audio frames of the encoder size copying the samples.
+    if(stream.encoderContext->frame_size != 0) m_bytes_copied += frame_data_size(stream.frame);
 
-      if(!m_packet)
-      {
-        // we are flushing the encoders, but need a packet now.
-        m_packet = av_packet_alloc();
-        av_init_packet(m_packet);
-      }
+    if(!send_av_frame(stream, stream.frame)) return false;
+  }
 
-      while(0 == (value = avcodec_receive_packet(stream.encoderContext, m_packet)))
-      {
-        if(m_packet && stream.id == m_audio_stream.id)
-        {
-          m_packet->pts = m_packet->dts = stream.pts;
-          m_packet->duration = m_audio_stream.encoderContext->frame_size;
-          stream.pts += m_packet->duration;
-        }
+  // drain the encoder once the filters are empty.
+  if(!frame) return send_av_frame(stream, nullptr);
 
-        if(!write_av_packet(stream)) return false;
-      }
+  return true;
+}
 
-      if (value < 0 && value != AVERROR(EAGAIN))
-      {
-        const auto filename = QString::fromStdWString(m_source_info.wstring());
-        emit error_message(tr("Error receiving packet from %1 encoder. Input file '%2'. Error: %3").arg(stream.name).arg(filename).arg(av_error_string(value)));
-        return false;
-      }
+//-----------------------------------------------------------------------------
+bool Worker::send_av_frame(Stream &stream, AVFrame *frame)
+{
+  // the encoder refuses new frames while its packets haven't been received, the frame is sent again once drained.
+  int value;
+  while(AVERROR(EAGAIN) == (value = avcodec_send_frame(stream.encoderContext, frame)))
+  {
+    const auto received = receive_av_packets(stream);
+    if(received < 0)
+    {
+      if(frame) av_frame_unref(frame);
+      return false;
     }
+
+    // nothing to drain, the encoder won't accept it later either.
+    if(received == 0) break;
   }
 
-  if(result < 0 && result != AVERROR_EOF && result != AVERROR(EAGAIN))
+  if(frame) av_frame_unref(frame);
+
+  if(value < 0 && value != AVERROR_EOF)
   {
     const auto filename = QString::fromStdWString(m_source_info.wstring());
-    emit error_message(QString("Error reading frame from %1 stream. input file '%2. Error: %3").arg(stream.name).arg(filename).arg(av_error_string(result)));
+    emit error_message(tr("Error sending frame to %1 encoder. Input file '%2'. Error: %3 (%4)").arg(stream.name).arg(filename).arg(av_error_string(value)).arg(value));
     return false;
   }
 
-  return true;
+  return receive_av_packets(stream) >= 0;
+}
+
+//-----------------------------------------------------------------------------
+int Worker::receive_av_packets(Stream &stream)
+{
+  int count = 0;
+  int value;
+
+  while(0 == (value = avcodec_receive_packet(stream.encoderContext, stream.packet)))
+  {
+    if(stream.encoderContext->codec_type == AVMEDIA_TYPE_AUDIO)
+    {
+      stream.packet->pts = stream.packet->dts = stream.pts;
+      stream.packet->duration = stream.encoderContext->frame_size;
+      stream.pts += stream.packet->duration;
+    }
+
+    stream.packet->stream_index = stream.id;
+
+    auto packet = av_packet_alloc();
+    if(!packet) return -1;
+
+    av_packet_move_ref(packet, stream.packet);
+
+    if(!m_muxer_queue.push(packet))
+    {
+      av_packet_free(&packet);
+      return -1;
+    }
+
+    ++count;
+  }
+
+  if (value < 0 && value != AVERROR(EAGAIN) && value != AVERROR_EOF)
+  {
+    const auto filename = QString::fromStdWString(m_source_info.wstring());
+    emit error_message(tr("Error receiving packet from %1 encoder. Input file '%2'. Error: %3").arg(stream.name).arg(filename).arg(av_error_string(value)));
+    return -1;
+  }
+
+  return count;
 }
 
 //-----------------------------------------------------------------------------
-bool Worker::init_audio_filters()
+bool Worker::init_audio_filters(const bool convert)
 {
   const auto filename = QString::fromStdString(m_source_info.stem().string());
 
@@ -1142,33 +2511,37 @@ bool Worker::init_audio_filters()
   }
 
   // Create the aformat filter it ensures that the output is of the format we want.
-  auto aformat = avfilter_get_by_name("aformat");
-  if (!aformat)
+  AVFilterContext *aformat_ctx = nullptr;
+  if(convert)
   {
-    emit error_message(tr("Unable to allocate audio filter format for file '%1'.").arg(filename));
-    return false;
-  }
+    auto aformat = avfilter_get_by_name("aformat");
+    if (!aformat)
+    {
+      emit error_message(tr("Unable to allocate audio filter format for file '%1'.").arg(filename));
+      return false;
+    }
 
-  auto aformat_ctx = avfilter_graph_alloc_filter(m_audio_stream.filter_graph, aformat, "aformat");
-  if (!aformat_ctx)
-  {
-    emit error_message(tr("Unable to allocate audio filter format context for file '%1'.").arg(filename));
-    return false;
-  }
+    aformat_ctx = avfilter_graph_alloc_filter(m_audio_stream.filter_graph, aformat, "aformat");
+    if (!aformat_ctx)
+    {
+      emit error_message(tr("Unable to allocate audio filter format context for file '%1'.").arg(filename));
+      return false;
+    }
 
-  memset(buffer, 0, 255);
-  av_get_channel_layout_string(buffer, sizeof(buffer), m_audio_stream.encoderContext->channels, av_get_default_channel_layout(m_audio_stream.encoderContext->channels));
+    memset(buffer, 0, 255);
+    av_get_channel_layout_string(buffer, sizeof(buffer), m_audio_stream.encoderContext->channels, av_get_default_channel_layout(m_audio_stream.encoderContext->channels));
 
-  QString formatParams = tr("sample_fmts=%1:sample_rates=%2:channel_layouts=%3")
-      .arg(QString::fromLatin1(av_get_sample_fmt_name(m_audio_stream.encoderContext->sample_fmt)))
-      .arg(m_audio_stream.encoderContext->sample_rate)
-      .arg(QString::fromLatin1(buffer));
+    QString formatParams = tr("sample_fmts=%1:sample_rates=%2:channel_layouts=%3")
+        .arg(QString::fromLatin1(av_get_sample_fmt_name(m_audio_stream.encoderContext->sample_fmt)))
+        .arg(m_audio_stream.encoderContext->sample_rate)
+        .arg(QString::fromLatin1(buffer));
 
-  value = avfilter_init_str(aformat_ctx, formatParams.toStdString().c_str());
-  if (value < 0)
-  {
-    emit error_message(tr("Unable to initialize audio filter format context for file '%1'.").arg(filename));
-    return false;
+    value = avfilter_init_str(aformat_ctx, formatParams.toStdString().c_str());
+    if (value < 0)
+    {
+      emit error_message(tr("Unable to initialize audio filter format context for file '%1'.").arg(filename));
+      return false;
+    }
   }
 
   // Finally create the abuffersink filter used to get the filtered data out of the graph.
@@ -1196,9 +2569,16 @@ bool Worker::init_audio_filters()
 
   // Connect the filters;
   // in this simple case the filters just form a linear chain.
-  value = avfilter_link(m_audio_stream.infilter, 0, aformat_ctx, 0);
-  if (value >= 0)
-    value = avfilter_link(aformat_ctx, 0, m_audio_stream.outfilter, 0);
+  if(aformat_ctx)
+  {
+    value = avfilter_link(m_audio_stream.infilter, 0, aformat_ctx, 0);
+    if (value >= 0)
+      value = avfilter_link(aformat_ctx, 0, m_audio_stream.outfilter, 0);
+  }
+  else
+  {
+    value = avfilter_link(m_audio_stream.infilter, 0, m_audio_stream.outfilter, 0);
+  }
   if (value < 0)
   {
     emit error_message(tr("Unable to connect audio filters for file '%1'.").arg(filename));
@@ -1329,71 +2709,117 @@ bool Worker::init_video_filters()
 }
 
 //-----------------------------------------------------------------------------
-bool Worker::flush_streams()
+AVPixelFormat Worker::negotiate_pixel_format(const AVCodec *encoder, const AVPixelFormat source)
 {
-  for(auto stream: {m_audio_stream, m_video_stream})
+  if(!encoder->pix_fmts) return source;
+  if(source == AV_PIX_FMT_NONE) return encoder->pix_fmts[0];
+
+  int loss = 0;
+  const auto format = avcodec_find_best_pix_fmt2(encoder->pix_fmts, source, 0, &loss);
+
+  return (format == AV_PIX_FMT_NONE) ? encoder->pix_fmts[0] : format;
+}
+
+//-----------------------------------------------------------------------------
+AVSampleFormat Worker::negotiate_sample_format(const AVCodec *encoder, const AVSampleFormat source)
+{
+  if(!encoder->sample_fmts) return source;
+  if(source == AV_SAMPLE_FMT_NONE) return encoder->sample_fmts[0];
+
+  // same format, then same sample type with the other layout (planar/packed), then the first one
+  // with the same number of bytes per sample.
+  const AVSampleFormat candidates[] = { source, av_get_planar_sample_fmt(source), av_get_packed_sample_fmt(source) };
+  for(auto candidate: candidates)
   {
-    if(m_packet)
+    for(auto format = encoder->sample_fmts; *format != AV_SAMPLE_FMT_NONE; ++format)
     {
-      av_packet_unref(m_packet);
-      m_packet = nullptr;
+      if(*format == candidate) return candidate;
     }
+  }
 
-    if(stream.encoder)
-    {
-      process_av_packet(stream);
-      avcodec_flush_buffers(stream.decoderContext);
-      avcodec_flush_buffers(stream.encoderContext);
-    }
+  for(auto format = encoder->sample_fmts; *format != AV_SAMPLE_FMT_NONE; ++format)
+  {
+    if(av_get_bytes_per_sample(*format) == av_get_bytes_per_sample(source)) return *format;
   }
 
-  if(m_subtitle_file.isOpen())
+  return encoder->sample_fmts[0];
+}
+
+//-----------------------------------------------------------------------------
+bool Worker::matches_encoder(const Stream &stream, const AVFrame *frame)
+{
+  const auto context = stream.encoderContext;
+
+  if(context->codec_type == AVMEDIA_TYPE_VIDEO)
   {
-    m_subtitle_file.flush();
-    m_subtitle_file.close();
-    Utils::toUCS2(m_subtitle_file.fileName().toStdString());
+    return frame->format == context->pix_fmt && frame->width == context->width && frame->height == context->height;
   }
 
-  return true;
+  // frames without layout have the channels of the decoder, already checked against the encoder.
+  return frame->format == context->sample_fmt && frame->sample_rate == context->sample_rate &&
+         (frame->channel_layout == 0 || av_get_channel_layout_nb_channels(frame->channel_layout) == context->channels);
+}
+
+//-----------------------------------------------------------------------------
+bool Worker::flush_stream(Stream &stream)
+{
+  // a nullptr packet puts the decoder in draining mode.
+  if(!process_av_packet(stream, nullptr)) return false;
+
+  return encode_av_frame(stream, nullptr);
+}
+
+//-----------------------------------------------------------------------------
+void Worker::close_subtitle_files()
+{
+  for(auto &track: m_subtitle_tracks)
+  {
+    if(!track.file || !track.file->isOpen()) continue;
+
+    track.file->flush();
+    track.file->close();
+    Utils::toUCS2(track.file->fileName().toStdString());
+  }
 }
 
 //-----------------------------------------------------------------------------
-bool Worker::write_av_packet(Stream &stream)
+bool Worker::write_av_packet(Stream &stream, AVPacket *packet)
 {
-  if(m_packet)
+  if(packet)
   {
-    m_packet->stream_index = stream.stream->index;
+    packet->stream_index = stream.stream->index;
 
-    if(stream.stream->index != m_video_stream.id)
+    // the output index of the video stream doesn't have to match its input index.
+    if(&stream != &m_video_stream)
     {
-      if(m_packet->dts != NO_PTS_VALUE)
+      if(packet->dts != NO_PTS_VALUE)
       {
-        stream.dts = m_packet->pts;
+        stream.dts = packet->pts;
       }
       else
       {
-        m_packet->dts = stream.dts;
+        packet->dts = stream.dts;
       }
 
-      if(m_packet->pts == NO_PTS_VALUE)
+      if(packet->pts == NO_PTS_VALUE)
       {
-        m_packet->pts = m_packet->dts;
+        packet->pts = packet->dts;
       }
     }
     else
     {
-      m_packet->dts = m_packet->pts = stream.dts++;
-      m_packet->duration = 1;
+      packet->dts = packet->pts = stream.dts++;
+      packet->duration = 1;
     }
 
     const auto tb_codec = stream.time_base;
     const auto tb_stream = stream.stream->time_base;
-    m_packet->pts = av_rescale_q_rnd(m_packet->pts, tb_codec, tb_stream, AV_ROUND_NEAR_INF);
-    m_packet->dts = av_rescale_q_rnd(m_packet->dts, tb_codec, tb_stream, AV_ROUND_NEAR_INF);
-    if(m_packet->duration != 0) m_packet->duration = av_rescale_q(m_packet->duration, tb_codec, tb_stream);
+    packet->pts = av_rescale_q_rnd(packet->pts, tb_codec, tb_stream, AV_ROUND_NEAR_INF);
+    packet->dts = av_rescale_q_rnd(packet->dts, tb_codec, tb_stream, AV_ROUND_NEAR_INF);
+    if(packet->duration != 0) packet->duration = av_rescale_q(packet->duration, tb_codec, tb_stream);
   }
 
-  const auto value = av_interleaved_write_frame(stream.output_file, m_packet);
+  const auto value = av_interleaved_write_frame(stream.output_file, packet);
   if (value < 0)
   {
     const auto filename = QString::fromStdWString(m_source_info.wstring());
@@ -1405,37 +2831,42 @@ bool Worker::write_av_packet(Stream &stream)
 }
 
 //-----------------------------------------------------------------------------
-bool Worker::write_srt_packet()
+bool Worker::write_srt_packet(AVPacket *packet)
 {
-  if(m_packet && m_packet->size != 0)
+  const auto index = packet ? subtitle_track_index(packet->stream_index) : -1;
+  if(index < 0 || !m_subtitle_tracks[index].file) return true;
+
+  auto &track = m_subtitle_tracks[index];
+
+  if(packet->size != 0)
   {
     auto write_to_file = [&](const QString &str)
     {
-      if(!m_subtitle_file.isOpen() || (-1 == m_subtitle_file.write(str.toStdString().c_str())))
+      if(!track.file->isOpen() || (-1 == track.file->write(str.toStdString().c_str())))
       {
-        emit error_message(tr("Unable to write to subtitle file '%1'. Error: %2").arg(m_subtitle_file.fileName()).arg(m_subtitle_file.errorString()));
+        emit error_message(tr("Unable to write to subtitle file '%1'. Error: %2").arg(track.file->fileName()).arg(track.file->errorString()));
         return false;
       }
 
       return true;
     };
 
-    if(!write_to_file(QString::number(++m_subtitle_stream.pts))) return false;
+    if(!write_to_file(QString::number(++track.count))) return false;
     if(!write_to_file("\n")) return false;
 
-    const auto pts = (m_subtitle_stream.start_dts != 0) ? (m_packet->pts - m_subtitle_stream.start_dts) : m_packet->pts;
-    const double pos_msecs = 1000 * static_cast<double>(pts * m_subtitle_stream.time_base.num ) / m_subtitle_stream.time_base.den;
+    const auto pts = (m_subtitle_stream.start_dts != 0) ? (packet->pts - m_subtitle_stream.start_dts) : packet->pts;
+    const double pos_msecs = 1000 * static_cast<double>(pts * track.time_base.num ) / track.time_base.den;
 
     QTime time{0,0,0,0};
     time = time.addMSecs(static_cast<int>(pos_msecs));
     if(!write_to_file(time.toString("hh:mm:ss,zzz"))) return false;
     if(!write_to_file(" --> ")) return false;
 
-    const double duration_msecs = 1000 * static_cast<double>(m_packet->duration * m_subtitle_stream.time_base.num ) / m_subtitle_stream.time_base.den;
+    const double duration_msecs = 1000 * static_cast<double>(packet->duration * track.time_base.num ) / track.time_base.den;
     time = time.addMSecs(static_cast<int>(duration_msecs));
     if(!write_to_file(time.toString("hh:mm:ss,zzz"))) return false;
     if(!write_to_file("\n")) return false;
-    if(!write_to_file(QString::fromLocal8Bit(reinterpret_cast<const char *>(m_packet->data), m_packet->size))) return false;
+    if(!write_to_file(QString::fromLocal8Bit(reinterpret_cast<const char *>(packet->data), packet->size))) return false;
     if(!write_to_file("\n")) return false;
   }
 
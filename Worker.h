@@ -22,6 +22,15 @@
 
 // Project
 #include <Utils.h>
+#include <BoundedQueue.h>
+#include <InputReader.h>
+#include <OutputWriter.h>
+#include <ProbeIndex.h>
+#include <ThreadBudget.h>
+#include <NumaPlacement.h>
+#include <Checkpoint.h>
+#include <RateLimiter.h>
+#include <MemoryBudget.h>
 
 // Qt
 #include <QThread>
@@ -41,9 +50,16 @@ extern "C"
 
 // C++
 #include <filesystem>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 /** \class Worker
- * \brief Transcoder thread.
+ * \brief Transcoder thread. The transcoding is pipelined: the worker thread demuxes the input
+ *        and feeds the audio and video transcoding stages, each one running in its own thread,
+ *        and those feed the muxer stage that writes the output file. Stages are connected by
+ *        bounded packet queues.
  *
  */
 class Worker
@@ -54,9 +70,10 @@ class Worker
     /** \brief Worker class constructor.
      * \param[in] source_info QFileInfo struct of the source file.
      * \param[in] config Configuration struct reference.
+     * \param[in] budget Cores budget shared by the workers or nullptr to let the codecs decide.
      *
      */
-    explicit Worker(const std::filesystem::path &source_info, const Utils::TranscoderConfiguration &config);
+    explicit Worker(const std::filesystem::path &source_info, const Utils::TranscoderConfiguration &config, ThreadBudget *budget = nullptr);
 
     /** \brief Worker class virtual destructor.
      *
@@ -79,6 +96,61 @@ class Worker
      */
     bool has_failed();
 
+    /** \brief Returns the path of the source file.
+     *
+     */
+    const std::filesystem::path &source_path() const
+    { return m_source_info; }
+
+    /** \brief Returns the streams of the source file and the processing they need. Not valid if
+     *         the file couldn't be opened.
+     *
+     */
+    const ProbeResult &probe_result() const
+    { return m_probe; }
+
+    /** \brief Sets the NUMA node where the worker runs. Must be called before starting the worker.
+     * \param[in] placement NUMA placement of the workers or nullptr to not pin the worker.
+     * \param[in] node node index assigned by the placement.
+     *
+     */
+    void set_placement(const NumaPlacement *placement, const int node);
+
+    /** \brief Sets the limiters of the frames per second and read bytes per second shared by the workers.
+     *         Must be called before starting the worker.
+     * \param[in] frames frames per second limiter or nullptr if unlimited.
+     * \param[in] bytes read bytes per second limiter or nullptr if unlimited.
+     *
+     */
+    void set_rate_limits(RateLimiter *frames, RateLimiter *bytes);
+
+    /** \brief Sets the memory budget shared by the workers. Must be called before starting the worker.
+     * \param[in] budget memory budget or nullptr if unlimited.
+     *
+     */
+    void set_memory_budget(MemoryBudget *budget);
+
+    /** \brief Allows the worker to replace the outputs of a previous transcoding of the file instead of
+     *         failing. The previous outputs are kept until the new ones are complete and restored if the
+     *         transcoding fails or is cancelled. Must be called before starting the worker.
+     * \param[in] replace true to replace the existing outputs and false otherwise.
+     *
+     */
+    void set_replace_outputs(const bool replace);
+
+    /** \brief Returns the NUMA node index where the worker runs or -1 if not pinned.
+     *
+     */
+    int numa_node() const
+    { return m_placement ? m_node : -1; }
+
+    /** \brief Returns the number of video frames demuxed for processing so far. Can be called
+     *         while the worker is running.
+     *
+     */
+    long long frames_count() const
+    { return m_frames; }
+
   signals:
     /** \brief Emits a error message signal.
      * \param[in] message error message.
@@ -98,6 +170,14 @@ class Worker
      */
     void progress(int value) const;
 
+    /** \brief Emitted from the worker thread before creating the output files, so they can be removed
+     *         if the process is interrupted.
+     * \param[in] source source file path.
+     * \param[in] files output file paths.
+     *
+     */
+    void output_files_created(const QString &source, const QStringList &files) const;
+
   protected:
     virtual void run() override final;
 
@@ -125,6 +205,37 @@ class Worker
     const Utils::TranscoderConfiguration &m_configuration; /** Configuration struct reference. */
 
   private:
+    /** \struct Chunk
+     * \brief Part of the input file processed by a child worker in chunked encoding. Video chunks encode
+     *        the video packets between two keyframes, the audio chunk processes the audio and subtitles.
+     *
+     */
+    struct Chunk
+    {
+      enum class Type { NONE = 0, AUDIO, VIDEO };
+
+      Type                  type;   /** chunk type, NONE if the worker processes the whole file.        */
+      long long             start;  /** pts of the keyframe that starts the video chunk.                */
+      long long             end;    /** pts of the keyframe of the next chunk or AV_NOPTS_VALUE if last. */
+      long long             length; /** duration of the video chunk in stream time base units.          */
+      std::filesystem::path output; /** chunk output file.                                              */
+
+      /** \brief Chunk struct constructor.
+       *
+       */
+      Chunk(): type{Type::NONE}, start{AV_NOPTS_VALUE}, end{AV_NOPTS_VALUE}, length{0}
+      {};
+    };
+
+    /** \brief Worker class constructor for the workers that process a chunk of the input file.
+     * \param[in] source_info Source file path.
+     * \param[in] config Configuration struct reference.
+     * \param[in] chunk Chunk to process.
+     * \param[in] budget Cores budget shared by the workers or nullptr to let the codecs decide.
+     *
+     */
+    explicit Worker(const std::filesystem::path &source_info, const Utils::TranscoderConfiguration &config, const Chunk &chunk, ThreadBudget *budget);
+
     /** \struct Stream
      * \brief Contains all the variables necessary for libav stream transcoding.
      *
@@ -146,66 +257,168 @@ class Worker
       long long        dts;            /** last dts muxed.                      */
       long long        start_dts;      /** first dts.                           */
       AVRational       time_base;      /** stream time base.                    */
-
+      AVFrame         *frame;          /** stage frame (decoded/filtered data). */
+      AVPacket        *packet;         /** stage packet (encoded data).         */
 
       /** \brief Stream struct constructor.
        *
        */
       Stream(): id{AVERROR_STREAM_NOT_FOUND}, decoder{nullptr}, decoderContext{nullptr}, encoder{nullptr},
                 encoderContext{nullptr}, stream{nullptr}, output_file{nullptr}, filter_graph{nullptr},
-                infilter{nullptr}, outfilter{nullptr}, pts{0}, dts{0}, start_dts{0}
+                infilter{nullptr}, outfilter{nullptr}, pts{0}, dts{0}, start_dts{0}, frame{nullptr},
+                packet{nullptr}
                 {};
     };
 
-    Stream                      m_audio_stream;    /** audio stream variables.           */
-    Stream                      m_video_stream;    /** video stream variables.           */
-    Stream                      m_subtitle_stream; /** subtitle stream variables.        */
-    QFile                       m_input_file;      /** input file handle.                */
-    AVFormatContext            *m_input_context;   /** input container context.          */
-    QFile                       m_output_file;     /** output file handle.               */
-    AVFormatContext            *m_output_context;  /** output container context.         */
-    QFile                       m_subtitle_file;   /** output subtitle file handler.     */
-    AVFrame                    *m_frame;           /** libav frame (decoded data).       */
-    AVPacket                   *m_packet;          /** libav packet (encoded data).      */
-    const std::filesystem::path m_source_info;     /** source file information.          */
+    /** \struct SubtitleTrack
+     * \brief Subtitle stream extracted to a SRT file.
+     *
+     */
+    struct SubtitleTrack
+    {
+      int                    id;        /** input stream index.                      */
+      QString                language;  /** ISO-639-2 language code, empty if unknown. */
+      QString                filename;  /** output SRT file name.                     */
+      AVRational             time_base; /** input stream time base.                   */
+      long long              count;     /** number of subtitles written.              */
+      std::shared_ptr<QFile> file;      /** output file, nullptr if not extracted.    */
+    };
 
-    static const int s_io_buffer_size = 16384 + AV_INPUT_BUFFER_PADDING_SIZE;
+    using PacketQueue = BoundedQueue<AVPacket *>;
+
+    Stream                      m_audio_stream;    /** audio stream variables.               */
+    Stream                      m_video_stream;    /** video stream variables.               */
+    Stream                      m_subtitle_stream; /** subtitle stream variables.            */
+    std::unique_ptr<InputReader> m_input_reader;   /** input file reader.                    */
+    AVFormatContext            *m_input_context;   /** input container context.              */
+    std::unique_ptr<OutputWriter> m_output_writer; /** output file writer.                   */
+    AVFormatContext            *m_output_context;  /** output container context.             */
+    std::vector<Stream>         m_extra_audio_streams; /** copied audio streams.             */
+    std::vector<SubtitleTrack>  m_subtitle_tracks; /** extracted subtitle streams.           */
+    AVPacket                   *m_packet;          /** libav packet (demuxed data).          */
+    const std::filesystem::path m_source_info;     /** source file information.              */
+    const Chunk                 m_chunk;           /** processed chunk of the input.         */
+    std::atomic<int>            m_progress;        /** current progress in [0-100].          */
+    std::atomic<long long>      m_bytes_copied;    /** frame bytes copied decoder->encoder.  */
+    std::atomic<long long>      m_frames;          /** video packets demuxed for processing. */
+    ProbeResult                 m_probe;           /** streams and needed processing.        */
+    int                         m_discarded_streams; /** streams skipped by the demuxer.    */
+    ThreadBudget               *m_budget;          /** cores budget or nullptr if not used.  */
+    int                         m_threads;         /** codec threads granted by the budget.  */
+    const NumaPlacement        *m_placement;       /** NUMA placement, nullptr if unused.    */
+    int                         m_node;            /** NUMA node index of the worker.        */
+    std::unique_ptr<Checkpoint> m_checkpoint;      /** checkpoint or nullptr if unused.      */
+    RateLimiter                *m_frame_limiter;   /** frames limiter or nullptr if unused.  */
+    RateLimiter                *m_byte_limiter;    /** bytes limiter or nullptr if unused.   */
+    MemoryBudget               *m_memory;          /** memory budget or nullptr if unused.   */
+    qint64                      m_memory_estimate; /** estimated peak memory in bytes.       */
+    qint64                      m_memory_reserved; /** memory reserved or -1 if none.        */
+    bool                        m_replace_outputs; /** true to replace existing outputs.     */
+    QStringList                 m_replaced;        /** previous outputs set aside.           */
+    PacketQueue                 m_audio_queue;     /** demuxer -> audio stage packets.       */
+    PacketQueue                 m_video_queue;     /** demuxer -> video stage packets.       */
+    PacketQueue                 m_muxer_queue;     /** stages -> muxer stage packets.        */
+    std::thread                 m_audio_thread;    /** audio transcoding stage thread.       */
+    std::thread                 m_video_thread;    /** video transcoding stage thread.       */
+    std::thread                 m_muxer_thread;    /** muxer stage thread.                   */
+
+    static const int s_io_buffer_size = 65536 + AV_INPUT_BUFFER_PADDING_SIZE;
 
     /** \brief Returns true if the input file can be read and false otherwise.
      *
      */
     bool check_input_file_permissions();
 
+    /** \brief Removes the previous outputs set aside if the transcoding has succeeded and restores them
+     *         otherwise.
+     *
+     */
+    void finish_replaced_outputs();
+
     /** \brief Returns true if the program can write in the output directory and false otherwise.
      *
      */
     bool check_output_file_permissions();
 
-    /** \brief Initializes libav and opens the input file with the decoders.
+    /** \brief Initializes libav, opens the input file and selects the streams. The streams are only
+     *         analyzed if the container headers are not enough to decide if the file needs processing.
      *
      */
     bool init_libav();
 
-    /** \brief De-Initializes libav and deletes all assigned memory.
+    /** \brief Reads the first packets of the input to get the parameters of the streams. Returns
+     *         true on success and false otherwise.
      *
      */
-    void deinit_libav();
+    bool analyze_streams();
+
+    /** \brief Returns true if the container headers don't have all the parameters of the audio and
+     *         video streams and false otherwise.
+     *
+     */
+    bool headers_are_ambiguous() const;
+
+    /** \brief Selects the audio, video and subtitle streams of the input file.
+     *
+     */
+    void select_streams();
+
+    /** \brief Computes the start of the subtitles from the first timestamp of the streams.
+     *
+     */
+    void compute_subtitle_start();
+
+    /** \brief Marks the streams that aren't processed to be discarded by the demuxer.
+     *
+     */
+    void discard_unused_streams();
+
+    /** \brief Returns the ordered list of preferred language codes.
+     * \param[in] language preferred language of the stream type, used if the configuration doesn't have
+     *            a list of languages.
+     *
+     */
+    QStringList preferred_languages(const Utils::TranscoderConfiguration::Language language) const;
+
+    /** \brief Returns the lower case language code of the stream or an empty string if unknown.
+     * \param[in] stream libav stream.
+     *
+     */
+    static QString stream_language(const AVStream *stream);
 
-    /** \brief Custom I/O read for libav, using a QFile.
-     * \param[in] opaque pointer to the reader.
-     * \param[in] buffer buffer to fill
-     * \param[in] buffer_size buffer size.
+    /** \brief Returns the position of the input stream in the copied audio streams or -1 if not copied.
+     * \param[in] id input stream index.
      *
      */
-    static int custom_IO_read(void *opaque, unsigned char *buffer, int buffer_size);
+    int extra_audio_index(const int id) const;
 
-    /** \brief Custom I/O seek for libav, using a QFile.
-     * \param[in] opaque pointer to the reader.
-     * \param[in] offset seek value.
-     * \param[in] whence seek direction.
+    /** \brief Returns the copied audio stream of the input stream or nullptr if it has no output stream.
+     * \param[in] id input stream index.
      *
      */
-    static long long int custom_IO_seek(void *opaque, long long int offset, int whence);
+    Stream *extra_audio_stream(const int id);
+
+    /** \brief Returns the position of the input stream in the subtitle tracks or -1 if not extracted.
+     * \param[in] id input stream index.
+     *
+     */
+    int subtitle_track_index(const int id) const;
+
+    /** \brief Returns true if any subtitle file is open and false otherwise.
+     *
+     */
+    bool has_subtitle_files() const;
+
+    /** \brief Opens the decoders of the streams that need processing and allocates the decoding
+     *         buffers. Returns true on success and false otherwise.
+     *
+     */
+    bool init_decoders();
+
+    /** \brief De-Initializes libav and deletes all assigned memory.
+     *
+     */
+    void deinit_libav();
 
     /** \brief Returns the audio codec id in libav.
      *
@@ -228,6 +441,104 @@ class Worker
      */
     bool create_output();
 
+    /** \brief Creates and opens the buffered writer of the given output file. Returns the writer on
+     *         success and nullptr otherwise.
+     * \param[in] filename output file name.
+     *
+     */
+    std::unique_ptr<OutputWriter> create_output_writer(const QString &filename);
+
+    /** \brief Creates and configures the video stream of the output context. Returns true on success and
+     *         false otherwise.
+     * \param[in] filename Output file name.
+     *
+     */
+    bool create_video_stream(const QString &filename);
+
+    /** \brief Creates and configures the audio stream of the output context. Returns true on success and
+     *         false otherwise.
+     * \param[in] filename Output file name.
+     *
+     */
+    bool create_audio_stream(const QString &filename);
+
+    /** \brief Creates the output streams of the copied audio streams. Returns true on success and
+     *         false otherwise.
+     * \param[in] filename Output file name.
+     *
+     */
+    bool create_extra_audio_streams(const QString &filename);
+
+    /** \brief Returns the name of the output video file of the worker.
+     *
+     */
+    QString output_video_filename() const;
+
+    /** \brief Demuxes the input and feeds the pipeline stages until the end of the input or the chunk.
+     *
+     */
+    void transcode();
+
+    /** \brief Extracts the subtitles of the input when it's the only processing needed, without
+     *         decoders or pipeline stages.
+     *
+     */
+    void extract_subtitles();
+
+    /** \brief Splits the input video at keyframes into the configured number of chunks, or one chunk per
+     *         checkpoint interval if the checkpoints are enabled. Reuses the chunks of the checkpoint of an
+     *         interrupted transcoding. Returns true if the video can be split and false otherwise.
+     * \param[out] chunks Video chunks.
+     *
+     */
+    bool compute_chunks(std::vector<Chunk> &chunks);
+
+    /** \brief Returns the estimated peak memory in bytes of transcoding the file, from the frame size and
+     *         pixel format of the video, the decoder delay, the encoder lookahead and the queued packets.
+     *
+     */
+    qint64 estimate_memory() const;
+
+    /** \brief Waits until the estimated memory of the job fits the memory budget and reserves it. Returns
+     *         true if reserved or not needed and false if cancelled while waiting.
+     * \param[in] chunks number of video chunks or 0 if not chunked.
+     *
+     */
+    bool reserve_memory(const size_t chunks);
+
+    /** \brief Returns the reserved memory to the memory budget.
+     *
+     */
+    void release_memory();
+
+    /** \brief Waits until the processed frames and read bytes fit the configured rate limits.
+     * \param[in] frames number of video frames processed.
+     * \param[in] bytes number of bytes read.
+     *
+     */
+    void throttle(const long long frames, const long long bytes);
+
+    /** \brief Returns the signature of the configuration and input values that the checkpoint chunks depend on.
+     *
+     */
+    quint32 checkpoint_signature() const;
+
+    /** \brief Launches the workers of the video chunks, the configured number at a time, and the audio
+     *         chunk, waits for them to finish and merges their outputs into the final file. The chunks
+     *         already finished in the checkpoint aren't transcoded again.
+     * \param[in] chunks Video chunks.
+     *
+     */
+    void transcode_chunks(std::vector<Chunk> &chunks);
+
+    /** \brief Concatenates the video chunks and interleaves them with the audio chunk into the output
+     *         file without re-encoding. Returns true on success and false otherwise.
+     * \param[in] chunks Video chunks.
+     * \param[in] audio Audio chunk.
+     *
+     */
+    bool merge_chunks(const std::vector<Chunk> &chunks, const Chunk &audio);
+
     /** \brief libav log callback remove when release.
      *
      */
@@ -235,44 +546,147 @@ class Worker
 
     /** \brief Initializes the filters needed for audio trasncoding due to different frame sizes. Returns
      * true on success and false otherwise.
+     * \param[in] convert true to convert the sample format, rate and channels and false if the decoder
+     *            output is already in the format of the encoder.
      *
      */
-    bool init_audio_filters();
+    bool init_audio_filters(const bool convert);
+
+    /** \brief Returns the pixel format of the encoder list that loses less information converting from the
+     *         given one, the same format if the encoder supports it.
+     * \param[in] encoder Video encoder.
+     * \param[in] source Decoder pixel format.
+     *
+     */
+    static AVPixelFormat negotiate_pixel_format(const AVCodec *encoder, const AVPixelFormat source);
+
+    /** \brief Returns the sample format of the encoder list closer to the given one, the same format if the
+     *         encoder supports it.
+     * \param[in] encoder Audio encoder.
+     * \param[in] source Decoder sample format.
+     *
+     */
+    static AVSampleFormat negotiate_sample_format(const AVCodec *encoder, const AVSampleFormat source);
+
+    /** \brief Returns true if the frame can be sent to the stream encoder without conversion.
+     * \param[in] stream Stream of the frame.
+     * \param[in] frame Decoded frame.
+     *
+     */
+    static bool matches_encoder(const Stream &stream, const AVFrame *frame);
 
     /** \brief Initializes the filters needed for video transcoding. Returns true on success and false otherwise.
      *
      */
     bool init_video_filters();
 
-    /** \brief Helper method that process a stream packet to frame and then encodes it and pushes it to output file.
-     * Returns true on success and false otherwise.
-     * \param[in] stream Stream to process current m_packet information.
+    /** \brief Launches the transcoding and muxer stages threads.
+     *
+     */
+    void start_pipeline();
+
+    /** \brief Signals the end of the input to the stages and waits for them to finish. If the input
+     *         hasn't been completely read the stages are aborted instead.
+     * \param[in] finished True if the demuxer reached the end of the input and false otherwise.
+     *
+     */
+    void finish_pipeline(const bool finished);
+
+    /** \brief Aborts all the pipeline queues, used by the stages on error.
+     *
+     */
+    void abort_pipeline();
+
+    /** \brief Moves the current demuxed packet to the given queue. Returns true on success and false if the
+     *         queue has been aborted.
+     * \param[in] queue Destination queue.
+     *
+     */
+    bool dispatch_packet(PacketQueue &queue);
+
+    /** \brief Transcoding stage thread method. Processes the packets of the given queue until the end of
+     *         the input, then flushes the stream.
+     * \param[in] stream Stream to transcode.
+     * \param[in] queue Input packets queue.
+     *
+     */
+    void transcode_stage(Stream &stream, PacketQueue &queue);
+
+    /** \brief Muxer stage thread method. Writes the packets of the muxer queue to the output file until all
+     *         the producers have finished.
+     * \param[in] producers Number of stages that write into the muxer queue.
      *
      */
-    bool process_av_packet(Stream &stream);
+    void muxer_stage(int producers);
 
-    /** \brief Flushes all streams and finishes.
+    /** \brief Returns the size in bytes of the data of the given audio or video frame.
+     * \param[in] frame Frame.
      *
      */
-    bool flush_streams();
+    static long long frame_data_size(const AVFrame *frame);
 
-    /** \brief Writes the current packet to the given stream. Returns true on success and false otherwise.
+    /** \brief Helper method that decodes a stream packet to frames and then encodes them and pushes them to the
+     *         muxer queue. Returns true on success and false otherwise.
      * \param[in] stream Stream of the packet.
+     * \param[in] packet Packet to decode or nullptr to drain the decoder.
+     *
+     */
+    bool process_av_packet(Stream &stream, AVPacket *packet);
+
+    /** \brief Filters the given frame if needed and sends it to the stream encoder. Returns true on success and
+     *         false otherwise.
+     * \param[in] stream Stream of the frame.
+     * \param[in] frame Decoded frame or nullptr to drain the filters and the encoder.
+     *
+     */
+    bool encode_av_frame(Stream &stream, AVFrame *frame);
+
+    /** \brief Sends the frame to the stream encoder and pushes the resulting packets to the muxer queue.
+     *         Returns true on success and false otherwise.
+     * \param[in] stream Stream of the frame.
+     * \param[in] frame Frame to encode or nullptr to drain the encoder.
+     *
+     */
+    bool send_av_frame(Stream &stream, AVFrame *frame);
+
+    /** \brief Pushes the packets available in the stream encoder to the muxer queue. Returns the number of
+     *         packets pushed or -1 on error.
+     * \param[in] stream Stream of the encoder.
+     *
+     */
+    int receive_av_packets(Stream &stream);
+
+    /** \brief Flushes the decoder, filters and encoder of the given stream.
+     * \param[in] stream Stream to flush.
+     *
+     */
+    bool flush_stream(Stream &stream);
+
+    /** \brief Writes the packet to the given stream. Returns true on success and false otherwise.
+     * \param[in] stream Stream of the packet.
+     * \param[in] packet Packet to write.
+     *
+     */
+    bool write_av_packet(Stream &stream, AVPacket *packet);
+
+    /** \brief Writes a packet of SRT data to the file of its subtitle track, ignoring the packets of other
+     *         streams. Returns true on success and false otherwise.
+     * \param[in] packet Subtitle packet.
      *
      */
-    bool write_av_packet(Stream &stream);
+    bool write_srt_packet(AVPacket *packet);
 
-    /** \brief Writes a packet of SRT data to the subtitle file. Returns true on success and false otherwise.
+    /** \brief Closes the subtitle files and converts them to UCS-2.
      *
      */
-    bool write_srt_packet();
+    void close_subtitle_files();
 
     Worker(const Worker &) = delete;
     Worker(Worker &&) = delete;
     Worker& operator=(const Worker&) = delete;
 
-    bool            m_fail;         /** true on process success, false otherwise.            */
-    bool            m_stop;         /** true if the process needs to abort, false otherwise. */
+    std::atomic<bool> m_fail;       /** true on process success, false otherwise.            */
+    std::atomic<bool> m_stop;       /** true if the process needs to abort, false otherwise. */
 };
 
 extern int hwaccel_lax_profile_check;